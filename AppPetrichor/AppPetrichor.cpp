@@ -1,13 +1,20 @@
+#include "Core/AOV/AOVTraversalCost.h"
+#include "Core/Denoiser/DenoisingTileSink.h"
 #include "Core/Denoiser/IntelOpenImageDenoiser.h"
 #include "Core/Geometry/Sphere.h"
+#include "Core/Image/EXRWriter.h"
 #include "Core/Logger.h"
 #include "Core/Petrichor.h"
+#include "Core/RenderCheckpoint.h"
+#include "Core/TileSink.h"
+#include "Profiler/Profiler.h"
 #include "TestScene/TestScene.h"
 #include <cstdlib>
 #include <ctime>
 #include <fmt/format.h>
 #include <fstream>
 #include <gflags/gflags.h>
+#include <sstream>
 #include <thread>
 
 DEFINE_string(imageOutputDir, "./RenderedImage", "image output path");
@@ -15,6 +22,60 @@ DEFINE_bool(useFixedFilename, false, "use fixed file name.");
 DEFINE_uint32(timeLimit, 0, "Rendering time limit");
 DEFINE_string(renderSetting, "settings.json", "Render setting file path.");
 DEFINE_string(assetSetting, "assets.json", "Asset setting file path.");
+DEFINE_bool(traversalCostHeatmap, false, "Output traversal cost heatmap.");
+DEFINE_bool(outputEXR, false, "Output rendered image and AOVs as EXR.");
+DEFINE_bool(streamTiles,
+            false,
+            "Write finished tiles to a tiled EXR file while rendering.");
+DEFINE_string(checkpoint,
+              "",
+              "Checkpoint file path (checkpoints are disabled if empty).");
+DEFINE_uint32(checkpointInterval, 600, "Checkpoint interval in seconds.");
+DEFINE_bool(resume, false, "Resume rendering from the checkpoint file.");
+DEFINE_uint32(numParts,
+              1,
+              "Number of processes a frame is distributed to (the partial "
+              "result is written to the checkpoint file).");
+DEFINE_uint32(partIndex, 0, "Part of the frame rendered by this process.");
+DEFINE_string(partitionMode,
+              "tiles",
+              "How a frame is distributed: \"tiles\" or \"samples\".");
+DEFINE_string(merge,
+              "",
+              "Comma-separated partial result (checkpoint) files to merge into "
+              "the final image instead of rendering.");
+DEFINE_uint32(denoiseTileSize,
+              0,
+              "Denoise in tiles of this size to bound memory usage (the "
+              "whole image is denoised at once if 0).");
+DEFINE_uint32(denoiseTileOverlap,
+              32,
+              "Width of the border read around each denoising tile.");
+DEFINE_double(denoiseInputScale,
+              0.0,
+              "Scale applied to the HDR image before denoising, shared by "
+              "all tiles (0: derived from the image brightness).");
+DEFINE_uint32(denoiseThreads, 0, "Number of denoiser threads (0: all cores).");
+DEFINE_uint32(denoiseMaxMemoryMB,
+              0,
+              "Denoiser memory limit in MB (0: denoiser default).");
+DEFINE_bool(denoiseWhileRendering,
+            false,
+            "Denoise tiles as soon as their surroundings are rendered.");
+DEFINE_bool(preview,
+            false,
+            "Render progressive preview passes to preview.png instead of a "
+            "final frame.");
+DEFINE_uint32(previewSamples,
+              16,
+              "Samples per pixel accumulated before the preview exits.");
+DEFINE_bool(sequence,
+            false,
+            "Render every frame of the scene animation into numbered "
+            "outputs, keeping the scene and BVH loaded between frames.");
+DEFINE_string(profileOutput,
+              "",
+              "Chrome trace output path (profiling is disabled if empty).");
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -47,6 +108,170 @@ GetCurrentTimeString()
                        tm.tm_sec);
 }
 
+Petrichor::Core::DenoiserSetting
+GetDenoiserSetting()
+{
+    Petrichor::Core::DenoiserSetting setting;
+    setting.numThreads = FLAGS_denoiseThreads;
+    setting.maxMemoryMB = FLAGS_denoiseMaxMemoryMB;
+    setting.tileSize = FLAGS_denoiseTileSize;
+    setting.tileOverlap = FLAGS_denoiseTileOverlap;
+    setting.inputScale = static_cast<float>(FLAGS_denoiseInputScale);
+    return setting;
+}
+
+//! デノイズして最終画像と(指定があれば) EXR を書き出す
+//! albedo, normal のどちらかがない場合はデノイズしない。
+//! レンダリング中にデノイズを済ませた場合は denoisedTexture に渡す
+//! @param denoiser シーケンスのフレーム間で使い回すデノイザー
+void
+SaveImages(const std::filesystem::path& outputDir,
+           const std::string& filenamePrefix,
+           Petrichor::Core::IntelOpenImageDenoiser* denoiser,
+           const Petrichor::Core::Texture2D& targetTexture,
+           const Petrichor::Core::Texture2D* denoisingAlbedoTexture,
+           const Petrichor::Core::Texture2D* denoisingNormalTexture,
+           const Petrichor::Core::Texture2D* traversalCostTexture,
+           const Petrichor::Core::Texture2D* denoisedTexture = nullptr)
+{
+    const bool canDenoise = denoisingAlbedoTexture && denoisingNormalTexture;
+
+    Petrichor::Core::Texture2D denoised;
+    if (canDenoise && denoisedTexture == nullptr)
+    {
+        denoised = denoiser->Denoise(targetTexture,
+                                     *denoisingAlbedoTexture,
+                                     *denoisingNormalTexture,
+                                     true);
+        denoisedTexture = &denoised;
+    }
+
+    {
+        const std::string denoisedFilename = filenamePrefix + "final.png";
+        (canDenoise ? *denoisedTexture : targetTexture)
+          .Save(outputDir / denoisedFilename);
+    }
+
+    if (FLAGS_outputEXR)
+    {
+        // デノイズ前の画像を RGB に、その他は名前付きのレイヤーにする
+        Petrichor::Core::EXRWriter writer;
+        writer.AddLayer("", targetTexture);
+        if (canDenoise)
+        {
+            writer.AddLayer("denoised", *denoisedTexture);
+            writer.AddLayer("albedo", *denoisingAlbedoTexture);
+            writer.AddLayer("normal", *denoisingNormalTexture);
+        }
+        if (traversalCostTexture)
+        {
+            writer.AddLayer("traversalCost", *traversalCostTexture);
+        }
+
+        const std::string fileName = filenamePrefix + "layers.exr";
+        writer.Write(outputDir / fileName);
+    }
+}
+
+//! 分散レンダリングの部分的な結果を合わせて画像を書き出す
+//! @return 終了コード
+int
+MergePartialResults(const std::filesystem::path& outputDir,
+                    const std::string& filenamePrefix,
+                    Petrichor::Core::IntelOpenImageDenoiser* denoiser)
+{
+    SCOPE_LOGGER(__FUNCTION__);
+
+    Petrichor::Core::RenderCheckpoint merged;
+    bool isFirst = true;
+
+    std::stringstream paths(FLAGS_merge);
+    std::string path;
+    while (std::getline(paths, path, ','))
+    {
+        if (path.empty())
+        {
+            continue;
+        }
+
+        if (isFirst)
+        {
+            if (!merged.Load(path))
+            {
+                return EXIT_FAILURE;
+            }
+            isFirst = false;
+            continue;
+        }
+
+        Petrichor::Core::RenderCheckpoint part;
+        if (!part.Load(path) || !merged.Merge(part))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (isFirst)
+    {
+        Petrichor::Core::Logger::Error("No partial result to merge.");
+        return EXIT_FAILURE;
+    }
+
+    // 合わせた結果も部分的な結果と同じ形式で残す(さらに合わせられる)
+    if (!FLAGS_checkpoint.empty())
+    {
+        merged.Save(std::filesystem::weakly_canonical(FLAGS_checkpoint));
+    }
+
+    // 足りない部分があると、そのタイルが黒いまま書き出されてしまう
+    const std::vector<int> tilesWithoutSamples =
+      merged.FindTilesWithoutSamples(Petrichor::Core::Scene::AOVType::Rendered);
+    if (!tilesWithoutSamples.empty())
+    {
+        Petrichor::Core::Logger::Error(
+          "{} tiles have pixels without samples. Some parts may be missing. "
+          "(first tile: {})",
+          tilesWithoutSamples.size(),
+          tilesWithoutSamples.front());
+        return EXIT_FAILURE;
+    }
+
+    const auto createTexture = [&](Petrichor::Core::Scene::AOVType::Value
+                                     aovType) {
+        std::unique_ptr<Petrichor::Core::Texture2D> texture;
+        if (merged.HasLayer(aovType))
+        {
+            texture = std::make_unique<Petrichor::Core::Texture2D>(
+              merged.GetWidth(), merged.GetHeight());
+            merged.Restore(aovType, texture.get());
+        }
+        return texture;
+    };
+
+    const auto targetTexture =
+      createTexture(Petrichor::Core::Scene::AOVType::Rendered);
+    const auto denoisingAlbedoTexture =
+      createTexture(Petrichor::Core::Scene::AOVType::DenoisingAlbedo);
+    const auto denoisingNormalTexture =
+      createTexture(Petrichor::Core::Scene::AOVType::DenoisingNormal);
+
+    if (!targetTexture)
+    {
+        Petrichor::Core::Logger::Error("Rendered image is not found.");
+        return EXIT_FAILURE;
+    }
+
+    SaveImages(outputDir,
+               filenamePrefix,
+               denoiser,
+               *targetTexture,
+               denoisingAlbedoTexture.get(),
+               denoisingNormalTexture.get(),
+               nullptr);
+
+    return EXIT_SUCCESS;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -75,10 +300,25 @@ main(int argc, char** argv)
 
     SCOPE_LOGGER(__FUNCTION__);
 
+    if (!FLAGS_profileOutput.empty())
+    {
+        Petrichor::Profiler::SetEnabled(true);
+        PROFILE_THREAD_NAME("Main");
+    }
+
+    // シーケンスではフレームごとにデバイスを作り直さないよう使い回す
+    Petrichor::Core::IntelOpenImageDenoiser denoiser(GetDenoiserSetting());
+
+    if (!FLAGS_merge.empty())
+    {
+        return MergePartialResults(outputDir, filenamePrefix, &denoiser);
+    }
+
     Petrichor::Core::Scene scene;
     scene.LoadRenderSetting(
       std::filesystem::weakly_canonical(FLAGS_renderSetting));
     scene.LoadAssets(std::filesystem::weakly_canonical(FLAGS_assetSetting));
+    scene.Finalize();
 
     // #TODO: Render()の引数にAOVType(AOVFlag?)を渡してレンダリングする？
     auto targetTexture = std::make_unique<Petrichor::Core::Texture2D>(
@@ -110,9 +350,184 @@ main(int argc, char** argv)
     scene.SetTargetTexture(Petrichor::Core::Scene::AOVType::DenoisingNormal,
                            denoisingNormalTexture.get());
 
+    std::unique_ptr<Petrichor::Core::Texture2D> traversalCostTexture;
+    if (FLAGS_traversalCostHeatmap)
+    {
+        traversalCostTexture = std::make_unique<Petrichor::Core::Texture2D>(
+          targetTexture->GetWidth(), targetTexture->GetHeight());
+
+        scene.SetTargetTexture(Petrichor::Core::Scene::AOVType::TraversalCost,
+                               traversalCostTexture.get());
+    }
+
     Petrichor::Core::Petrichor petrichor;
     petrichor.SetRenderCallback(nullptr);
 
+    // 低い解像度から描き直すプレビュー(表示の代わりにパスごとに書き出す)
+    if (FLAGS_preview)
+    {
+        Petrichor::Core::PreviewSetting previewSetting;
+        previewSetting.maxSamples = FLAGS_previewSamples;
+
+        const std::filesystem::path previewPath = outputDir / "preview.png";
+        petrichor.RenderPreview(
+          scene,
+          previewSetting,
+          [&](const Petrichor::Core::PreviewImage& previewImage) {
+              previewImage.texture->Save(previewPath);
+              Petrichor::Core::Logger::Info("[Preview] 1/{} res, {} spp",
+                                            previewImage.downscale,
+                                            previewImage.numSamples);
+
+              if (previewImage.downscale == 1 &&
+                  previewImage.numSamples >=
+                    static_cast<int>(FLAGS_previewSamples))
+              {
+                  petrichor.StopPreview();
+              }
+          });
+        return EXIT_SUCCESS;
+    }
+
+    // アニメーションのフレームを順に描画する
+    // シーン、テクスチャ、環境マップ、BVH は読み込んだまま使い回す
+    if (FLAGS_sequence)
+    {
+        const Petrichor::Core::SceneAnimation& animation = scene.GetAnimation();
+        if (animation.IsEmpty())
+        {
+            Petrichor::Core::Logger::Error("Scene has no animation keys.");
+            return EXIT_FAILURE;
+        }
+
+        if (!FLAGS_checkpoint.empty() || FLAGS_numParts > 1)
+        {
+            Petrichor::Core::Logger::Error(
+              "Checkpoints and distributed rendering are not supported in "
+              "sequence mode.");
+            return EXIT_FAILURE;
+        }
+
+        const uint32_t baseSeed = scene.GetRenderSetting().seed;
+        for (int frame = animation.GetFirstFrame();
+             frame <= animation.GetLastFrame();
+             frame++)
+        {
+            Petrichor::Core::Logger::Info("[Sequence] Frame {}", frame);
+
+            // フレームごとにノイズを変える(同じフレームは何度描画しても同じ)
+            Petrichor::Core::RenderSetting renderSetting =
+              scene.GetRenderSetting();
+            renderSetting.seed = baseSeed + static_cast<uint32_t>(frame);
+            scene.SetRenderSetting(renderSetting);
+
+            scene.SetFrame(frame);
+            petrichor.Render(scene);
+
+            const std::string framePrefix =
+              fmt::format("{}{:04d}_", filenamePrefix, frame);
+            SaveImages(outputDir,
+                       framePrefix,
+                       &denoiser,
+                       *targetTexture,
+                       denoisingAlbedoTexture.get(),
+                       denoisingNormalTexture.get(),
+                       traversalCostTexture.get());
+
+            if (traversalCostTexture)
+            {
+                const std::string fileName = framePrefix + "traversalCost.png";
+                Petrichor::Core::AOVTraversalCost::SaveHeatmap(
+                  *traversalCostTexture, outputDir / fileName);
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    // 完成したタイルを逐次書き出す(異常終了しても途中までの結果が残る)
+    std::unique_ptr<Petrichor::Core::TiledEXRTileSink> tileSink;
+    if (FLAGS_streamTiles)
+    {
+        tileSink = std::make_unique<Petrichor::Core::TiledEXRTileSink>(
+          outputDir / (filenamePrefix + "tiles.exr"));
+    }
+
+    // 周りまで完成したタイルから、レンダリングと並行してデノイズする
+    // (分散レンダリングでは全てのタイルが揃わないので、合わせてからデノイズする)
+    std::unique_ptr<Petrichor::Core::Texture2D> denoisedTexture;
+    std::unique_ptr<Petrichor::Core::DenoisingTileSink> denoisingTileSink;
+    if (FLAGS_denoiseWhileRendering && FLAGS_numParts <= 1)
+    {
+        denoisedTexture = std::make_unique<Petrichor::Core::Texture2D>(
+          targetTexture->GetWidth(), targetTexture->GetHeight());
+        denoisingTileSink =
+          std::make_unique<Petrichor::Core::DenoisingTileSink>(
+            *targetTexture,
+            denoisingAlbedoTexture.get(),
+            denoisingNormalTexture.get(),
+            denoisedTexture.get(),
+            true,
+            GetDenoiserSetting());
+    }
+
+    Petrichor::Core::TileSinkList tileSinks;
+    tileSinks.Add(tileSink.get());
+    tileSinks.Add(denoisingTileSink.get());
+    petrichor.SetTileSink(&tileSinks);
+
+    // 分散レンダリングでは受け持つ部分だけを描画してチェックポイントに書き出す
+    std::string checkpointPath = FLAGS_checkpoint;
+    if (FLAGS_numParts > 1)
+    {
+        if (FLAGS_partIndex >= FLAGS_numParts)
+        {
+            Petrichor::Core::Logger::Error("partIndex must be less than "
+                                           "numParts.");
+            return EXIT_FAILURE;
+        }
+
+        Petrichor::Core::RenderPartition partition;
+        if (FLAGS_partitionMode == "tiles")
+        {
+            partition.mode = Petrichor::Core::RenderPartition::Mode::Tiles;
+        }
+        else if (FLAGS_partitionMode == "samples")
+        {
+            partition.mode = Petrichor::Core::RenderPartition::Mode::Samples;
+        }
+        else
+        {
+            Petrichor::Core::Logger::Error(
+              "Unknown partitionMode. [{}] (\"tiles\" or \"samples\")",
+              FLAGS_partitionMode);
+            return EXIT_FAILURE;
+        }
+        partition.numParts = FLAGS_numParts;
+        partition.partIndex = FLAGS_partIndex;
+        petrichor.SetPartition(partition);
+
+        if (checkpointPath.empty())
+        {
+            checkpointPath =
+              (outputDir / fmt::format("{}part{}.ckpt",
+                                       filenamePrefix,
+                                       FLAGS_partIndex))
+                .string();
+        }
+    }
+
+    // 一定間隔でサンプルを保存し、強制終了されても続きから再開できるようにする
+    if (!checkpointPath.empty())
+    {
+        Petrichor::Core::CheckpointSetting checkpointSetting;
+        checkpointSetting.path =
+          std::filesystem::weakly_canonical(checkpointPath);
+        checkpointSetting.interval =
+          std::chrono::seconds(FLAGS_checkpointInterval);
+        checkpointSetting.resume = FLAGS_resume;
+        petrichor.SetCheckpoint(checkpointSetting);
+    }
+
     // 時間制限あればセット
     if (FLAGS_timeLimit > 0)
     {
@@ -194,24 +609,34 @@ main(int argc, char** argv)
 
     petrichor.Render(scene);
 
-    if (targetTexture)
+    if (denoisingTileSink)
+    {
+        denoisingTileSink->Finish();
+    }
+
+    // 分散レンダリングの部分的な結果は --merge で合わせてから書き出す
+    if (targetTexture && FLAGS_numParts <= 1)
     {
         /*{
             const std::string filename = prefix + ".png";
             targetTexture->Save(outputDir / filename);
         }*/
 
-        Petrichor::Core::IntelOpenImageDenoiser denoiser;
-        const Petrichor::Core::Texture2D denoised =
-          denoiser.Denoise(*targetTexture,
-                           *denoisingAlbedoTexture,
-                           *denoisingNormalTexture,
-                           true);
+        SaveImages(outputDir,
+                   filenamePrefix,
+                   &denoiser,
+                   *targetTexture,
+                   denoisingAlbedoTexture.get(),
+                   denoisingNormalTexture.get(),
+                   traversalCostTexture.get(),
+                   denoisedTexture.get());
+    }
 
-        {
-            const std::string denoisedFilename = filenamePrefix + "final.png";
-            denoised.Save(outputDir / denoisedFilename);
-        }
+    if (traversalCostTexture)
+    {
+        const std::string fileName = filenamePrefix + "traversalCost.png";
+        Petrichor::Core::AOVTraversalCost::SaveHeatmap(*traversalCostTexture,
+                                                       outputDir / fileName);
     }
 
     /*if (uvCoordinateTexture)
@@ -235,5 +660,20 @@ main(int argc, char** argv)
 
     showProgress.join();
 
+    if (!FLAGS_profileOutput.empty())
+    {
+        const std::filesystem::path profileOutputPath(FLAGS_profileOutput);
+        if (Petrichor::Profiler::ExportChromeTrace(profileOutputPath))
+        {
+            Petrichor::Core::Logger::Info("Profile saved. [{}]",
+                                          profileOutputPath.string());
+        }
+        else
+        {
+            Petrichor::Core::Logger::Error("Failed to save the profile. [{}]",
+                                           profileOutputPath.string());
+        }
+    }
+
     return 0;
 }
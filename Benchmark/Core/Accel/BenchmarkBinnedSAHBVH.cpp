@@ -0,0 +1,298 @@
+#include "Core/Accel/BinnedSAHBVH.h"
+#include "Core/Camera.h"
+#include "Core/Constants.h"
+#include "Core/Integrator/RaySorter.h"
+#include "Core/Ray.h"
+#include "Core/RenderContext.h"
+#include "Core/Sampler/RandomSampler2D.h"
+#include "Core/Scene.h"
+#include "Random/XorShift.h"
+#include "TestScene/TestScene.h"
+#include "benchmark/benchmark.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace Petrichor;
+
+namespace
+{
+
+//! 1回の計測で交差判定するレイの本数
+constexpr int kNumRays = 1 << 16;
+
+//! シーンとBVHの構築は重いので、三角形数が同じ間は使い回す
+struct SceneCache
+{
+    int numTriangles = 0;
+    std::unique_ptr<Core::Scene> scene;
+    std::unique_ptr<Core::BinnedSAHBVH> bvh;
+};
+
+SceneCache&
+GetSceneCache(int numTriangles)
+{
+    static SceneCache cache;
+    if (cache.numTriangles != numTriangles)
+    {
+        // 先に解放して、大きなシーンを2つ同時に保持しないようにする
+        cache.bvh.reset();
+        cache.scene.reset();
+
+        cache.scene = std::make_unique<Core::Scene>();
+        Core::LoadRandomTrianglesScene(cache.scene.get(), numTriangles);
+
+        cache.bvh = std::make_unique<Core::BinnedSAHBVH>();
+        cache.bvh->Build(*cache.scene);
+
+        cache.numTriangles = numTriangles;
+    }
+
+    return cache;
+}
+
+struct RaySet
+{
+    std::vector<Core::Ray> rays;
+    std::vector<float> distMax;
+};
+
+Math::Vector3f
+SampleSphere(Math::XorShift128& random)
+{
+    const float z = 2.0f * random.next() - 1.0f;
+    const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    const float phi = 2.0f * Math::kPi * random.next();
+    return Math::Vector3f(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+//! シーン内のランダムな点からランダムな方向へ飛ぶレイ
+RaySet
+GenerateIncoherentRays()
+{
+    Math::XorShift128 random(1);
+
+    RaySet raySet;
+    for (int rayIndex = 0; rayIndex < kNumRays; rayIndex++)
+    {
+        const Math::Vector3f o(2.0f * random.next() - 1.0f,
+                               2.0f * random.next() - 1.0f,
+                               2.0f * random.next() - 1.0f);
+        raySet.rays.emplace_back(
+          o, SampleSphere(random), Core::RayTypes::Diffuse);
+        raySet.distMax.emplace_back(kInfinity);
+    }
+
+    return raySet;
+}
+
+//! 交差判定の前に並べ替えたランダムなレイ
+RaySet
+GenerateSortedIncoherentRays()
+{
+    RaySet raySet = GenerateIncoherentRays();
+
+    std::vector<Core::Ray> scratch;
+    Core::RaySorter raySorter;
+    raySorter.Sort(
+      &raySet.rays, &scratch, [](const Core::Ray& ray) -> const Core::Ray& {
+          return ray;
+      });
+
+    return raySet;
+}
+
+//! カメラから画素ごとに飛ぶレイ
+RaySet
+GenerateCoherentRays(const Core::Scene& scene)
+{
+    const auto resolution = static_cast<int>(std::sqrt(kNumRays));
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    RaySet raySet;
+    for (int y = 0; y < resolution; y++)
+    {
+        for (int x = 0; x < resolution; x++)
+        {
+            raySet.rays.emplace_back(scene.GetMainCamera()->GenerateRay(
+              x, y, resolution, resolution, sampler2D));
+            raySet.distMax.emplace_back(kInfinity);
+        }
+    }
+
+    return raySet;
+}
+
+//! カメラレイの衝突点から点光源へ向かうレイ
+RaySet
+GenerateShadowRays(const Core::Scene& scene, const Core::AccelBase& accel)
+{
+    const Math::Vector3f lightPos(0.0f, -3.0f, 3.0f);
+
+    RaySet raySet;
+    for (const Core::Ray& cameraRay : GenerateCoherentRays(scene).rays)
+    {
+        const auto hitInfo = accel.Intersect(cameraRay, scene, kEps);
+        if (!hitInfo)
+        {
+            continue;
+        }
+
+        const Math::Vector3f pos =
+          cameraRay.o + hitInfo->distance * cameraRay.dir;
+        const Math::Vector3f toLight = lightPos - pos;
+        const float distance = toLight.Length();
+        raySet.rays.emplace_back(
+          pos, toLight / distance, Core::RayTypes::Shadow);
+        raySet.distMax.emplace_back(distance);
+    }
+
+    return raySet;
+}
+
+void
+RunIntersect(benchmark::State& state,
+             const SceneCache& cache,
+             const RaySet& raySet)
+{
+    // レンダリングスレッドと同じく、作業領域を引き回して交差判定する
+    Core::RenderContext context;
+    context.BeginTile(0);
+
+    for (auto _ : state)
+    {
+        for (size_t rayIndex = 0; rayIndex < raySet.rays.size(); rayIndex++)
+        {
+            benchmark::DoNotOptimize(
+              cache.bvh->Intersect(raySet.rays[rayIndex],
+                                   *cache.scene,
+                                   kEps,
+                                   raySet.distMax[rayIndex],
+                                   context));
+        }
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * raySet.rays.size();
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+
+void
+ApplyTriangleCounts(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Arg(10'000)
+      ->Arg(100'000)
+      ->Arg(1'000'000)
+      ->Arg(10'000'000)
+      ->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+static void
+BM_BinnedSAHBVHBuild(benchmark::State& state)
+{
+    const SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        Core::BinnedSAHBVH bvh;
+        bvh.Build(*cache.scene);
+        benchmark::DoNotOptimize(bvh);
+    }
+
+    const double numTriangles =
+      static_cast<double>(state.iterations()) * state.range(0);
+    state.counters["Mtris/s"] =
+      benchmark::Counter(numTriangles * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_BinnedSAHBVHBuild)->Apply(ApplyTriangleCounts);
+
+static void
+BM_BinnedSAHBVHBuildSpatialSplit(benchmark::State& state)
+{
+    SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+
+    // キャッシュしたシーンの構築設定だけを一時的に変更する
+    Core::RenderSetting renderSetting = cache.scene->GetRenderSetting();
+    renderSetting.useSpatialSplit = true;
+    cache.scene->SetRenderSetting(renderSetting);
+
+    for (auto _ : state)
+    {
+        Core::BinnedSAHBVH bvh;
+        bvh.Build(*cache.scene);
+        benchmark::DoNotOptimize(bvh);
+    }
+
+    renderSetting.useSpatialSplit = false;
+    cache.scene->SetRenderSetting(renderSetting);
+
+    const double numTriangles =
+      static_cast<double>(state.iterations()) * state.range(0);
+    state.counters["Mtris/s"] =
+      benchmark::Counter(numTriangles * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_BinnedSAHBVHBuildSpatialSplit)->Apply(ApplyTriangleCounts);
+
+static void
+BM_BinnedSAHBVHIntersectIncoherent(benchmark::State& state)
+{
+    const SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+    RunIntersect(state, cache, GenerateIncoherentRays());
+}
+BENCHMARK(BM_BinnedSAHBVHIntersectIncoherent)->Apply(ApplyTriangleCounts);
+
+static void
+BM_BinnedSAHBVHIntersectIncoherentSorted(benchmark::State& state)
+{
+    const SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+    RunIntersect(state, cache, GenerateSortedIncoherentRays());
+}
+BENCHMARK(BM_BinnedSAHBVHIntersectIncoherentSorted)
+  ->Apply(ApplyTriangleCounts);
+
+//! 並べ替え自体のコスト
+static void
+BM_RaySorterSort(benchmark::State& state)
+{
+    const RaySet raySet = GenerateIncoherentRays();
+
+    std::vector<Core::Ray> rays;
+    std::vector<Core::Ray> scratch;
+    Core::RaySorter raySorter;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        rays = raySet.rays;
+        state.ResumeTiming();
+
+        raySorter.Sort(
+          &rays, &scratch, [](const Core::Ray& ray) -> const Core::Ray& {
+              return ray;
+          });
+        benchmark::DoNotOptimize(rays.data());
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * raySet.rays.size();
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_RaySorterSort)->Unit(benchmark::kMillisecond);
+
+static void
+BM_BinnedSAHBVHIntersectCoherent(benchmark::State& state)
+{
+    const SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+    RunIntersect(state, cache, GenerateCoherentRays(*cache.scene));
+}
+BENCHMARK(BM_BinnedSAHBVHIntersectCoherent)->Apply(ApplyTriangleCounts);
+
+static void
+BM_BinnedSAHBVHIntersectShadow(benchmark::State& state)
+{
+    const SceneCache& cache = GetSceneCache(static_cast<int>(state.range(0)));
+    RunIntersect(state, cache, GenerateShadowRays(*cache.scene, *cache.bvh));
+}
+BENCHMARK(BM_BinnedSAHBVHIntersectShadow)->Apply(ApplyTriangleCounts);
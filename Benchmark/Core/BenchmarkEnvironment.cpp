@@ -0,0 +1,102 @@
+#include "Core/Environment.h"
+#include "Core/Sampler/RandomSampler2D.h"
+#include "Core/Texture2D.h"
+#include "benchmark/benchmark.h"
+#include <filesystem>
+
+using namespace Petrichor;
+
+namespace
+{
+
+constexpr int kNumSamples = 1 << 12;
+
+//! 重点サンプリング用の環境マップ
+//! Environmentは画像ファイルからしか読み込めないので一時ファイルを経由する
+const Core::Environment&
+GetEnvironment()
+{
+    static const Core::Environment environment = [] {
+        constexpr int kWidth = 512;
+        constexpr int kHeight = 256;
+
+        // 一箇所だけ明るい領域を持つ環境マップ
+        Core::Texture2D texture(kWidth, kHeight);
+        for (int y = 0; y < kHeight; y++)
+        {
+            for (int x = 0; x < kWidth; x++)
+            {
+                const bool isSun =
+                  (x - kWidth / 4) * (x - kWidth / 4) +
+                    (y - kHeight / 4) * (y - kHeight / 4) <
+                  64;
+                const float value = isSun ? 1.0f : 0.1f;
+                texture.SetPixel(x, y, Color3f(value, value, value));
+            }
+        }
+
+        const std::filesystem::path path =
+          std::filesystem::temp_directory_path() /
+          "PetrichorBenchmarkEnvironment.png";
+        texture.Save(path);
+
+        Core::Environment environment_;
+        environment_.SetBaseColor(Color3f::One());
+        environment_.Load(path);
+        std::filesystem::remove(path);
+        return environment_;
+    }();
+
+    return environment;
+}
+
+} // namespace
+
+static void
+BM_EnvironmentImportanceSampling(benchmark::State& state)
+{
+    const Core::Environment& environment = GetEnvironment();
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    for (auto _ : state)
+    {
+        for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+        {
+            float pdf = 0.0f;
+            benchmark::DoNotOptimize(
+              environment.ImportanceSampling(sampler2D, &pdf));
+            benchmark::DoNotOptimize(pdf);
+        }
+    }
+
+    const double numSamples =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Msamples/s"] =
+      benchmark::Counter(numSamples * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EnvironmentImportanceSampling);
+
+static void
+BM_EnvironmentGetColor(benchmark::State& state)
+{
+    const Core::Environment& environment = GetEnvironment();
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    for (auto _ : state)
+    {
+        for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+        {
+            const auto [u, v] = sampler2D.Next();
+            const Math::Vector3f dir =
+              Math::Vector3f(2.0f * u - 1.0f, 2.0f * v - 1.0f, 0.5f)
+                .Normalized();
+            benchmark::DoNotOptimize(environment.GetColor(dir));
+        }
+    }
+
+    const double numSamples =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Msamples/s"] =
+      benchmark::Counter(numSamples * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_EnvironmentGetColor);
@@ -0,0 +1,71 @@
+#include "Core/Petrichor.h"
+#include "Core/Scene.h"
+#include "Core/Texture2D.h"
+#include "TestScene/TestScene.h"
+#include "benchmark/benchmark.h"
+#include <memory>
+
+using namespace Petrichor;
+
+namespace
+{
+
+//! 小さなCornell boxのレンダリング全体(BVH構築を含む)を計測する
+//! (描画はワーカースレッドで行うので実時間で計測する)
+void
+RunRender(benchmark::State& state, Core::IntegratorTypes integrator)
+{
+    Core::Scene scene;
+    Core::LoadProceduralCornellBoxScene(&scene);
+    scene.Finalize();
+
+    Core::RenderSetting renderSetting;
+    renderSetting.outputWidth = 64;
+    renderSetting.outputHeight = 64;
+    renderSetting.numSamplesPerPixel = static_cast<int>(state.range(0));
+    renderSetting.numMaxBounces = 4;
+    renderSetting.integrator = integrator;
+    scene.SetRenderSetting(renderSetting);
+
+    Core::Texture2D targetTexture(renderSetting.outputWidth,
+                                  renderSetting.outputHeight);
+    scene.SetTargetTexture(Core::Scene::AOVType::Rendered, &targetTexture);
+
+    uint64_t numRays = 0;
+    Core::Petrichor petrichor;
+    petrichor.SetRenderCallback([&numRays](const RenderingResult& result) {
+        numRays += result.rayStatistics.numRays;
+    });
+
+    for (auto _ : state)
+    {
+        petrichor.Render(scene);
+    }
+
+    state.counters["Mrays/s"] = benchmark::Counter(
+      static_cast<double>(numRays) * 1.0e-6, benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+static void
+BM_PetrichorRender(benchmark::State& state)
+{
+    RunRender(state, Core::IntegratorTypes::SimplePathTracing);
+}
+BENCHMARK(BM_PetrichorRender)
+  ->Arg(4)
+  ->Arg(16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
+
+static void
+BM_PetrichorRenderWavefront(benchmark::State& state)
+{
+    RunRender(state, Core::IntegratorTypes::WavefrontPathTracing);
+}
+BENCHMARK(BM_PetrichorRenderWavefront)
+  ->Arg(4)
+  ->Arg(16)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
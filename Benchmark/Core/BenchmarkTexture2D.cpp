@@ -0,0 +1,106 @@
+#include "Core/Sampler/RandomSampler2D.h"
+#include "Core/Texture2D.h"
+#include "benchmark/benchmark.h"
+#include <filesystem>
+#include <tuple>
+#include <vector>
+
+using namespace Petrichor;
+
+namespace
+{
+
+constexpr int kNumSamples = 1 << 12;
+
+const Core::Texture2D&
+GetTexture()
+{
+    static const Core::Texture2D texture = [] {
+        constexpr int kSize = 1024;
+        Core::Texture2D texture_(kSize, kSize);
+        for (int y = 0; y < kSize; y++)
+        {
+            for (int x = 0; x < kSize; x++)
+            {
+                const float r = static_cast<float>(x) / kSize;
+                const float g = static_cast<float>(y) / kSize;
+                texture_.SetPixel(x, y, Color3f(r, g, 0.5f));
+            }
+        }
+        return texture_;
+    }();
+
+    return texture;
+}
+
+void
+RunGetPixelByUV(benchmark::State& state,
+                Core::Texture2D::InterplationTypes interpolationType)
+{
+    const Core::Texture2D& texture = GetTexture();
+
+    Core::RandomSampler2D sampler2D(1, 2);
+    std::vector<std::tuple<float, float>> uvs(kNumSamples);
+    for (auto& uv : uvs)
+    {
+        uv = sampler2D.Next();
+    }
+
+    for (auto _ : state)
+    {
+        for (const auto& [u, v] : uvs)
+        {
+            benchmark::DoNotOptimize(
+              texture.GetPixelByUV(u, v, interpolationType));
+        }
+    }
+
+    const double numSamples =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Msamples/s"] =
+      benchmark::Counter(numSamples * 1.0e-6, benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+static void
+BM_Texture2DGetPixelByUVPoint(benchmark::State& state)
+{
+    RunGetPixelByUV(state, Core::Texture2D::InterplationTypes::Point);
+}
+BENCHMARK(BM_Texture2DGetPixelByUVPoint);
+
+static void
+BM_Texture2DGetPixelByUVBilinear(benchmark::State& state)
+{
+    RunGetPixelByUV(state, Core::Texture2D::InterplationTypes::Bilinear);
+}
+BENCHMARK(BM_Texture2DGetPixelByUVBilinear);
+
+static void
+BM_Texture2DSavePNG(benchmark::State& state)
+{
+    const Core::Texture2D& texture = GetTexture();
+    const auto numThreads = static_cast<uint32_t>(state.range(0));
+
+    const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "PetrichorBenchmarkSave.png";
+
+    for (auto _ : state)
+    {
+        texture.Save(path, numThreads);
+    }
+
+    std::filesystem::remove(path);
+
+    const double numPixels = static_cast<double>(state.iterations()) *
+                             texture.GetWidth() * texture.GetHeight();
+    state.counters["Mpixels/s"] =
+      benchmark::Counter(numPixels * 1.0e-6, benchmark::Counter::kIsRate);
+}
+// 0 はハードウェアのスレッド数
+BENCHMARK(BM_Texture2DSavePNG)
+  ->Arg(1)
+  ->Arg(0)
+  ->UseRealTime()
+  ->Unit(benchmark::kMillisecond);
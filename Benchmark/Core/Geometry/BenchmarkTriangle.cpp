@@ -0,0 +1,57 @@
+#include "Core/Constants.h"
+#include "Core/Geometry/Triangle.h"
+#include "Core/Geometry/Vertex.h"
+#include "Core/Ray.h"
+#include "Random/XorShift.h"
+#include "benchmark/benchmark.h"
+#include <vector>
+
+using namespace Petrichor;
+
+namespace
+{
+
+constexpr int kNumRays = 1 << 12;
+
+//! 三角形の周辺を狙ったレイ(およそ半数がヒットする)
+std::vector<Core::Ray>
+GenerateRays()
+{
+    Math::XorShift128 random(1);
+
+    std::vector<Core::Ray> rays;
+    rays.reserve(kNumRays);
+    for (int rayIndex = 0; rayIndex < kNumRays; rayIndex++)
+    {
+        const Math::Vector3f target(
+          2.0f * random.next() - 0.5f, 2.0f * random.next() - 0.5f, 0.0f);
+        const Math::Vector3f o(0.0f, 0.0f, 1.0f);
+        rays.emplace_back(o, (target - o).Normalized());
+    }
+    return rays;
+}
+
+} // namespace
+
+static void
+BM_TriangleIntersect(benchmark::State& state)
+{
+    const Core::Vertex v0(0.0f, 0.0f, 0.0f);
+    const Core::Vertex v1(1.0f, 0.0f, 0.0f);
+    const Core::Vertex v2(0.0f, 1.0f, 0.0f);
+    const Core::Triangle triangle(&v0, &v1, &v2);
+
+    const std::vector<Core::Ray> rays = GenerateRays();
+    for (auto _ : state)
+    {
+        for (const Core::Ray& ray : rays)
+        {
+            benchmark::DoNotOptimize(triangle.Intersect(ray));
+        }
+    }
+
+    const double numRays = static_cast<double>(state.iterations()) * kNumRays;
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TriangleIntersect);
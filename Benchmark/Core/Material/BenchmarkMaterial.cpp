@@ -0,0 +1,190 @@
+#include "Core/HitInfo.h"
+#include "Core/Material/GGX.h"
+#include "Core/Material/Glass.h"
+#include "Core/Material/Lambert.h"
+#include "Core/Ray.h"
+#include "Core/Sampler/RandomSampler2D.h"
+#include "benchmark/benchmark.h"
+#include <memory>
+#include <vector>
+
+using namespace Petrichor;
+
+namespace
+{
+
+constexpr int kNumSamples = 1 << 12;
+
+std::unique_ptr<Core::MaterialBase>
+CreateMaterial(int materialIndex)
+{
+    switch (materialIndex)
+    {
+    case 0:
+        return std::make_unique<Core::Lambert>(Color3f::One());
+    case 1:
+        return std::make_unique<Core::GGX>(Color3f::One(), 0.3f);
+    default:
+        return std::make_unique<Core::Glass>(Color3f::One(), 1.5f);
+    }
+}
+
+const char*
+GetMaterialName(int materialIndex)
+{
+    constexpr const char* kMaterialNames[] = { "Lambert", "GGX", "Glass" };
+    return kMaterialNames[materialIndex];
+}
+
+Core::ShadingInfo
+CreateShadingInfo(const Core::MaterialBase* material)
+{
+    Core::ShadingInfo shadingInfo;
+    shadingInfo.normal = Math::Vector3f::UnitZ();
+    shadingInfo.tangent = Math::Vector3f::UnitX();
+    shadingInfo.material = material;
+    return shadingInfo;
+}
+
+Core::Ray
+CreateIncidentRay()
+{
+    return Core::Ray(Math::Vector3f(0.0f, 0.0f, 1.0f),
+                     Math::Vector3f(0.3f, 0.2f, -1.0f).Normalized());
+}
+
+void
+ApplyMaterials(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->DenseRange(0, 2);
+}
+
+} // namespace
+
+static void
+BM_MaterialCreateNextRay(benchmark::State& state)
+{
+    const auto materialIndex = static_cast<int>(state.range(0));
+    const auto material = CreateMaterial(materialIndex);
+    const Core::ShadingInfo shadingInfo = CreateShadingInfo(material.get());
+    const Core::Ray rayIn = CreateIncidentRay();
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    state.SetLabel(GetMaterialName(materialIndex));
+    for (auto _ : state)
+    {
+        for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+        {
+            benchmark::DoNotOptimize(
+              material->CreateNextRay(rayIn, shadingInfo, sampler2D));
+        }
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MaterialCreateNextRay)->Apply(ApplyMaterials);
+
+static void
+BM_MaterialBxDF(benchmark::State& state)
+{
+    const auto materialIndex = static_cast<int>(state.range(0));
+    const auto material = CreateMaterial(materialIndex);
+    const Core::ShadingInfo shadingInfo = CreateShadingInfo(material.get());
+    const Core::Ray rayIn = CreateIncidentRay();
+
+    // 評価する出射方向はあらかじめサンプリングしておく
+    Core::RandomSampler2D sampler2D(1, 2);
+    std::vector<Core::Ray> raysOut;
+    raysOut.reserve(kNumSamples);
+    for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+    {
+        raysOut.emplace_back(
+          material->CreateNextRay(rayIn, shadingInfo, sampler2D));
+    }
+
+    state.SetLabel(GetMaterialName(materialIndex));
+    for (auto _ : state)
+    {
+        for (const Core::Ray& rayOut : raysOut)
+        {
+            benchmark::DoNotOptimize(
+              material->BxDF(rayIn, rayOut, shadingInfo));
+        }
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MaterialBxDF)->Apply(ApplyMaterials);
+
+//! MISの1頂点分の処理(ライト方向の評価と次のレイの生成)を個別の呼び出しで行う
+static void
+BM_MaterialMISSeparate(benchmark::State& state)
+{
+    const auto materialIndex = static_cast<int>(state.range(0));
+    const auto material = CreateMaterial(materialIndex);
+    const Core::ShadingInfo shadingInfo = CreateShadingInfo(material.get());
+    const Core::Ray rayIn = CreateIncidentRay();
+    const Core::Ray rayToLight(shadingInfo.pos, Math::Vector3f::UnitZ());
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    state.SetLabel(GetMaterialName(materialIndex));
+    for (auto _ : state)
+    {
+        for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+        {
+            benchmark::DoNotOptimize(
+              material->BxDF(rayIn, rayToLight, shadingInfo));
+            benchmark::DoNotOptimize(
+              material->PDF(rayIn, rayToLight, shadingInfo));
+
+            const Core::Ray rayOut =
+              material->CreateNextRay(rayIn, shadingInfo, sampler2D);
+            benchmark::DoNotOptimize(
+              material->PDF(rayIn, rayOut, shadingInfo));
+        }
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MaterialMISSeparate)->Apply(ApplyMaterials);
+
+//! BM_MaterialMISSeparate と同じ処理を BSDFContext を使い回して行う
+static void
+BM_MaterialMISContext(benchmark::State& state)
+{
+    const auto materialIndex = static_cast<int>(state.range(0));
+    const auto material = CreateMaterial(materialIndex);
+    const Core::ShadingInfo shadingInfo = CreateShadingInfo(material.get());
+    const Core::Ray rayIn = CreateIncidentRay();
+    const Math::Vector3f dirToLight = Math::Vector3f::UnitZ();
+    Core::RandomSampler2D sampler2D(1, 2);
+
+    state.SetLabel(GetMaterialName(materialIndex));
+    for (auto _ : state)
+    {
+        for (int sampleIndex = 0; sampleIndex < kNumSamples; sampleIndex++)
+        {
+            const Core::BSDFContext context =
+              material->CreateBSDFContext(rayIn, shadingInfo);
+            benchmark::DoNotOptimize(
+              material->Evaluate(context, rayIn, dirToLight));
+            benchmark::DoNotOptimize(
+              material->Sample(context, rayIn, sampler2D));
+        }
+    }
+
+    const double numRays =
+      static_cast<double>(state.iterations()) * kNumSamples;
+    state.counters["Mrays/s"] =
+      benchmark::Counter(numRays * 1.0e-6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_MaterialMISContext)->Apply(ApplyMaterials);
@@ -1,5 +1,10 @@
+#include "Core/Accel/AABB.h"
+#include "Core/Color3f.h"
+#include "Math/OrthonormalBasis.h"
 #include "Math/Vector3f.h"
+#include "Random/XorShift.h"
 #include "benchmark/benchmark.h"
+#include <vector>
 
 using namespace Petrichor;
 
@@ -34,3 +39,174 @@ BM_Vector3fDotTest(benchmark::State& state)
     }
 }
 BENCHMARK(BM_Vector3fDotTest)->Arg(kNumLoops);
+
+namespace
+{
+
+//! 配列を使う計測で扱う要素数
+constexpr int kNumElements = 4096;
+
+std::vector<Math::Vector3f>
+GenerateVectors(unsigned seed)
+{
+    Math::XorShift128 random(seed);
+
+    std::vector<Math::Vector3f> vectors;
+    vectors.reserve(kNumElements);
+    for (int i = 0; i < kNumElements; i++)
+    {
+        vectors.emplace_back(2.0f * random.next() - 1.0f,
+                             2.0f * random.next() - 1.0f,
+                             2.0f * random.next() - 1.0f);
+    }
+    return vectors;
+}
+
+//! どちらの実装で計測したかをラベルに出す
+void
+SetBackendLabel(benchmark::State& state)
+{
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    state.SetLabel("SIMD");
+#else
+    state.SetLabel("Scalar");
+#endif
+}
+
+void
+SetElementsProcessed(benchmark::State& state)
+{
+    state.SetItemsProcessed(state.iterations() * kNumElements);
+    SetBackendLabel(state);
+}
+
+} // namespace
+
+static void
+BM_Vector3fMulAddArray(benchmark::State& state)
+{
+    const auto v0 = GenerateVectors(1);
+    const auto v1 = GenerateVectors(2);
+    std::vector<Math::Vector3f> result(kNumElements);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kNumElements; i++)
+        {
+            result[i] += v0[i] * v1[i] + 0.5f * v0[i];
+        }
+        benchmark::ClobberMemory();
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fMulAddArray);
+
+static void
+BM_Vector3fDotArray(benchmark::State& state)
+{
+    const auto v0 = GenerateVectors(1);
+    const auto v1 = GenerateVectors(2);
+    for (auto _ : state)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < kNumElements; i++)
+        {
+            sum += Math::Dot(v0[i], v1[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fDotArray);
+
+static void
+BM_Vector3fCrossArray(benchmark::State& state)
+{
+    const auto v0 = GenerateVectors(1);
+    const auto v1 = GenerateVectors(2);
+    std::vector<Math::Vector3f> result(kNumElements);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kNumElements; i++)
+        {
+            result[i] = Math::Cross(v0[i], v1[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fCrossArray);
+
+static void
+BM_Vector3fNormalizeArray(benchmark::State& state)
+{
+    const auto v0 = GenerateVectors(1);
+    std::vector<Math::Vector3f> result(kNumElements);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kNumElements; i++)
+        {
+            result[i] = v0[i].Normalized();
+        }
+        benchmark::ClobberMemory();
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fNormalizeArray);
+
+static void
+BM_Vector3fONBTransformArray(benchmark::State& state)
+{
+    const auto normals = GenerateVectors(1);
+    const auto dirs = GenerateVectors(2);
+    std::vector<Math::Vector3f> result(kNumElements);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < kNumElements; i++)
+        {
+            Math::OrthonormalBasis onb;
+            onb.Build(normals[i].Normalized());
+            result[i] = onb.LocalToWorld(dirs[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fONBTransformArray);
+
+static void
+BM_Vector3fAABBMergeArray(benchmark::State& state)
+{
+    const auto points = GenerateVectors(1);
+    for (auto _ : state)
+    {
+        Core::AABB bound;
+        for (int i = 0; i < kNumElements; i++)
+        {
+            bound.Merge(points[i]);
+        }
+        benchmark::DoNotOptimize(bound);
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Vector3fAABBMergeArray);
+
+static void
+BM_Color3fAccumulateArray(benchmark::State& state)
+{
+    const auto weights = GenerateVectors(1);
+    const auto colors = GenerateVectors(2);
+    for (auto _ : state)
+    {
+        // パストレーシングのスループットと寄与の積算を模したもの
+        Color3f throughput = Color3f::One();
+        Color3f contribution = Color3f::Zero();
+        for (int i = 0; i < kNumElements; i++)
+        {
+            contribution += throughput * colors[i];
+            throughput *= weights[i];
+        }
+        benchmark::DoNotOptimize(contribution);
+    }
+    SetElementsProcessed(state);
+}
+BENCHMARK(BM_Color3fAccumulateArray);
@@ -0,0 +1,78 @@
+#include "AOVTraversalCost.h"
+
+#include "Core/Image/PNGWriter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+void
+AOVTraversalCost::Record(uint32_t pixelX,
+                         uint32_t pixelY,
+                         uint64_t traversalCost,
+                         int numSamples,
+                         Texture2D* targetTex)
+{
+    const float costPerSample =
+      static_cast<float>(traversalCost) / std::max(1, numSamples);
+    targetTex->SetPixel(
+      pixelX, pixelY, Color3f(costPerSample, costPerSample, costPerSample));
+}
+
+float
+AOVTraversalCost::CalcMaxCost(const Texture2D& costTex)
+{
+    // GetPixel() は読み込んだテクスチャ以外では使えないので、直接参照する
+    const Color3f* const pixels = costTex.GetPixelData();
+    const size_t numPixels =
+      static_cast<size_t>(costTex.GetWidth()) * costTex.GetHeight();
+
+    float maxCost = 0.0f;
+    for (size_t pixelIndex = 0; pixelIndex < numPixels; pixelIndex++)
+    {
+        maxCost = std::max(maxCost, pixels[pixelIndex].x);
+    }
+    return maxCost;
+}
+
+bool
+AOVTraversalCost::SaveHeatmap(const Texture2D& costTex,
+                              const std::filesystem::path& path)
+{
+    const float maxCost = CalcMaxCost(costTex);
+    const float invMaxCost = maxCost > 0.0f ? 1.0f / maxCost : 0.0f;
+
+    // 青 -> 緑 -> 赤
+    const auto toHeatmapColor = [](float t) {
+        const float r = std::clamp(2.0f * t - 1.0f, 0.0f, 1.0f);
+        const float g = 1.0f - std::abs(2.0f * t - 1.0f);
+        const float b = std::clamp(1.0f - 2.0f * t, 0.0f, 1.0f);
+        return Color3f(r, g, b);
+    };
+
+    const auto toByte = [](float value) {
+        return static_cast<uint8_t>(255.0f * value + 0.5f);
+    };
+
+    const Color3f* const pixels = costTex.GetPixelData();
+    const int width = costTex.GetWidth();
+    return WritePNG(path,
+                    width,
+                    costTex.GetHeight(),
+                    [&](int y, uint8_t* rgb) {
+                        for (int x = 0; x < width; x++)
+                        {
+                            const Color3f color = toHeatmapColor(
+                              pixels[y * width + x].x * invMaxCost);
+                            rgb[3 * x + 0] = toByte(color.x);
+                            rgb[3 * x + 1] = toByte(color.y);
+                            rgb[3 * x + 2] = toByte(color.z);
+                        }
+                    });
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Core/Texture2D.h"
+#include <cstdint>
+#include <filesystem>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! レイのトラバーサルコストのヒートマップ
+//! レンダリング中は画素ごとのコストをそのまま記録し(EXR にはこの値を書き出す)、
+//! PNG に書き出すときだけカラーマップを適用する
+class AOVTraversalCost
+{
+public:
+    //! 画素のトラバーサルコストを記録する
+    //! @param traversalCost 画素のレンダリングにかかったトラバーサルコスト
+    //! @param numSamples 画素のサンプル数
+    static void
+    Record(uint32_t pixelX,
+           uint32_t pixelY,
+           uint64_t traversalCost,
+           int numSamples,
+           Texture2D* targetTex);
+
+    //! 記録した1サンプルあたりのコストの最大値を求める
+    static float
+    CalcMaxCost(const Texture2D& costTex);
+
+    //! 記録したコストを最大値で正規化し、カラーマップを適用して PNG に書き出す
+    //! 色をそのまま 8bit にする(トーンマッピングしない)。costTex は変更しない
+    //! @return 書き出しに成功したか
+    static bool
+    SaveHeatmap(const Texture2D& costTex, const std::filesystem::path& path);
+};
+
+} // namespace Core
+} // namespace Petrichor
@@ -11,25 +11,26 @@ namespace Core
 void
 AABB::Merge(const AABB& other)
 {
-    lower.x = std::min(lower.x, other.lower.x);
-    lower.y = std::min(lower.y, other.lower.y);
-    lower.z = std::min(lower.z, other.lower.z);
-
-    upper.x = std::max(upper.x, other.upper.x);
-    upper.y = std::max(upper.y, other.upper.y);
-    upper.z = std::max(upper.z, other.upper.z);
+    lower = Math::Min(lower, other.lower);
+    upper = Math::Max(upper, other.upper);
 }
 
 void
 AABB::Merge(const Math::Vector3f& point)
 {
-    lower.x = std::min(lower.x, point.x);
-    lower.y = std::min(lower.y, point.y);
-    lower.z = std::min(lower.z, point.z);
+    lower = Math::Min(lower, point);
+    upper = Math::Max(upper, point);
+}
+
+AABB
+AABB::GetIntersection(const AABB& bound) const
+{
+    AABB intersection;
+
+    intersection.lower = Math::Max(lower, bound.lower);
+    intersection.upper = Math::Min(upper, bound.upper);
 
-    upper.x = std::max(upper.x, point.x);
-    upper.y = std::max(upper.y, point.y);
-    upper.z = std::max(upper.z, point.z);
+    return intersection;
 }
 
 int
@@ -36,6 +36,15 @@ struct AABB
     void
     Merge(const Math::Vector3f& point);
 
+    //! 他のBoundとの共通部分を求める
+    //! (共通部分が無い場合は無効なBoundを返す)
+    AABB
+    GetIntersection(const AABB& bound) const;
+
+    //! 下端が上端を超えていない有効なBoundか
+    inline bool
+    IsValid() const;
+
     //! どの軸に対して一番辺が広いかを取得する
     //! @return 軸番号(X: 0, Y: 1, Z: 2)
     int
@@ -67,6 +76,12 @@ AABB::Contains(const Math::Vector3f& point) const
     return false;
 }
 
+bool
+AABB::IsValid() const
+{
+    return lower.x <= upper.x && lower.y <= upper.y && lower.z <= upper.z;
+}
+
 Math::Vector3f
 AABB::CalcCentroid() const
 {
@@ -2,6 +2,7 @@
 
 #include "Core/Constants.h"
 #include "Core/HitInfo.h"
+#include "Core/RenderContext.h"
 #include <limits>
 #include <optional>
 
@@ -34,11 +35,24 @@ public:
     Build(const Scene& scene) = 0;
 
     //! 交差判定
+    //! @param context 呼び出し元スレッドの作業領域
     virtual std::optional<HitInfo>
     Intersect(const Ray& ray,
               const Scene& scene,
               float distMin,
-              float distMax) const = 0;
+              float distMax,
+              RenderContext& context) const = 0;
+
+    //! 交差判定(スレッドごとの作業領域を使う版)
+    std::optional<HitInfo>
+    Intersect(const Ray& ray,
+              const Scene& scene,
+              float distMin,
+              float distMax) const
+    {
+        return Intersect(
+          ray, scene, distMin, distMax, RenderContext::GetThreadLocal());
+    }
 
     //! 交差判定(デフォルト引数版)
     std::optional<Petrichor::Core::HitInfo>
@@ -47,6 +61,14 @@ public:
         return Intersect(ray, scene, 0.0f, std::numeric_limits<float>::max());
     }
 
+    //! 交差判定(デフォルト引数版)
+    std::optional<HitInfo>
+    Intersect(const Ray& ray, const Scene& scene, RenderContext& context) const
+    {
+        return Intersect(
+          ray, scene, 0.0f, std::numeric_limits<float>::max(), context);
+    }
+
     //! 交差判定(デフォルト引数版)
     std::optional<HitInfo>
     Intersect(const Ray& ray, const Scene& scene, float distMin) const
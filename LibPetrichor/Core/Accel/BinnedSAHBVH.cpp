@@ -2,9 +2,14 @@
 
 #include "Core/Geometry/GeometryBase.h"
 #include "Core/Logger.h"
+#include "Core/RenderSetting.h"
 #include "Core/Scene.h"
+#include "Profiler/Profiler.h"
+#include "Profiler/RayStatistics.h"
+#include <algorithm>
 #include <numeric>
 #include <stack>
+#include <string>
 #include <tuple>
 
 namespace Petrichor
@@ -16,10 +21,75 @@ void
 BinnedSAHBVH::Build(const Scene& scene)
 {
     SCOPE_LOGGER("[BVH] Build");
+    PROFILE_SCOPE("BVH::Build");
 
+    m_buildOptions = MakeBuildOptions(scene.GetRenderSetting());
+
+    if (m_buildOptions.useSpatialSplit)
+    {
+        BuildSpatialSplit(scene);
+    }
+    else
+    {
+        BuildObjectSplit(scene);
+    }
+
+    // 構築中にだけ使うデータは解放する(NUMA ノードへの複製にも含めない)
+    m_primitiveData.clear();
+    m_primitiveData.shrink_to_fit();
+
+    m_buildStatistics = CalcBuildStatistics();
+    m_maxBVHDepth = m_buildStatistics.maxDepth;
+    ASSERT(m_maxBVHDepth < TraversalStack::kCapacity);
+
+    const BuildStatistics& stats = m_buildStatistics;
+    Logger::Info("[BVH] SAH cost: {}", stats.sahCost);
+    Logger::Info(
+      "[BVH] Nodes: {} (leaves: {})", stats.numNodes, stats.numLeaves);
+    Logger::Info("[BVH] Leaf size: average {}, max {}",
+                 stats.averageLeafSize,
+                 stats.maxLeafSize);
+    Logger::Info("[BVH] Max depth: {}", stats.maxDepth);
+
+    const auto formatHistogram = [](const std::vector<int>& histogram) {
+        std::string text;
+        for (size_t index = 0; index < histogram.size(); index++)
+        {
+            if (histogram[index] > 0)
+            {
+                text += fmt::format(" {}:{}", index, histogram[index]);
+            }
+        }
+        return text;
+    };
+    Logger::Info("[BVH] Leaf depth histogram (depth:count):{}",
+                 formatHistogram(stats.leafDepthHistogram));
+    Logger::Info("[BVH] Leaf size histogram (size:count):{}",
+                 formatHistogram(stats.leafSizeHistogram));
+}
+
+BinnedSAHBVH::BuildOptions
+BinnedSAHBVH::MakeBuildOptions(const RenderSetting& renderSetting)
+{
+    BuildOptions options;
+    options.numBins = std::max(2, renderSetting.bvhNumBins);
+    options.traversalCost = std::max(0.0f, renderSetting.bvhTraversalCost);
+    options.maxLeafSize = std::max(1, renderSetting.bvhMaxLeafSize);
+    // トラバーサルスタックが溢れない深さに制限する
+    options.maxDepth = std::clamp(
+      renderSetting.bvhMaxDepth, 1, TraversalStack::kCapacity - 1);
+    options.useSpatialSplit = renderSetting.useSpatialSplit;
+    options.spatialSplitBudget =
+      std::max(0.0f, renderSetting.spatialSplitBudget);
+    return options;
+}
+
+void
+BinnedSAHBVH::BuildObjectSplit(const Scene& scene)
+{
     const auto numPrimitives = scene.GetGeometries().size();
-    m_maxBVHDepth = 0;
-    int bvhDepth = 0;
+    const int numBins = m_buildOptions.numBins;
+    m_maxBVHDepth = 1;
 
     // 事前に全プリミティブのバウンディングボックスと重心を計算しておく
     {
@@ -34,7 +104,8 @@ BinnedSAHBVH::Build(const Scene& scene)
         m_primitiveData.shrink_to_fit();
     }
 
-    std::stack<uint32_t> nodeIndexStack;
+    //! [ノード番号, 深さ]
+    std::stack<std::pair<int, int>> nodeIndexStack;
 
     // ルートのノードを計算
     {
@@ -52,8 +123,7 @@ BinnedSAHBVH::Build(const Scene& scene)
 
         m_nodes.emplace_back(
           rootNodeBoundary, 0, static_cast<uint32_t>(numPrimitives));
-        nodeIndexStack.emplace(0); // root
-        bvhDepth++;
+        nodeIndexStack.emplace(0, 1); // root
     }
 
     // InPlaceソート用プリミティブID配列を初期化
@@ -64,9 +134,14 @@ BinnedSAHBVH::Build(const Scene& scene)
         m_primitiveIDs.shrink_to_fit();
     }
 
+    std::vector<AABB> binBoundaries(numBins);
+    std::vector<int> binCounts(numBins);
+    std::vector<AABB> rightBoundaries(numBins);
+    std::vector<int> rightCounts(numBins);
+
     while (!nodeIndexStack.empty())
     {
-        const uint32_t currentNodeIndex = nodeIndexStack.top();
+        const auto [currentNodeIndex, depth] = nodeIndexStack.top();
         nodeIndexStack.pop();
         Node& currentNode = m_nodes[currentNodeIndex];
 
@@ -75,16 +150,13 @@ BinnedSAHBVH::Build(const Scene& scene)
         ASSERT(indexBegin <= indexEnd);
         const int numPrimitivesInCurrentNode = (indexEnd - indexBegin);
 
-        // ノード内のプリミティブ数が十分に少ない場合は分割しない
-        constexpr int kMinNumPrimitivesInNode = 4;
-        if (numPrimitivesInCurrentNode <= kMinNumPrimitivesInNode)
+        if (numPrimitivesInCurrentNode <= 1 ||
+            depth >= m_buildOptions.maxDepth)
         {
             currentNode.isLeaf = true;
-            bvhDepth--;
             continue;
         }
 
-        // バウンディングボックスの一番長い辺に沿ってソート
         const auto iterBegin = std::begin(m_primitiveIDs) + indexBegin;
         const auto iterEnd = std::begin(m_primitiveIDs) + indexEnd;
 
@@ -100,180 +172,680 @@ BinnedSAHBVH::Build(const Scene& scene)
         }();
 
         const int widestAxis = binBoundary.GetWidestAxis();
-
-        std::sort(iterBegin, iterEnd, [this, widestAxis](int id0, int id1) {
-            return m_primitiveData[id0].centroid[widestAxis] <
-                   m_primitiveData[id1].centroid[widestAxis];
-        });
-
-        // どのビンに属しているかを番号付け
         const float widestEdgeLength =
           binBoundary.upper[widestAxis] - binBoundary.lower[widestAxis];
 
-        for (auto iter = iterBegin; iter != iterEnd; iter++)
+        // 最適な分割位置を探索
+        int binPartitionIndexInBestDiv = 0;
+        float minSplitCost = std::numeric_limits<float>::max();
+        if (widestEdgeLength > 0.0f)
         {
-            const int primitiveID = *iter;
-            PrimitiveData& primitiveData = m_primitiveData[primitiveID];
+            // どのビンに属しているかを番号付け
+            std::fill(binBoundaries.begin(), binBoundaries.end(), AABB{});
+            std::fill(binCounts.begin(), binCounts.end(), 0);
+            for (auto iter = iterBegin; iter != iterEnd; iter++)
+            {
+                const int primitiveID = *iter;
+                PrimitiveData& primitiveData = m_primitiveData[primitiveID];
 
-            const float l = primitiveData.centroid[widestAxis] -
-                            binBoundary.lower[widestAxis];
+                const float l = primitiveData.centroid[widestAxis] -
+                                binBoundary.lower[widestAxis];
 
-            const auto binID = static_cast<int>(
-              std::nextafter(kNumBins * l / widestEdgeLength, 0.0f));
-            ASSERT(0 <= binID && binID < kNumBins);
-            primitiveData.binID = binID;
-        }
+                const int binID = std::min(
+                  static_cast<int>(numBins * l / widestEdgeLength),
+                  numBins - 1);
+                ASSERT(0 <= binID && binID < numBins);
+                primitiveData.binID = binID;
 
-        // 最適な分割位置を探索
-        const auto [binPartitionIndexInBestDiv,
-                    numPrimsInLeftInBestDiv] = [&]() -> std::pair<int, int> {
-            int binPartitionIndexInBestDiv_ = 0;
-            int numPrimsInLeftInBestDiv_ = 0;
-            float minCost = std::numeric_limits<float>::max();
-            for (int binPartitionIndex = 0; binPartitionIndex < kNumBins;
-                 binPartitionIndex++)
-            {
-                const auto [cost, numPrimsInLeft] =
-                  GetSAHCost(binPartitionIndex,
-                             currentNode,
-                             m_primitiveData,
-                             m_primitiveIDs);
+                binBoundaries[binID].Merge(primitiveData.boundary);
+                binCounts[binID]++;
+            }
 
-                if (cost < minCost)
+            // 右側から累積したバウンディングボックスとプリミティブ数
+            {
+                AABB boundary;
+                int count = 0;
+                for (int binIndex = numBins - 1; binIndex > 0; binIndex--)
                 {
-                    minCost = cost;
-                    binPartitionIndexInBestDiv_ = binPartitionIndex;
-                    numPrimsInLeftInBestDiv_ = numPrimsInLeft;
+                    boundary.Merge(binBoundaries[binIndex]);
+                    count += binCounts[binIndex];
+                    rightBoundaries[binIndex] = boundary;
+                    rightCounts[binIndex] = count;
                 }
             }
 
-            return { binPartitionIndexInBestDiv_, numPrimsInLeftInBestDiv_ };
-        }();
+            AABB leftBoundary;
+            int leftCount = 0;
+            for (int binIndex = 1; binIndex < numBins; binIndex++)
+            {
+                leftBoundary.Merge(binBoundaries[binIndex - 1]);
+                leftCount += binCounts[binIndex - 1];
+
+                if (leftCount == 0 || rightCounts[binIndex] == 0)
+                {
+                    continue;
+                }
+
+                const float splitCost = CalcSplitCost(
+                  leftBoundary.GetSurfaceArea() * leftCount +
+                    rightBoundaries[binIndex].GetSurfaceArea() *
+                      rightCounts[binIndex],
+                  currentNode.boundary);
+
+                if (splitCost < minSplitCost)
+                {
+                    minSplitCost = splitCost;
+                    binPartitionIndexInBestDiv = binIndex;
+                }
+            }
+        }
 
-        if (binPartitionIndexInBestDiv == 0)
+        // 分割しても葉ノードよりコストが下がらない
+        const auto leafCost = static_cast<float>(numPrimitivesInCurrentNode);
+        if (numPrimitivesInCurrentNode <= m_buildOptions.maxLeafSize &&
+            !(minSplitCost < leafCost))
         {
-            bvhDepth--;
             currentNode.isLeaf = true;
             continue;
         }
 
-        bvhDepth++;
-        m_maxBVHDepth = std::max(m_maxBVHDepth, bvhDepth);
-
         // ---- 分割する場合 ----
+        int numPrimsInLeft = 0;
+        if (binPartitionIndexInBestDiv > 0)
         {
-            const auto [leftBoundary, rightBoundary] =
-              [&,
-               binPartitionIndexInBestDiv =
-                 binPartitionIndexInBestDiv]() -> std::pair<AABB, AABB> {
-                AABB leftBoundary_, rightBoundary_;
-                for (auto iter = iterBegin; iter != iterEnd; iter++)
-                {
-                    const int primitiveID = *iter;
-                    const PrimitiveData& primitiveData =
-                      m_primitiveData[primitiveID];
+            const auto iterPartition =
+              std::partition(iterBegin,
+                             iterEnd,
+                             [this, binPartitionIndexInBestDiv =
+                                      binPartitionIndexInBestDiv](int id) {
+                                 return m_primitiveData[id].binID <
+                                        binPartitionIndexInBestDiv;
+                             });
+            numPrimsInLeft = static_cast<int>(iterPartition - iterBegin);
+        }
+        else
+        {
+            // 重心が一致していてビンで分割できない場合は個数で二等分する
+            numPrimsInLeft = numPrimitivesInCurrentNode / 2;
+            std::nth_element(
+              iterBegin,
+              iterBegin + numPrimsInLeft,
+              iterEnd,
+              [this, widestAxis = widestAxis](int id0, int id1) {
+                  return m_primitiveData[id0].centroid[widestAxis] <
+                         m_primitiveData[id1].centroid[widestAxis];
+              });
+        }
 
-                    const bool isInLeftNode =
-                      (primitiveData.binID < binPartitionIndexInBestDiv);
-                    if (isInLeftNode)
-                    {
-                        leftBoundary_.Merge(primitiveData.boundary);
-                    }
-                    else
-                    {
-                        rightBoundary_.Merge(primitiveData.boundary);
-                    }
+        const auto calcBoundary = [this](auto first, auto last) {
+            AABB boundary;
+            for (auto iter = first; iter != last; iter++)
+            {
+                boundary.Merge(m_primitiveData[*iter].boundary);
+            }
+            return boundary;
+        };
+
+        const auto iterMiddle = iterBegin + numPrimsInLeft;
+        const AABB leftBoundary = calcBoundary(iterBegin, iterMiddle);
+        const AABB rightBoundary = calcBoundary(iterMiddle, iterEnd);
+
+        const int childDepth = depth + 1;
+        m_maxBVHDepth = std::max(m_maxBVHDepth, childDepth);
+
+        const int leftChildIndex = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back(leftBoundary,
+                             std::array{ -1, -1 },
+                             indexBegin,
+                             indexBegin + numPrimsInLeft,
+                             false);
+        nodeIndexStack.emplace(leftChildIndex, childDepth);
+
+        const int rightChildIndex = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back(rightBoundary,
+                             std::array{ -1, -1 },
+                             indexBegin + numPrimsInLeft,
+                             indexEnd,
+                             false);
+        nodeIndexStack.emplace(rightChildIndex, childDepth);
+
+        m_nodes[currentNodeIndex].childIndicies = { leftChildIndex,
+                                                    rightChildIndex };
+    }
+}
+
+void
+BinnedSAHBVH::BuildSpatialSplit(const Scene& scene)
+{
+    const auto& geometries = scene.GetGeometries();
+    const auto numPrimitives = static_cast<int>(geometries.size());
+
+    //! 構築途中のノード
+    struct BuildTask
+    {
+        int nodeIndex = 0;
+        int depth = 0;
+        std::vector<Reference> references;
+    };
+
+    // 全プリミティブの参照を作成
+    BuildTask rootTask;
+    AABB rootBoundary;
+    {
+        rootTask.references.reserve(numPrimitives);
+        for (int primitiveID = 0; primitiveID < numPrimitives; primitiveID++)
+        {
+            const AABB boundary = geometries[primitiveID]->CalcBoundary();
+            rootTask.references.push_back({ primitiveID, boundary });
+            rootBoundary.Merge(boundary);
+        }
+    }
+
+    const float rootSurfaceArea = rootBoundary.GetSurfaceArea();
+
+    // 複製される参照数の上限
+    const auto maxNumReferences = static_cast<size_t>(
+      numPrimitives * (1.0f + m_buildOptions.spatialSplitBudget));
+    size_t numReferences = numPrimitives;
+
+    m_primitiveData.clear();
+    m_primitiveData.shrink_to_fit();
+    m_primitiveIDs.clear();
+    m_primitiveIDs.reserve(maxNumReferences);
+    m_nodes.clear();
+    m_nodes.reserve(2ll * numPrimitives);
+    m_nodes.emplace_back(rootBoundary, 0, 0);
+    m_maxBVHDepth = 1;
+
+    int numSpatialSplits = 0;
+
+    std::stack<BuildTask> taskStack;
+    rootTask.nodeIndex = 0;
+    rootTask.depth = 1;
+    taskStack.emplace(std::move(rootTask));
+
+    while (!taskStack.empty())
+    {
+        BuildTask task = std::move(taskStack.top());
+        taskStack.pop();
+
+        std::vector<Reference>& references = task.references;
+        const auto numReferencesInNode = static_cast<int>(references.size());
+
+        auto makeLeaf = [&] {
+            Node& node = m_nodes[task.nodeIndex];
+            node.primIndexBegin = static_cast<int>(m_primitiveIDs.size());
+            for (const Reference& reference : references)
+            {
+                m_primitiveIDs.emplace_back(reference.primitiveID);
+            }
+            node.primIndexEnd = static_cast<int>(m_primitiveIDs.size());
+            node.isLeaf = true;
+        };
+
+        if (numReferencesInNode <= 1 || task.depth >= m_buildOptions.maxDepth)
+        {
+            makeLeaf();
+            continue;
+        }
+
+        const AABB nodeBoundary = m_nodes[task.nodeIndex].boundary;
+
+        SplitCandidate bestSplit = FindObjectSplit(references);
+
+        // Object splitの子ノード同士の重なりが大きい場合のみSpatial splitを試す
+        const AABB overlap =
+          bestSplit.leftBoundary.GetIntersection(bestSplit.rightBoundary);
+        const bool tryToSpatialSplit =
+          overlap.IsValid() &&
+          overlap.GetSurfaceArea() > kSpatialSplitAlpha * rootSurfaceArea &&
+          numReferences < maxNumReferences;
+
+        if (tryToSpatialSplit)
+        {
+            const SplitCandidate spatialSplit =
+              FindSpatialSplit(scene, references, nodeBoundary);
+            if (spatialSplit.cost < bestSplit.cost)
+            {
+                bestSplit = spatialSplit;
+            }
+        }
+
+        // 分割しても葉ノードよりコストが下がらない
+        // (分割できない場合は最大プリミティブ数を超えていても葉ノードにする)
+        const auto leafCost = static_cast<float>(numReferencesInNode);
+        const auto isLeafCheaper = [&](const SplitCandidate& split) {
+            if (split.cost == std::numeric_limits<float>::max())
+            {
+                return true;
+            }
+
+            return numReferencesInNode <= m_buildOptions.maxLeafSize &&
+                   !(CalcSplitCost(split.cost, nodeBoundary) < leafCost);
+        };
+
+        if (isLeafCheaper(bestSplit))
+        {
+            makeLeaf();
+            continue;
+        }
+
+        // ---- 参照を左右に振り分ける ----
+        std::vector<Reference> leftReferences;
+        std::vector<Reference> rightReferences;
+        if (bestSplit.isSpatial)
+        {
+            const int axis = bestSplit.axis;
+            const float position = bestSplit.position;
+
+            const auto numStraddlings = static_cast<size_t>(
+              std::count_if(references.cbegin(),
+                            references.cend(),
+                            [axis, position](const Reference& reference) {
+                                return reference.boundary.lower[axis] <
+                                         position &&
+                                       position <
+                                         reference.boundary.upper[axis];
+                            }));
+
+            // 複製の上限を超える場合はObject splitにフォールバック
+            if (numReferences + numStraddlings > maxNumReferences)
+            {
+                bestSplit = FindObjectSplit(references);
+                if (isLeafCheaper(bestSplit))
+                {
+                    makeLeaf();
+                    continue;
                 }
+            }
+        }
 
-                return { leftBoundary_, rightBoundary_ };
-            }();
+        if (bestSplit.isSpatial)
+        {
+            const int axis = bestSplit.axis;
+            const float position = bestSplit.position;
 
-            // Left child node
+            for (const Reference& reference : references)
             {
-                int leftChildIndex = 0;
-                int rightChildIndex = 0;
+                if (reference.boundary.upper[axis] <= position)
+                {
+                    leftReferences.emplace_back(reference);
+                    continue;
+                }
+
+                if (position <= reference.boundary.lower[axis])
+                {
+                    rightReferences.emplace_back(reference);
+                    continue;
+                }
+
+                // 分割平面をまたぐ参照はクリップして両側に複製する
+                const GeometryBase* const geometry =
+                  geometries[reference.primitiveID];
+
+                AABB leftClip = reference.boundary;
+                leftClip.upper[axis] = position;
+                AABB rightClip = reference.boundary;
+                rightClip.lower[axis] = position;
+
+                const AABB leftBoundary =
+                  geometry->CalcClippedBoundary(leftClip);
+                const AABB rightBoundary =
+                  geometry->CalcClippedBoundary(rightClip);
+
+                if (leftBoundary.IsValid())
+                {
+                    leftReferences.push_back(
+                      { reference.primitiveID, leftBoundary });
+                }
 
+                if (rightBoundary.IsValid())
                 {
-                    m_nodes.emplace_back(leftBoundary,
-                                         std::array{ -1, -1 },
-                                         currentNode.primIndexBegin,
-                                         currentNode.primIndexBegin +
-                                           numPrimsInLeftInBestDiv,
-                                         false);
-
-                    const auto index = static_cast<int>(m_nodes.size() - 1);
-                    nodeIndexStack.emplace(index);
-                    leftChildIndex = index;
+                    rightReferences.push_back(
+                      { reference.primitiveID, rightBoundary });
                 }
+            }
 
+            numSpatialSplits++;
+        }
+        else
+        {
+            const int axis = bestSplit.axis;
+            const AABB centroidBoundary = [&] {
+                AABB aabb;
+                for (const Reference& reference : references)
                 {
-                    m_nodes.emplace_back(rightBoundary,
-                                         std::array{ -1, -1 },
-                                         currentNode.primIndexBegin +
-                                           numPrimsInLeftInBestDiv,
-                                         currentNode.primIndexEnd,
-                                         false);
-                    const auto index = static_cast<int>(m_nodes.size() - 1);
-                    nodeIndexStack.emplace(index);
-                    rightChildIndex = index;
+                    aabb.Merge(reference.boundary.CalcCentroid());
                 }
+                return aabb;
+            }();
+            const float lower = centroidBoundary.lower[axis];
+            const float extent = centroidBoundary.upper[axis] - lower;
+            const int numBins = m_buildOptions.numBins;
 
-                currentNode.childIndicies = { leftChildIndex, rightChildIndex };
+            for (const Reference& reference : references)
+            {
+                const float centroid = reference.boundary.CalcCentroid()[axis];
+                const int binID = std::min(
+                  static_cast<int>(numBins * (centroid - lower) / extent),
+                  numBins - 1);
+
+                if (binID < bestSplit.binIndex)
+                {
+                    leftReferences.emplace_back(reference);
+                }
+                else
+                {
+                    rightReferences.emplace_back(reference);
+                }
             }
         }
+
+        if (leftReferences.empty() || rightReferences.empty())
+        {
+            makeLeaf();
+            continue;
+        }
+
+        numReferences +=
+          leftReferences.size() + rightReferences.size() - references.size();
+
+        // ---- 子ノードを作成 ----
+        const auto makeBoundary = [](const std::vector<Reference>& refs) {
+            AABB boundary;
+            for (const Reference& reference : refs)
+            {
+                boundary.Merge(reference.boundary);
+            }
+            return boundary;
+        };
+
+        const int childDepth = task.depth + 1;
+        m_maxBVHDepth = std::max(m_maxBVHDepth, childDepth);
+
+        const auto leftChildIndex = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back(makeBoundary(leftReferences), 0, 0);
+        const auto rightChildIndex = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back(makeBoundary(rightReferences), 0, 0);
+
+        m_nodes[task.nodeIndex].childIndicies = { leftChildIndex,
+                                                  rightChildIndex };
+
+        references.clear();
+        references.shrink_to_fit();
+
+        taskStack.push(
+          { leftChildIndex, childDepth, std::move(leftReferences) });
+        taskStack.push(
+          { rightChildIndex, childDepth, std::move(rightReferences) });
     }
+
+    Logger::Info("[BVH] SBVH: {} nodes, {} references ({} primitives), "
+                 "{} spatial splits",
+                 m_nodes.size(),
+                 m_primitiveIDs.size(),
+                 numPrimitives,
+                 numSpatialSplits);
 }
 
-std::pair<float, int>
-BinnedSAHBVH::GetSAHCost(int binPartitionIndex,
-                         const Node& currentNode,
-                         const std::vector<PrimitiveData>& primitiveDataArray,
-                         const std::vector<int>& primitiveIDs)
+BinnedSAHBVH::SplitCandidate
+BinnedSAHBVH::FindObjectSplit(const std::vector<Reference>& references) const
 {
-    AABB leftBounds, rightBounds;
-    int numPrimsInLeft = 0, numPrimsInRight = 0;
+    SplitCandidate bestSplit;
+    const int numBins = m_buildOptions.numBins;
+
+    const AABB centroidBoundary = [&] {
+        AABB aabb;
+        for (const Reference& reference : references)
+        {
+            aabb.Merge(reference.boundary.CalcCentroid());
+        }
+        return aabb;
+    }();
+
+    const int axis = centroidBoundary.GetWidestAxis();
+    const float lower = centroidBoundary.lower[axis];
+    const float extent = centroidBoundary.upper[axis] - lower;
+
+    // 全ての重心が一致しているので分割できない
+    if (!(extent > 0.0f))
+    {
+        return bestSplit;
+    }
+
+    std::vector<AABB> binBoundaries(numBins);
+    std::vector<int> binCounts(numBins);
+    for (const Reference& reference : references)
+    {
+        const float centroid = reference.boundary.CalcCentroid()[axis];
+        const int binID = std::min(
+          static_cast<int>(numBins * (centroid - lower) / extent),
+          numBins - 1);
+
+        binBoundaries[binID].Merge(reference.boundary);
+        binCounts[binID]++;
+    }
+
+    // 右側から累積したバウンディングボックスとプリミティブ数
+    std::vector<AABB> rightBoundaries(numBins);
+    std::vector<int> rightCounts(numBins);
+    {
+        AABB boundary;
+        int count = 0;
+        for (int binIndex = numBins - 1; binIndex > 0; binIndex--)
+        {
+            boundary.Merge(binBoundaries[binIndex]);
+            count += binCounts[binIndex];
+            rightBoundaries[binIndex] = boundary;
+            rightCounts[binIndex] = count;
+        }
+    }
+
+    AABB leftBoundary;
+    int leftCount = 0;
+    for (int binIndex = 1; binIndex < numBins; binIndex++)
+    {
+        leftBoundary.Merge(binBoundaries[binIndex - 1]);
+        leftCount += binCounts[binIndex - 1];
+
+        if (leftCount == 0 || rightCounts[binIndex] == 0)
+        {
+            continue;
+        }
+
+        const float cost =
+          leftBoundary.GetSurfaceArea() * leftCount +
+          rightBoundaries[binIndex].GetSurfaceArea() * rightCounts[binIndex];
+
+        if (cost < bestSplit.cost)
+        {
+            bestSplit.cost = cost;
+            bestSplit.axis = axis;
+            bestSplit.binIndex = binIndex;
+            bestSplit.isSpatial = false;
+            bestSplit.leftBoundary = leftBoundary;
+            bestSplit.rightBoundary = rightBoundaries[binIndex];
+        }
+    }
 
-    const auto iterBegin =
-      std::begin(primitiveIDs) + currentNode.primIndexBegin;
-    const auto iterEnd = std::begin(primitiveIDs) + currentNode.primIndexEnd;
+    return bestSplit;
+}
+
+BinnedSAHBVH::SplitCandidate
+BinnedSAHBVH::FindSpatialSplit(const Scene& scene,
+                               const std::vector<Reference>& references,
+                               const AABB& nodeBoundary) const
+{
+    SplitCandidate bestSplit;
+    const int numBins = m_buildOptions.numBins;
 
-    for (auto iter = iterBegin; iter != iterEnd; iter++)
+    const int axis = nodeBoundary.GetWidestAxis();
+    const float lower = nodeBoundary.lower[axis];
+    const float extent = nodeBoundary.upper[axis] - lower;
+    if (!(extent > 0.0f))
     {
-        const int primitiveID = *iter;
+        return bestSplit;
+    }
 
-        const PrimitiveData* primitiveData = &primitiveDataArray[primitiveID];
+    const float binWidth = extent / numBins;
+    const auto toBinID = [&](float x) {
+        return std::clamp(
+          static_cast<int>((x - lower) / binWidth), 0, numBins - 1);
+    };
 
-        const int primitiveBinID = primitiveData->binID;
-        if (primitiveBinID < binPartitionIndex)
+    std::vector<AABB> binBoundaries(numBins);
+    std::vector<int> numEntries(numBins); //!< ビンから始まる参照数
+    std::vector<int> numExits(numBins);   //!< ビンで終わる参照数
+
+    const auto& geometries = scene.GetGeometries();
+    for (const Reference& reference : references)
+    {
+        const int firstBinID = toBinID(reference.boundary.lower[axis]);
+        const int lastBinID = toBinID(reference.boundary.upper[axis]);
+
+        if (firstBinID == lastBinID)
         {
-            // left
-            leftBounds.Merge(primitiveData->boundary);
-            numPrimsInLeft++;
+            binBoundaries[firstBinID].Merge(reference.boundary);
         }
         else
         {
-            // right
-            rightBounds.Merge(primitiveData->boundary);
-            numPrimsInRight++;
+            // 参照をビンごとにクリップしてビンのバウンディングボックスに加える
+            const GeometryBase* const geometry =
+              geometries[reference.primitiveID];
+            for (int binID = firstBinID; binID <= lastBinID; binID++)
+            {
+                AABB clipBoundary = reference.boundary;
+                clipBoundary.lower[axis] = std::max(
+                  clipBoundary.lower[axis], lower + binWidth * binID);
+                clipBoundary.upper[axis] = std::min(
+                  clipBoundary.upper[axis], lower + binWidth * (binID + 1));
+
+                const AABB clipped =
+                  geometry->CalcClippedBoundary(clipBoundary);
+                if (clipped.IsValid())
+                {
+                    binBoundaries[binID].Merge(clipped);
+                }
+            }
         }
+
+        numEntries[firstBinID]++;
+        numExits[lastBinID]++;
     }
 
-    const float surfaceAreaLeft =
-      numPrimsInLeft ? leftBounds.GetSurfaceArea() : 0;
+    std::vector<AABB> rightBoundaries(numBins);
+    std::vector<int> rightCounts(numBins);
+    {
+        AABB boundary;
+        int count = 0;
+        for (int binIndex = numBins - 1; binIndex > 0; binIndex--)
+        {
+            boundary.Merge(binBoundaries[binIndex]);
+            count += numExits[binIndex];
+            rightBoundaries[binIndex] = boundary;
+            rightCounts[binIndex] = count;
+        }
+    }
+
+    AABB leftBoundary;
+    int leftCount = 0;
+    for (int binIndex = 1; binIndex < numBins; binIndex++)
+    {
+        leftBoundary.Merge(binBoundaries[binIndex - 1]);
+        leftCount += numEntries[binIndex - 1];
+
+        if (leftCount == 0 || rightCounts[binIndex] == 0)
+        {
+            continue;
+        }
 
-    const float surfaceAreaRight =
-      numPrimsInRight ? rightBounds.GetSurfaceArea() : 0;
+        const float cost =
+          leftBoundary.GetSurfaceArea() * leftCount +
+          rightBoundaries[binIndex].GetSurfaceArea() * rightCounts[binIndex];
 
-    const float cost =
-      numPrimsInLeft * surfaceAreaLeft + numPrimsInRight * surfaceAreaRight;
-    return { cost, numPrimsInLeft };
+        if (cost < bestSplit.cost)
+        {
+            bestSplit.cost = cost;
+            bestSplit.axis = axis;
+            bestSplit.position = lower + binWidth * binIndex;
+            bestSplit.isSpatial = true;
+            bestSplit.leftBoundary = leftBoundary;
+            bestSplit.rightBoundary = rightBoundaries[binIndex];
+        }
+    }
+
+    return bestSplit;
+}
+
+BinnedSAHBVH::BuildStatistics
+BinnedSAHBVH::CalcBuildStatistics() const
+{
+    BuildStatistics stats;
+    if (m_nodes.empty())
+    {
+        return stats;
+    }
+
+    const float rootSurfaceArea = m_nodes[0].boundary.GetSurfaceArea();
+    float weightedCost = 0.0f;
+
+    //! [ノード番号, 深さ]
+    std::stack<std::pair<int, int>> nodeIndexStack;
+    nodeIndexStack.emplace(0, 1);
+    while (!nodeIndexStack.empty())
+    {
+        const auto [nodeIndex, depth] = nodeIndexStack.top();
+        nodeIndexStack.pop();
+        const Node& node = m_nodes[nodeIndex];
+
+        stats.numNodes++;
+        stats.maxDepth = std::max(stats.maxDepth, depth);
+
+        const float surfaceArea = node.boundary.GetSurfaceArea();
+        if (!node.isLeaf)
+        {
+            weightedCost += m_buildOptions.traversalCost * surfaceArea;
+            nodeIndexStack.emplace(node.childIndicies[0], depth + 1);
+            nodeIndexStack.emplace(node.childIndicies[1], depth + 1);
+            continue;
+        }
+
+        const int leafSize = node.primIndexEnd - node.primIndexBegin;
+        weightedCost += leafSize * surfaceArea;
+
+        stats.numLeaves++;
+        stats.numReferences += leafSize;
+        stats.maxLeafSize = std::max(stats.maxLeafSize, leafSize);
+
+        if (static_cast<int>(stats.leafDepthHistogram.size()) <= depth)
+        {
+            stats.leafDepthHistogram.resize(depth + 1);
+        }
+        stats.leafDepthHistogram[depth]++;
+
+        if (static_cast<int>(stats.leafSizeHistogram.size()) <= leafSize)
+        {
+            stats.leafSizeHistogram.resize(leafSize + 1);
+        }
+        stats.leafSizeHistogram[leafSize]++;
+    }
+
+    stats.sahCost = rootSurfaceArea > 0.0f ? weightedCost / rootSurfaceArea
+                                           : 0.0f;
+    stats.averageLeafSize =
+      stats.numLeaves > 0
+        ? static_cast<float>(stats.numReferences) / stats.numLeaves
+        : 0.0f;
+
+    return stats;
 }
 
 std::optional<HitInfo>
 BinnedSAHBVH::Intersect(const Ray& ray,
                         const Scene& scene,
                         float distMin,
-                        float distMax) const
+                        float distMax,
+                        RenderContext& context) const
 {
     const PrecalcedData precalced = [&] {
         PrecalcedData precalced_;
@@ -284,24 +856,28 @@ BinnedSAHBVH::Intersect(const Ray& ray,
         return precalced_;
     }();
 
-    thread_local std::vector<int> bvhNodeIndexStack;
-    bvhNodeIndexStack.clear();
-    bvhNodeIndexStack.reserve(m_maxBVHDepth);
-    bvhNodeIndexStack.emplace_back(0);
+    TraversalStack& bvhNodeIndexStack = context.GetTraversalStack();
+    bvhNodeIndexStack.Clear();
+    bvhNodeIndexStack.Push(0);
 
     // ---- BVHのトラバーサル ----
     std::optional<HitInfo> hitInfoResult;
 
+    // 統計はローカルに数えておき、最後にスレッドのカウンタへまとめて加算する
+    uint64_t numNodeVisits = 0;
+    uint64_t numAABBTests = 0;
+    uint64_t numPrimitiveTests = 0;
+
     // 2つの子ノード又は子オブジェクトに対して
-    while (!bvhNodeIndexStack.empty())
+    while (!bvhNodeIndexStack.IsEmpty())
     {
         // 葉ノードに対して
-        const int currentNodeIndex = bvhNodeIndexStack.back();
-        bvhNodeIndexStack.pop_back();
+        const int currentNodeIndex = bvhNodeIndexStack.Pop();
         const Node& currentNode = m_nodes[currentNodeIndex];
 
         const auto hitInfoNode =
           Intersect(ray, currentNode.boundary, precalced);
+        numAABBTests++;
 
         // そもそもBVHノードに当たる軌道ではない
         if (!hitInfoNode)
@@ -318,8 +894,13 @@ BinnedSAHBVH::Intersect(const Ray& ray,
             }
         }
 
+        numNodeVisits++;
+
         if (currentNode.isLeaf)
         {
+            numPrimitiveTests +=
+              currentNode.primIndexEnd - currentNode.primIndexBegin;
+
             for (int index = currentNode.primIndexBegin;
                  index < currentNode.primIndexEnd;
                  index++)
@@ -342,6 +923,8 @@ BinnedSAHBVH::Intersect(const Ray& ray,
                         hitInfoGeometry->distance < hitInfoResult->distance)
                     {
                         hitInfoResult = hitInfoGeometry;
+                        hitInfoResult->geometryIndex =
+                          static_cast<uint32_t>(primitiveID);
                     }
                 }
             }
@@ -360,16 +943,23 @@ BinnedSAHBVH::Intersect(const Ray& ray,
 
             if (sqDistLeft < sqDistRight)
             {
-                bvhNodeIndexStack.emplace_back(rightChildIndex);
-                bvhNodeIndexStack.emplace_back(leftChildIndex);
+                bvhNodeIndexStack.Push(rightChildIndex);
+                bvhNodeIndexStack.Push(leftChildIndex);
             }
             else
             {
-                bvhNodeIndexStack.emplace_back(leftChildIndex);
-                bvhNodeIndexStack.emplace_back(rightChildIndex);
+                bvhNodeIndexStack.Push(leftChildIndex);
+                bvhNodeIndexStack.Push(rightChildIndex);
             }
         }
     }
+
+    RayStatistics& rayStatistics = context.GetRayStatistics();
+    rayStatistics.AddRay(ray.rayType);
+    rayStatistics.numNodeVisits += numNodeVisits;
+    rayStatistics.numAABBTests += numAABBTests;
+    rayStatistics.numPrimitiveTests += numPrimitiveTests;
+
     return hitInfoResult;
 }
 } // namespace Core
@@ -5,6 +5,7 @@
 #include "Core/Geometry/GeometryBase.h"
 #include "Core/HitInfo.h"
 #include <array>
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -15,6 +16,7 @@ namespace Core
 
 class Scene;
 struct Ray;
+struct RenderSetting;
 
 class BinnedSAHBVH : public AccelBase
 {
@@ -69,28 +71,142 @@ private:
         Math::Vector3f centroid{};
     };
 
+    //! Spatial split BVHの構築で使用するプリミティブへの参照
+    //! (分割されたプリミティブは複数の参照を持つ)
+    struct Reference
+    {
+        int primitiveID = -1;
+        AABB boundary{}; //!< クリップ済みのバウンディングボックス
+    };
+
+    //! ノードの分割候補
+    struct SplitCandidate
+    {
+        float cost = std::numeric_limits<float>::max();
+        int axis = 0;
+        int binIndex = 0;       //!< Object split: 左右を分けるビン番号
+        float position = 0.0f;  //!< Spatial split: 分割平面の位置
+        bool isSpatial = false; //!< Spatial splitか
+        AABB leftBoundary{};
+        AABB rightBoundary{};
+    };
+
 public:
+    //! 構築オプション
+    struct BuildOptions
+    {
+        int numBins = 16;           //!< ビンの分割数
+        float traversalCost = 1.0f; //!< 交差判定1回に対するトラバーサルコスト
+        int maxLeafSize = 4;        //!< 葉ノードの最大プリミティブ数
+        int maxDepth = 64;          //!< BVHの最大深さ
+
+        //! Spatial splitを併用するか
+        bool useSpatialSplit = false;
+
+        //! Spatial splitで複製される参照数の上限(プリミティブ数に対する比)
+        float spatialSplitBudget = 0.5f;
+
+        bool
+        operator==(const BuildOptions& other) const
+        {
+            return numBins == other.numBins &&
+                   traversalCost == other.traversalCost &&
+                   maxLeafSize == other.maxLeafSize &&
+                   maxDepth == other.maxDepth &&
+                   useSpatialSplit == other.useSpatialSplit &&
+                   spatialSplitBudget == other.spatialSplitBudget;
+        }
+
+        bool
+        operator!=(const BuildOptions& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    //! 構築結果の統計情報
+    struct BuildStatistics
+    {
+        float sahCost = 0.0f; //!< ルートの表面積で正規化したSAHコスト
+        int numNodes = 0;
+        int numLeaves = 0;
+        int numReferences = 0; //!< 葉ノードが参照するプリミティブ数の合計
+        int maxLeafSize = 0;
+        float averageLeafSize = 0.0f;
+        int maxDepth = 0;
+
+        //! 深さごとの葉ノード数
+        std::vector<int> leafDepthHistogram;
+
+        //! プリミティブ数ごとの葉ノード数
+        std::vector<int> leafSizeHistogram;
+    };
+
     BinnedSAHBVH() = default;
 
     void
     Build(const Scene& scene) override;
 
+    using AccelBase::Intersect;
+
     std::optional<HitInfo>
     Intersect(const Ray& ray,
               const Scene& scene,
               float distMin,
-              float distMax) const override;
+              float distMax,
+              RenderContext& context) const override;
+
+    //! レンダリング設定から構築オプションを求める
+    static BuildOptions
+    MakeBuildOptions(const RenderSetting& renderSetting);
+
+    //! 直前の構築に使ったオプションを取得
+    const BuildOptions&
+    GetBuildOptions() const
+    {
+        return m_buildOptions;
+    }
+
+    //! 直前の構築結果の統計情報を取得
+    const BuildStatistics&
+    GetBuildStatistics() const
+    {
+        return m_buildStatistics;
+    }
 
 private:
-    //! @param binPartitionIndex どのビン番号でノードを左右に分割するか
-    //! @param primitiveDataArray
-    //! @param primitiveIDs
-    //! @return [コスト, 左のノードに含まれるプリミティブ数]
-    static std::pair<float, int>
-    GetSAHCost(int binPartitionIndex,
-               const Node& currentNode,
-               const std::vector<PrimitiveData>& primitiveDataArray,
-               const std::vector<int>& primitiveIDs);
+    //! 重心のビニングによるObject splitのみでBVHを構築する
+    void
+    BuildObjectSplit(const Scene& scene);
+
+    //! 空間分割を併用してBVHを構築する
+    //! Ref: [Spatial Splits in Bounding Volume Hierarchies]
+    //! (Stich et al. 2009)
+    void
+    BuildSpatialSplit(const Scene& scene);
+
+    //! 重心のビニングによる最適なObject splitを探す
+    SplitCandidate
+    FindObjectSplit(const std::vector<Reference>& references) const;
+
+    //! 参照をクリップしながらビニングし、最適なSpatial splitを探す
+    SplitCandidate
+    FindSpatialSplit(const Scene& scene,
+                     const std::vector<Reference>& references,
+                     const AABB& nodeBoundary) const;
+
+    //! ノードの分割コストを求める
+    //! @param cost 左右の子ノードの(表面積 x プリミティブ数)の和
+    float
+    CalcSplitCost(float cost, const AABB& nodeBoundary) const
+    {
+        return m_buildOptions.traversalCost +
+               cost / nodeBoundary.GetSurfaceArea();
+    }
+
+    //! 構築したBVHの統計情報を計算する
+    BuildStatistics
+    CalcBuildStatistics() const;
 
     static std::optional<HitInfo>
     Intersect(const Ray& ray,
@@ -170,13 +286,17 @@ private:
     }
 
 private:
-    //! ビンの分割数
-    static constexpr int kNumBins = 16;
+    //! Object splitの左右の重なりがルートの表面積に対してこの比を超えたら
+    //! Spatial splitを試す
+    static constexpr float kSpatialSplitAlpha = 1.0e-5f;
 
+    //! 構築中にだけ使う(Build() の終わりに解放する)
     std::vector<PrimitiveData> m_primitiveData;
     std::vector<Node> m_nodes;
     std::vector<int> m_primitiveIDs;
     int m_maxBVHDepth = 0;
+    BuildOptions m_buildOptions;
+    BuildStatistics m_buildStatistics;
 };
 
 } // namespace Core
@@ -3,6 +3,7 @@
 #include "Core/Geometry/GeometryBase.h"
 #include "Core/HitInfo.h"
 #include "Core/Scene.h"
+#include "Profiler/RayStatistics.h"
 
 namespace Petrichor
 {
@@ -22,12 +23,15 @@ std::optional<HitInfo>
 BruteForce::Intersect(const Ray& ray,
                       const Scene& scene,
                       float distMin,
-                      float distMax) const
+                      float distMax,
+                      RenderContext& context) const
 {
     std::optional<HitInfo> hitInfoResult;
 
-    for (const auto geometry : m_geometries)
+    for (size_t geometryIndex = 0; geometryIndex < m_geometries.size();
+         geometryIndex++)
     {
+        const GeometryBase* const geometry = m_geometries[geometryIndex];
         if (const auto geoHitInfo = geometry->Intersect(ray); geoHitInfo)
         {
             // 衝突位置がレイの原点から近すぎたり遠すぎる場合は無視
@@ -42,10 +46,16 @@ BruteForce::Intersect(const Ray& ray,
                 geoHitInfo->distance < hitInfoResult->distance)
             {
                 hitInfoResult = geoHitInfo;
+                hitInfoResult->geometryIndex =
+                  static_cast<uint32_t>(geometryIndex);
             }
         }
     }
 
+    RayStatistics& rayStatistics = context.GetRayStatistics();
+    rayStatistics.AddRay(ray.rayType);
+    rayStatistics.numPrimitiveTests += m_geometries.size();
+
     return hitInfoResult;
 }
 
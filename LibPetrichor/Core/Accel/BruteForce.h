@@ -20,11 +20,14 @@ public:
     void
     Build(const Scene& scene) override;
 
+    using AccelBase::Intersect;
+
     std::optional<HitInfo>
     Intersect(const Ray& ray,
               const Scene& scene,
               float distMin,
-              float distMax) const override;
+              float distMax,
+              RenderContext& context) const override;
 
 private:
     std::vector<const GeometryBase*> m_geometries;
@@ -0,0 +1,286 @@
+#include "DenoisingTileSink.h"
+
+#include "Profiler/Profiler.h"
+#include <algorithm>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+DenoisingTileSink::DenoisingTileSink(const Texture2D& color,
+                                     const Texture2D* albedo,
+                                     const Texture2D* normal,
+                                     Texture2D* output,
+                                     bool isHDR,
+                                     const DenoiserSetting& setting)
+  : m_color(color)
+  , m_albedo(albedo && normal ? albedo : nullptr)
+  , m_normal(albedo && normal ? normal : nullptr)
+  , m_output(output)
+  , m_isHDR(isHDR)
+  , m_denoiser(setting)
+  , m_inputScale(setting.inputScale)
+{
+    // タイルに分けない設定でも、画像全体を1つのタイルとして扱う
+    const int denoiseTileWidth =
+      setting.tileSize > 0 ? setting.tileSize : color.GetWidth();
+    const int denoiseTileHeight =
+      setting.tileSize > 0 ? setting.tileSize : color.GetHeight();
+
+    const TileManager tileManager(
+      color.GetWidth(), color.GetHeight(), denoiseTileWidth, denoiseTileHeight);
+    for (const TileManager::Tile& tile : tileManager.GetTiles())
+    {
+        if (tile.width > 0 && tile.height > 0)
+        {
+            m_denoiseTiles.emplace_back(tile);
+        }
+    }
+    m_isEnqueued.assign(m_denoiseTiles.size(), false);
+
+    m_thread = std::thread([this] { DenoiseLoop(); });
+}
+
+DenoisingTileSink::~DenoisingTileSink()
+{
+    if (m_thread.joinable())
+    {
+        Finish();
+    }
+}
+
+bool
+DenoisingTileSink::OnBegin(Scene::AOVType::Value aovType,
+                           int width,
+                           int height,
+                           int tileWidth,
+                           int tileHeight)
+{
+    const Input input = GetInput(aovType);
+    if (input == NumInputs || width != m_color.GetWidth() ||
+        height != m_color.GetHeight())
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_tileWidth == 0)
+    {
+        m_tileWidth = tileWidth;
+        m_tileHeight = tileHeight;
+        m_numTilesX = (width + tileWidth - 1) / tileWidth;
+        m_numTilesY = (height + tileHeight - 1) / tileHeight;
+
+        const int overlap = std::max(m_denoiser.GetSetting().tileOverlap, 0);
+        m_denoiseTileRanges.clear();
+        for (const TileManager::Tile& tile : m_denoiseTiles)
+        {
+            const int x0 = std::max(tile.x - overlap, 0);
+            const int y0 = std::max(tile.y - overlap, 0);
+            const int x1 = std::min(tile.x + tile.width + overlap, width);
+            const int y1 = std::min(tile.y + tile.height + overlap, height);
+
+            TileRange range;
+            range.beginX = x0 / tileWidth;
+            range.beginY = y0 / tileHeight;
+            range.endX = (x1 - 1) / tileWidth + 1;
+            range.endY = (y1 - 1) / tileHeight + 1;
+            m_denoiseTileRanges.emplace_back(range);
+        }
+    }
+    else if (tileWidth != m_tileWidth || tileHeight != m_tileHeight)
+    {
+        // タイルの対応が取れないので、この AOV は Finish() まで待つ
+        return false;
+    }
+
+    m_isTileFinished[input].assign(
+      static_cast<size_t>(m_numTilesX) * m_numTilesY, false);
+    return true;
+}
+
+void
+DenoisingTileSink::OnTileFinished(Scene::AOVType::Value aovType,
+                                  const TileManager::Tile& tile,
+                                  const TilePixels& pixels)
+{
+    const Input input = GetInput(aovType);
+    if (input == NumInputs)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const int tileX = tile.x / m_tileWidth;
+    const int tileY = tile.y / m_tileHeight;
+    m_isTileFinished[input][static_cast<size_t>(tileY) * m_numTilesX + tileX] =
+      true;
+
+    // このタイルを入力に含むデノイズのタイルだけを調べる
+    for (size_t index = 0; index < m_denoiseTiles.size(); index++)
+    {
+        const TileRange& range = m_denoiseTileRanges[index];
+        if (m_isEnqueued[index] || tileX < range.beginX ||
+            range.endX <= tileX || tileY < range.beginY ||
+            range.endY <= tileY)
+        {
+            continue;
+        }
+
+        if (IsReady(index))
+        {
+            Enqueue(index);
+        }
+    }
+}
+
+void
+DenoisingTileSink::Finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (size_t index = 0; index < m_denoiseTiles.size(); index++)
+        {
+            if (!m_isEnqueued[index])
+            {
+                Enqueue(index);
+            }
+        }
+        m_isFinishing = true;
+    }
+    m_condition.notify_one();
+
+    m_thread.join();
+}
+
+DenoisingTileSink::Input
+DenoisingTileSink::GetInput(Scene::AOVType::Value aovType) const
+{
+    switch (aovType)
+    {
+    case Scene::AOVType::Rendered:
+        return Color;
+    case Scene::AOVType::DenoisingAlbedo:
+        return m_albedo ? Albedo : NumInputs;
+    case Scene::AOVType::DenoisingNormal:
+        return m_normal ? Normal : NumInputs;
+    default:
+        return NumInputs;
+    }
+}
+
+bool
+DenoisingTileSink::IsReady(size_t denoiseTileIndex) const
+{
+    const TileRange& range = m_denoiseTileRanges[denoiseTileIndex];
+
+    const bool hasAux = m_albedo != nullptr;
+    for (int input = 0; input < NumInputs; input++)
+    {
+        if (input != Color && !hasAux)
+        {
+            continue;
+        }
+
+        const std::vector<bool>& isTileFinished = m_isTileFinished[input];
+        if (isTileFinished.empty())
+        {
+            return false;
+        }
+
+        for (int tileY = range.beginY; tileY < range.endY; tileY++)
+        {
+            for (int tileX = range.beginX; tileX < range.endX; tileX++)
+            {
+                if (!isTileFinished[static_cast<size_t>(tileY) * m_numTilesX +
+                                    tileX])
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+DenoisingTileSink::Enqueue(size_t denoiseTileIndex)
+{
+    m_isEnqueued[denoiseTileIndex] = true;
+    m_queue.emplace_back(denoiseTileIndex);
+    m_condition.notify_one();
+}
+
+float
+DenoisingTileSink::CalcInputScale() const
+{
+    // レンダリング中は画像全体が揃わないので、描画済みのタイルから求める
+    std::vector<TileManager::Tile> finishedTiles;
+    const std::vector<bool>& isTileFinished = m_isTileFinished[Color];
+    for (size_t tileIndex = 0; tileIndex < isTileFinished.size(); tileIndex++)
+    {
+        if (!isTileFinished[tileIndex])
+        {
+            continue;
+        }
+
+        TileManager::Tile tile;
+        tile.x = static_cast<int>(tileIndex % m_numTilesX) * m_tileWidth;
+        tile.y = static_cast<int>(tileIndex / m_numTilesX) * m_tileHeight;
+        tile.width = std::min(m_tileWidth, m_color.GetWidth() - tile.x);
+        tile.height = std::min(m_tileHeight, m_color.GetHeight() - tile.y);
+        finishedTiles.emplace_back(tile);
+    }
+
+    // Finish() まで描画されたタイルがなかった場合は、その時点の画像全体から求める
+    if (finishedTiles.empty())
+    {
+        finishedTiles.emplace_back(m_color.GetWidth(), m_color.GetHeight());
+    }
+
+    return IntelOpenImageDenoiser::CalcInputScale(m_color, finishedTiles);
+}
+
+void
+DenoisingTileSink::DenoiseLoop()
+{
+    PROFILE_THREAD_NAME("Denoise");
+
+    for (;;)
+    {
+        size_t denoiseTileIndex = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(
+              lock, [this] { return !m_queue.empty() || m_isFinishing; });
+            if (m_queue.empty())
+            {
+                return;
+            }
+
+            denoiseTileIndex = m_queue.front();
+            m_queue.pop_front();
+
+            if (m_isHDR && m_inputScale <= 0.0f)
+            {
+                m_inputScale = CalcInputScale();
+            }
+        }
+
+        m_denoiser.DenoiseTile(m_color,
+                               m_albedo,
+                               m_normal,
+                               m_isHDR,
+                               m_inputScale,
+                               m_denoiseTiles[denoiseTileIndex],
+                               m_output);
+    }
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Core/Denoiser/IntelOpenImageDenoiser.h"
+#include "Core/TileSink.h"
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! レンダリング中に、入力が揃ったタイルから順にデノイズする
+//! デノイズは専用のスレッドで行い、レンダリングのワーカースレッドは待たせない。
+//! タイルの周りの tileOverlap の範囲まで Rendered (と albedo, normal) が
+//! 完成した時点で、そのタイルのデノイズを始める
+class DenoisingTileSink : public TileSink
+{
+public:
+    //! @param color デノイズする画像(Rendered のレンダリング先)
+    //! @param albedo, normal デノイズの補助(どちらかが nullptr の場合は使わない)
+    //! @param output デノイズ結果の書き込み先(color と同じ大きさ)
+    DenoisingTileSink(const Texture2D& color,
+                      const Texture2D* albedo,
+                      const Texture2D* normal,
+                      Texture2D* output,
+                      bool isHDR,
+                      const DenoiserSetting& setting);
+
+    ~DenoisingTileSink() override;
+
+    bool
+    OnBegin(Scene::AOVType::Value aovType,
+            int width,
+            int height,
+            int tileWidth,
+            int tileHeight) override;
+
+    void
+    OnTileFinished(Scene::AOVType::Value aovType,
+                   const TileManager::Tile& tile,
+                   const TilePixels& pixels) override;
+
+    //! 残りのタイルをデノイズし、全て終わるまで待つ
+    //! レンダリングされなかったタイルはその時点の内容でデノイズする
+    void
+    Finish();
+
+private:
+    //! デノイズの入力
+    enum Input
+    {
+        Color,
+        Albedo,
+        Normal,
+        NumInputs
+    };
+
+    //! デノイズのタイルを周りの範囲まで広げた範囲に含まれる、
+    //! レンダリングのタイルの範囲 [begin, end)
+    struct TileRange
+    {
+        int beginX = 0;
+        int beginY = 0;
+        int endX = 0;
+        int endY = 0;
+    };
+
+    //! AOV に対応する入力(デノイズに使わない AOV の場合は NumInputs)
+    Input
+    GetInput(Scene::AOVType::Value aovType) const;
+
+    //! デノイズのタイルの入力が揃ったか
+    bool
+    IsReady(size_t denoiseTileIndex) const;
+
+    //! デノイズのタイルをキューに積む
+    void
+    Enqueue(size_t denoiseTileIndex);
+
+    //! 描画済みの Rendered のタイルから、全てのタイルで使う inputScale を求める
+    //! m_mutex をロックして呼ぶ
+    float
+    CalcInputScale() const;
+
+    //! キューのタイルをデノイズする
+    void
+    DenoiseLoop();
+
+    const Texture2D& m_color;
+    const Texture2D* m_albedo;
+    const Texture2D* m_normal;
+    Texture2D* m_output;
+    bool m_isHDR;
+
+    //! デノイズのスレッドからだけ使う
+    IntelOpenImageDenoiser m_denoiser;
+
+    //! 全てのタイルで共有する HDR の入力に掛ける値
+    //! 設定で指定がなければ、最初のタイルをデノイズする前に求める
+    float m_inputScale;
+
+    //! デノイズのタイル
+    std::vector<TileManager::Tile> m_denoiseTiles;
+    std::vector<TileRange> m_denoiseTileRanges;
+    std::vector<bool> m_isEnqueued;
+
+    //! レンダリングのタイルの大きさと個数
+    int m_tileWidth = 0;
+    int m_tileHeight = 0;
+    int m_numTilesX = 0;
+    int m_numTilesY = 0;
+
+    //! 入力ごとの、レンダリングが終わったタイル
+    std::array<std::vector<bool>, NumInputs> m_isTileFinished;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<size_t> m_queue;
+    bool m_isFinishing = false;
+
+    std::thread m_thread;
+};
+
+} // namespace Core
+} // namespace Petrichor
@@ -1,84 +1,267 @@
 #include "IntelOpenImageDenoiser.h"
 
+#include "Profiler/Profiler.h"
+#include <algorithm>
+#include <cmath>
 #include <fmt/format.h>
+#include <limits>
 
 namespace Petrichor
 {
 namespace Core
 {
 
+namespace
+{
+
+//! 明るさを求めるブロックの一辺[pixel](OIDN の自動露出と同じ)
+constexpr int kExposureBlockSize = 16;
+
+//! 幾何平均をこの値に合わせる
+constexpr float kExposureKey = 0.18f;
+
+//! これより暗いブロックは無視する
+constexpr float kExposureEps = 1.0e-8f;
+
+} // namespace
+
 IntelOpenImageDenoiser::IntelOpenImageDenoiser()
+  : IntelOpenImageDenoiser(DenoiserSetting())
 {
+}
+
+IntelOpenImageDenoiser::IntelOpenImageDenoiser(const DenoiserSetting& setting)
+  : m_setting(setting)
+{
+    if (m_setting.numThreads > 0)
+    {
+        m_device.set("numThreads", m_setting.numThreads);
+    }
     m_device.commit();
 }
 
 Petrichor::Core::Texture2D
 IntelOpenImageDenoiser::Denoise(const Texture2D& color, bool isHDR)
 {
-    oidn::FilterRef filter = m_device.newFilter("RT");
+    PROFILE_SCOPE("Denoise");
 
-    filter.setImage("color",
-                    const_cast<Texture2D&>(color).GetRawDataPtr(),
-                    oidn::Format::Float3,
-                    color.GetWidth(),
-                    color.GetHeight());
+    return DenoiseImage(color, nullptr, nullptr, isHDR);
+}
 
-    Texture2D outputTexture(color.GetWidth(), color.GetHeight());
-    filter.setImage("output",
-                    outputTexture.GetRawDataPtr(),
-                    oidn::Format::Float3,
-                    outputTexture.GetWidth(),
-                    outputTexture.GetHeight());
-    filter.set("hdr", isHDR);
+Petrichor::Core::Texture2D
+IntelOpenImageDenoiser::Denoise(const Texture2D& color,
+                                const Texture2D& albedo,
+                                const Texture2D& normal,
+                                bool isHDR)
+{
+    PROFILE_SCOPE("Denoise");
 
-    filter.commit();
+    return DenoiseImage(color, &albedo, &normal, isHDR);
+}
 
-    filter.execute();
+void
+IntelOpenImageDenoiser::DenoiseTile(const Texture2D& color,
+                                    const Texture2D* albedo,
+                                    const Texture2D* normal,
+                                    bool isHDR,
+                                    float inputScale,
+                                    const TileManager::Tile& tile,
+                                    Texture2D* output)
+{
+    PROFILE_SCOPE("DenoiseTile");
 
+    if (tile.width <= 0 || tile.height <= 0)
     {
-        const char* errorMsg = nullptr;
-        if (m_device.getError(errorMsg) != oidn::Error::None)
+        return;
+    }
+
+    // 周りを含めてデノイズし、タイルの範囲だけを書き込む
+    const int overlap = std::max(m_setting.tileOverlap, 0);
+    TileManager::Tile region;
+    region.x = std::max(tile.x - overlap, 0);
+    region.y = std::max(tile.y - overlap, 0);
+    region.width =
+      std::min(tile.x + tile.width + overlap, color.GetWidth()) - region.x;
+    region.height =
+      std::min(tile.y + tile.height + overlap, color.GetHeight()) - region.y;
+
+    m_tileOutput.resize(static_cast<size_t>(region.width) * region.height);
+    Execute(color,
+            albedo,
+            normal,
+            isHDR,
+            inputScale,
+            region,
+            &m_tileOutput[0].x,
+            region.width * Texture2D::GetRawDataPixelStride());
+
+    for (int y = tile.y; y < tile.y + tile.height; y++)
+    {
+        const Color3f* const src =
+          &m_tileOutput[static_cast<size_t>(y - region.y) * region.width +
+                        (tile.x - region.x)];
+        for (int x = 0; x < tile.width; x++)
         {
-            fmt::print("{}\n", errorMsg);
+            output->SetPixel(tile.x + x, y, src[x]);
         }
     }
+}
+
+Petrichor::Core::Texture2D
+IntelOpenImageDenoiser::DenoiseImage(const Texture2D& color,
+                                     const Texture2D* albedo,
+                                     const Texture2D* normal,
+                                     bool isHDR)
+{
+    Texture2D outputTexture(color.GetWidth(), color.GetHeight());
+
+    // 一度にデノイズすると、OIDN の作業領域が画像の大きさに比例して大きくなる
+    if (m_setting.tileSize > 0)
+    {
+        // 明るさは全てのタイルで揃える
+        float inputScale = m_setting.inputScale;
+        if (isHDR && inputScale <= 0.0f)
+        {
+            const TileManager::Tile wholeImage(color.GetWidth(),
+                                               color.GetHeight());
+            inputScale = CalcInputScale(color, { wholeImage });
+        }
+
+        const TileManager tileManager(color.GetWidth(),
+                                      color.GetHeight(),
+                                      m_setting.tileSize,
+                                      m_setting.tileSize);
+        for (const TileManager::Tile& tile : tileManager.GetTiles())
+        {
+            DenoiseTile(
+              color, albedo, normal, isHDR, inputScale, tile, &outputTexture);
+        }
+        return outputTexture;
+    }
+
+    Execute(color,
+            albedo,
+            normal,
+            isHDR,
+            m_setting.inputScale,
+            TileManager::Tile(color.GetWidth(), color.GetHeight()),
+            outputTexture.GetRawDataPtr(),
+            color.GetWidth() * Texture2D::GetRawDataPixelStride());
 
     return outputTexture;
 }
 
-Petrichor::Core::Texture2D
-IntelOpenImageDenoiser::Denoise(const Texture2D& color,
-                                const Texture2D& albedo,
-                                const Texture2D& normal,
-                                bool isHDR)
+float
+IntelOpenImageDenoiser::CalcInputScale(
+  const Texture2D& color,
+  const std::vector<TileManager::Tile>& regions)
 {
-    oidn::FilterRef filter = m_device.newFilter("RT");
+    const Color3f* const pixels = color.GetPixelData();
 
-    filter.setImage("color",
-                    const_cast<Texture2D&>(color).GetRawDataPtr(),
-                    oidn::Format::Float3,
-                    color.GetWidth(),
-                    color.GetHeight());
+    double sumLogLuminance = 0.0;
+    int numBlocks = 0;
+    for (const TileManager::Tile& region : regions)
+    {
+        for (int blockY = region.y; blockY < region.y + region.height;
+             blockY += kExposureBlockSize)
+        {
+            for (int blockX = region.x; blockX < region.x + region.width;
+                 blockX += kExposureBlockSize)
+            {
+                const int endX = std::min(blockX + kExposureBlockSize,
+                                          region.x + region.width);
+                const int endY = std::min(blockY + kExposureBlockSize,
+                                          region.y + region.height);
 
-    filter.setImage("albedo",
-                    const_cast<Texture2D&>(albedo).GetRawDataPtr(),
-                    oidn::Format::Float3,
-                    albedo.GetWidth(),
-                    albedo.GetHeight());
+                float sumLuminance = 0.0f;
+                for (int y = blockY; y < endY; y++)
+                {
+                    for (int x = blockX; x < endX; x++)
+                    {
+                        const Color3f& c =
+                          pixels[static_cast<size_t>(y) * color.GetWidth() + x];
+                        sumLuminance +=
+                          0.212671f * c.x + 0.715160f * c.y + 0.072169f * c.z;
+                    }
+                }
 
-    filter.setImage("normal",
-                    const_cast<Texture2D&>(normal).GetRawDataPtr(),
-                    oidn::Format::Float3,
-                    normal.GetWidth(),
-                    normal.GetHeight());
+                const float luminance =
+                  sumLuminance / ((endX - blockX) * (endY - blockY));
+                if (std::isfinite(luminance) && luminance > kExposureEps)
+                {
+                    sumLogLuminance += std::log(luminance);
+                    numBlocks++;
+                }
+            }
+        }
+    }
+
+    return numBlocks > 0
+             ? kExposureKey /
+                 static_cast<float>(std::exp(sumLogLuminance / numBlocks))
+             : 1.0f;
+}
+
+void
+IntelOpenImageDenoiser::Execute(const Texture2D& color,
+                                const Texture2D* albedo,
+                                const Texture2D* normal,
+                                bool isHDR,
+                                float inputScale,
+                                const TileManager::Tile& region,
+                                float* outputPtr,
+                                size_t outputRowStride)
+{
+    const bool hasAux = albedo && normal;
+
+    oidn::FilterRef& filter = hasAux ? m_filterWithAux : m_filter;
+    if (!filter)
+    {
+        filter = m_device.newFilter("RT");
+    }
+
+    // 入力は複製せず、テクスチャの一部を直接参照させる
+    const auto setInputImage = [&](const char* name,
+                                   const Texture2D& texture) {
+        const size_t pixelStride = Texture2D::GetRawDataPixelStride();
+        const size_t rowStride = texture.GetWidth() * pixelStride;
+        filter.setImage(name,
+                        const_cast<float*>(texture.GetRawDataPtr()),
+                        oidn::Format::Float3,
+                        region.width,
+                        region.height,
+                        region.y * rowStride + region.x * pixelStride,
+                        pixelStride,
+                        rowStride);
+    };
+
+    setInputImage("color", color);
+    if (hasAux)
+    {
+        setInputImage("albedo", *albedo);
+        setInputImage("normal", *normal);
+    }
 
-    Texture2D outputTexture(color.GetWidth(), color.GetHeight());
     filter.setImage("output",
-                    outputTexture.GetRawDataPtr(),
+                    outputPtr,
                     oidn::Format::Float3,
-                    outputTexture.GetWidth(),
-                    outputTexture.GetHeight());
+                    region.width,
+                    region.height,
+                    0,
+                    Texture2D::GetRawDataPixelStride(),
+                    outputRowStride);
     filter.set("hdr", isHDR);
+
+    // フィルタを使い回すので、前回の値が残らないよう毎回設定する(NaN は自動)
+    filter.set("inputScale",
+               inputScale > 0.0f ? inputScale
+                                 : std::numeric_limits<float>::quiet_NaN());
+    if (m_setting.maxMemoryMB > 0)
+    {
+        filter.set("maxMemoryMB", m_setting.maxMemoryMB);
+    }
+
+    // 大きさが前回と同じであれば、作業領域は確保し直されない
     filter.commit();
 
     filter.execute();
@@ -90,8 +273,6 @@ IntelOpenImageDenoiser::Denoise(const Texture2D& color,
             fmt::print("{}\n", errorMsg);
         }
     }
-
-    return outputTexture;
 }
 
 } // namespace Core
@@ -1,13 +1,37 @@
 #pragma once
 
 #include "Core/Texture2D.h"
+#include "Core/TileManager.h"
 #include "OpenImageDenoise/oidn.hpp"
+#include <vector>
 
 namespace Petrichor
 {
 namespace Core
 {
 
+//! デノイザの設定
+struct DenoiserSetting
+{
+    //! OIDN が使うスレッド数(0 の場合は全てのコア)
+    int numThreads = 0;
+
+    //! OIDN が使うメモリの上限[MB](0 の場合は OIDN の既定値)
+    int maxMemoryMB = 0;
+
+    //! タイルに分けてデノイズする場合のタイルの一辺[pixel]
+    //! 0 の場合は分けずに画像全体を一度にデノイズする
+    int tileSize = 0;
+
+    //! タイルの周りで入力に含める幅[pixel]
+    //! 狭いとタイルの継ぎ目が見えるので、フィルタの受容野程度にする
+    int tileOverlap = 32;
+
+    //! HDR の入力に掛ける値(0 の場合は画像全体の明るさから求める)
+    //! タイルごとに求めると継ぎ目で明るさが変わるので、全てのタイルで共有する
+    float inputScale = 0.0f;
+};
+
 class IntelOpenImageDenoiser
 {
 public:
@@ -24,6 +48,8 @@ public:
 public:
     IntelOpenImageDenoiser();
 
+    explicit IntelOpenImageDenoiser(const DenoiserSetting& setting);
+
     Texture2D
     Denoise(const Texture2D& color, bool isHDR);
 
@@ -33,8 +59,68 @@ public:
             const Texture2D& normal,
             bool isHDR);
 
+    //! 画像の一部をデノイズして output の tile の範囲に書き込む
+    //! tile の周り tileOverlap の範囲も入力に使うので、そこまで完成していること。
+    //! albedo, normal が nullptr の場合は color だけでデノイズする。
+    //! フィルタと作業領域を使い回すので、複数のスレッドから呼ぶ場合は
+    //! スレッドごとにデノイザを作ること
+    //! @param inputScale HDR の入力に掛ける値。同じ画像のタイルには同じ値を渡す
+    //! (0 以下の場合はタイルごとに OIDN が決めるので、継ぎ目が見えることがある)
+    void
+    DenoiseTile(const Texture2D& color,
+                const Texture2D* albedo,
+                const Texture2D* normal,
+                bool isHDR,
+                float inputScale,
+                const TileManager::Tile& tile,
+                Texture2D* output);
+
+    //! HDR の入力を適正な明るさにする値を regions の範囲から求める
+    //! OIDN の自動露出と同じく、ブロックごとの輝度の幾何平均を 0.18 に合わせる
+    static float
+    CalcInputScale(const Texture2D& color,
+                   const std::vector<TileManager::Tile>& regions);
+
+    const DenoiserSetting&
+    GetSetting() const
+    {
+        return m_setting;
+    }
+
 private:
+    //! 画像全体をデノイズする
+    //! タイルの大きさが設定されていればタイルごとに DenoiseTile() する
+    Texture2D
+    DenoiseImage(const Texture2D& color,
+                 const Texture2D* albedo,
+                 const Texture2D* normal,
+                 bool isHDR);
+
+    //! color の region の範囲をデノイズして outputPtr に書き込む
+    //! outputPtr は region の左上の画素を指し、行の間隔は outputRowStride[byte]
+    //! inputScale が 0 以下の場合は OIDN が region から決める
+    void
+    Execute(const Texture2D& color,
+            const Texture2D* albedo,
+            const Texture2D* normal,
+            bool isHDR,
+            float inputScale,
+            const TileManager::Tile& region,
+            float* outputPtr,
+            size_t outputRowStride);
+
+    DenoiserSetting m_setting;
+
     oidn::DeviceRef m_device = oidn::newDevice();
+
+    //! color だけを使うフィルタ(使い回す)
+    oidn::FilterRef m_filter;
+
+    //! albedo, normal も使うフィルタ(使い回す)
+    oidn::FilterRef m_filterWithAux;
+
+    //! タイルのデノイズ結果の書き込み先(使い回す)
+    std::vector<Color3f> m_tileOutput;
 };
 
 } // namespace Core
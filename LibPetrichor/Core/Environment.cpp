@@ -14,12 +14,7 @@ namespace Core
 void
 Environment::Load(const std::filesystem::path& path)
 {
-    if (m_texEnv == nullptr)
-    {
-        // TODO: メモリリーク。リソース管理クラスを作る。
-        m_texEnv = new Texture2D();
-    }
-    m_texEnv->Load(path, Texture2D::TextureColorType::Color);
+    m_texEnv.Load(path, Texture2D::TextureColorType::Color);
 
     // #TODO:
     // ここで計算するのおかしい。レンダリング前に外部から呼んで計算をする。
@@ -29,7 +24,7 @@ Environment::Load(const std::filesystem::path& path)
 Color3f
 Environment::GetColor(const Math::Vector3f& dir) const
 {
-    if (!(m_texEnv && m_texEnv->IsValid()))
+    if (!m_texEnv.IsValid())
     {
         return m_baseColor;
     }
@@ -44,7 +39,7 @@ Environment::GetColor(const Math::Vector3f& dir) const
     u = Math::Mod(u, 1.0f);
     v = Math::Mod(v, 1.0f);
 
-    return m_baseColor * m_texEnv->GetPixelByUV(u, v);
+    return m_baseColor * m_texEnv.GetPixelByUV(u, v);
 }
 
 void
@@ -61,8 +56,8 @@ Environment::PreCalcCumulativeDistTex()
         return;
     }
 
-    m_pdf2D = Texture2D(m_texEnv->GetWidth(), m_texEnv->GetHeight());
-    m_cdf2D = Texture2D(m_texEnv->GetWidth(), m_texEnv->GetHeight());
+    m_pdf2D = Texture2D(m_texEnv.GetWidth(), m_texEnv.GetHeight());
+    m_cdf2D = Texture2D(m_texEnv.GetWidth(), m_texEnv.GetHeight());
 
     // 行方向の和
     for (int j = 0; j < m_cdf2D.GetHeight(); j++)
@@ -76,7 +71,7 @@ Environment::PreCalcCumulativeDistTex()
 
             const Color3f& prevPixel = m_cdf2D.GetPixel(i - 1, j);
             const Color3f luminance =
-              GetLuminance(m_texEnv->GetPixel(i - 1, j)) * Color3f::One();
+              GetLuminance(m_texEnv.GetPixel(i - 1, j)) * Color3f::One();
 
             m_pdf2D.SetPixel(i, j, luminance);
             m_cdf2D.SetPixel(i, j, prevPixel + luminance);
@@ -30,6 +30,12 @@ public:
         m_ZAxisRotation = angle;
     }
 
+    float
+    GetZAxisRotation() const
+    {
+        return m_ZAxisRotation;
+    }
+
     //! #TODO: 実装雑すぎるので後ほど修正
     //! 輝度の累積分布テクスチャを作成する
     void
@@ -45,11 +51,11 @@ public:
     bool
     UseEnvImportanceSampling() const
     {
-        return m_texEnv && m_texEnv->IsValid() && useEnvImportanceSampling;
+        return m_texEnv.IsValid() && useEnvImportanceSampling;
     }
 
 private:
-    Texture2D* m_texEnv = nullptr; // #TODO: constにして外部からセット
+    Texture2D m_texEnv;
     std::vector<float> m_pdf1D;    //!
     std::vector<float> m_cdf1D;    //!< #TODO: x軸方向の輝度CDF
     Texture2D m_pdf2D;
@@ -27,6 +27,14 @@ public:
     virtual AABB
     CalcBoundary() const = 0;
 
+    //! clipBoundaryの内側にある部分だけのAABBを計算する
+    //! (Spatial split BVHの構築で使用する)
+    virtual AABB
+    CalcClippedBoundary(const AABB& clipBoundary) const
+    {
+        return CalcBoundary().GetIntersection(clipBoundary);
+    }
+
     // レイとの簡易交差判定
     virtual std::optional<HitInfo>
     Intersect(const Ray& ray) const = 0;
@@ -48,6 +56,12 @@ public:
                   PointData* pointData,
                   float* pdfArea) const = 0;
 
+    //! 点pから SampleSurface() を行ったときに、表面上の点 pointOnSurface が
+    //! サンプルされる確率密度(面積測度)を求める
+    virtual float
+    PDFArea(const Math::Vector3f& p,
+            const Math::Vector3f& pointOnSurface) const = 0;
+
     // ジオメトリにマテリアルを設定
     inline void
     SetMaterial(const MaterialBase* material)
@@ -68,6 +82,13 @@ public:
         return m_material;
     }
 
+    //! 設定されたマテリアルを MixMaterial を解決せずに取得
+    inline const MaterialBase*
+    GetAssignedMaterial() const
+    {
+        return m_material;
+    }
+
 protected:
     const MaterialBase* m_material = nullptr;
 };
@@ -123,5 +123,31 @@ Mesh::Load(const std::filesystem::path& path,
         }
     }
 }
+
+void
+Mesh::Build(std::vector<Vertex> vertices,
+            const std::vector<std::array<uint32_t, 3>>& indices,
+            const MaterialBase* material,
+            ShadingTypes shadingType /*= ShadingTypes::Flat*/
+)
+{
+    m_vertices = std::move(vertices);
+
+    m_triangles.clear();
+    m_triangles.reserve(indices.size());
+    for (const auto& index : indices)
+    {
+        ASSERT(index[0] < m_vertices.size());
+        ASSERT(index[1] < m_vertices.size());
+        ASSERT(index[2] < m_vertices.size());
+
+        Triangle triangle(shadingType);
+        triangle.SetVertices(
+          &m_vertices[index[0]], &m_vertices[index[1]], &m_vertices[index[2]]);
+        triangle.SetMaterial(material);
+        m_triangles.emplace_back(std::move(triangle));
+    }
+}
+
 } // namespace Core
 } // namespace Petrichor
@@ -2,6 +2,8 @@
 
 #include "Triangle.h"
 #include "Vertex.h"
+#include <array>
+#include <cstdint>
 #include <filesystem>
 #include <vector>
 
@@ -21,6 +23,14 @@ public:
          const MaterialBase* material,
          ShadingTypes shadingType = ShadingTypes::Flat);
 
+    //! 頂点とインデックスからメッシュを構築する
+    //! @param indices 三角形ごとの頂点インデックス
+    void
+    Build(std::vector<Vertex> vertices,
+          const std::vector<std::array<uint32_t, 3>>& indices,
+          const MaterialBase* material,
+          ShadingTypes shadingType = ShadingTypes::Flat);
+
     const std::vector<Triangle>&
     GetTriangles() const
     {
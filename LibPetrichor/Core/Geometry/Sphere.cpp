@@ -117,5 +117,23 @@ Sphere::SampleSurface(Math::Vector3f p,
     *pdfArea = l / (2.0f * Math::kPi * m_radius * m_radius * (l - m_radius));
 }
 
+float
+Sphere::PDFArea(const Math::Vector3f& p,
+                const Math::Vector3f& pointOnSurface) const
+{
+    const Math::Vector3f originToPoint = p - m_origin;
+    const float l = originToPoint.Length();
+    ASSERT(l >= m_radius);
+
+    // 点pから見える球冠の上で一様にサンプリングしている
+    const float d = Math::Dot(pointOnSurface - m_origin, originToPoint);
+    if (d < m_radius * m_radius)
+    {
+        return 0.0f;
+    }
+
+    return l / (2.0f * Math::kPi * m_radius * m_radius * (l - m_radius));
+}
+
 } // namespace Core
 } // namespace Petrichor
@@ -30,6 +30,10 @@ public:
                   PointData* pointData,
                   float* pdfArea) const override;
 
+    float
+    PDFArea(const Math::Vector3f& p,
+            const Math::Vector3f& pointOnSurface) const override;
+
     Math::Vector3f
     GetCentroid() const override
     {
@@ -48,6 +48,67 @@ Triangle::CalcBoundary() const
     return boundary;
 }
 
+AABB
+Triangle::CalcClippedBoundary(const AABB& clipBoundary) const
+{
+    // Sutherland-Hodgman法で三角形をAABBの6平面でクリップする
+    // (1平面ごとに頂点は高々1つ増えるので最大9頂点)
+    constexpr int kMaxNumVertices = 9;
+    std::array<Math::Vector3f, kMaxNumVertices> polygon{
+        m_vertices[0]->pos, m_vertices[1]->pos, m_vertices[2]->pos
+    };
+    int numVertices = 3;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            const float plane = clipBoundary[side][axis];
+            const float sign = (side == 0) ? 1.0f : -1.0f;
+
+            std::array<Math::Vector3f, kMaxNumVertices> clipped;
+            int numClipped = 0;
+            for (int i = 0; i < numVertices; i++)
+            {
+                const Math::Vector3f& current = polygon[i];
+                const Math::Vector3f& next = polygon[(i + 1) % numVertices];
+                const float distCurrent = sign * (current[axis] - plane);
+                const float distNext = sign * (next[axis] - plane);
+
+                if (distCurrent >= 0.0f)
+                {
+                    clipped[numClipped++] = current;
+                }
+
+                if ((distCurrent >= 0.0f) != (distNext >= 0.0f))
+                {
+                    const float t = distCurrent / (distCurrent - distNext);
+                    Math::Vector3f v = current + t * (next - current);
+                    v[axis] = plane;
+                    clipped[numClipped++] = v;
+                }
+            }
+
+            if (numClipped == 0)
+            {
+                return AABB{};
+            }
+
+            polygon = clipped;
+            numVertices = numClipped;
+        }
+    }
+
+    AABB boundary;
+    for (int i = 0; i < numVertices; i++)
+    {
+        boundary.Merge(polygon[i]);
+    }
+
+    // 数値誤差でクリップ範囲からはみ出さないようにする
+    return boundary.GetIntersection(clipBoundary);
+}
+
 std::optional<HitInfo>
 Triangle::Intersect(const Ray& ray) const
 {
@@ -181,5 +242,15 @@ Triangle::SampleSurface(Math::Vector3f p,
     }
 }
 
+float
+Triangle::PDFArea([[maybe_unused]] const Math::Vector3f& p,
+                  [[maybe_unused]] const Math::Vector3f& pointOnSurface) const
+{
+    // 表面上で一様にサンプリングしている
+    const Math::Vector3f e0 = m_vertices[1]->pos - m_vertices[0]->pos;
+    const Math::Vector3f e1 = m_vertices[2]->pos - m_vertices[0]->pos;
+    return 1.0f / (0.5f * Math::Cross(e0, e1).Length());
+}
+
 } // namespace Core
 } // namespace Petrichor
@@ -36,6 +36,9 @@ public:
     AABB
     CalcBoundary() const override;
 
+    AABB
+    CalcClippedBoundary(const AABB& clipBoundary) const override;
+
     std::optional<HitInfo>
     Intersect(const Ray& ray) const override;
 
@@ -55,6 +58,10 @@ public:
                   PointData* pointData,
                   float* pdfArea) const override;
 
+    float
+    PDFArea(const Math::Vector3f& p,
+            const Math::Vector3f& pointOnSurface) const override;
+
 protected:
     std::array<const Vertex*, 3> m_vertices{};
     ShadingTypes m_shadingType = ShadingTypes::Flat;
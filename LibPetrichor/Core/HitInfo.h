@@ -2,6 +2,7 @@
 
 #include "Core/Constants.h"
 #include "Math/Vector3f.h"
+#include <cstdint>
 
 namespace Petrichor
 {
@@ -15,6 +16,7 @@ struct HitInfo
 {
     float distance = kInfinity; // 反射点から衝突点までの距離
     const GeometryBase* hitObj = nullptr; // 衝突したジオメトリへのポインタ
+    uint32_t geometryIndex = 0; //!< Scene::GetGeometries() 内の番号
 };
 
 struct ShadingInfo
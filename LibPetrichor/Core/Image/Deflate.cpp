@@ -0,0 +1,453 @@
+#include "Deflate.h"
+
+#include <algorithm>
+#include <array>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+constexpr int64_t kWindowSize = 32768;
+constexpr int kMinMatchLength = 3;
+constexpr int kMaxMatchLength = 258;
+constexpr int kHashBits = 15;
+
+//! ハッシュチェインを辿る最大回数(大きいほど圧縮率が上がり遅くなる)
+constexpr int kMaxChainLength = 32;
+
+constexpr int kEndOfBlock = 256;
+
+constexpr std::array<uint16_t, 29> kLengthBases = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+constexpr std::array<uint8_t, 29> kLengthExtraBits = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+    2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+constexpr std::array<uint16_t, 30> kDistanceBases = {
+    1,    2,    3,    4,    5,    7,     9,     13,    17,    25,
+    33,   49,   65,   97,   129,  193,   257,   385,   513,   769,
+    1025, 1537, 2049, 3073, 4097, 6145,  8193,  12289, 16385, 24577
+};
+
+constexpr std::array<uint8_t, 30> kDistanceExtraBits = {
+    0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+//! ハフマン符号(書き込み順に反転済み)
+struct HuffmanCode
+{
+    uint16_t bits = 0;
+    uint8_t numBits = 0;
+};
+
+//! 固定ハフマン符号と、長さ・距離から符号番号を引くテーブル
+struct FixedHuffmanTables
+{
+    std::array<HuffmanCode, 288> literalCodes;
+    std::array<HuffmanCode, 30> distanceCodes;
+    std::array<uint8_t, kMaxMatchLength + 1> lengthSymbols{};
+    std::array<uint8_t, kWindowSize + 1> distanceSymbols{};
+
+    FixedHuffmanTables()
+    {
+        const auto reverse = [](uint32_t code, int numBits) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < numBits; i++)
+            {
+                reversed = (reversed << 1) | ((code >> i) & 1);
+            }
+            return HuffmanCode{ static_cast<uint16_t>(reversed),
+                                static_cast<uint8_t>(numBits) };
+        };
+
+        // RFC 1951 3.2.6
+        for (int symbol = 0; symbol < 288; symbol++)
+        {
+            if (symbol < 144)
+            {
+                literalCodes[symbol] = reverse(0x30 + symbol, 8);
+            }
+            else if (symbol < 256)
+            {
+                literalCodes[symbol] = reverse(0x190 + (symbol - 144), 9);
+            }
+            else if (symbol < 280)
+            {
+                literalCodes[symbol] = reverse(symbol - 256, 7);
+            }
+            else
+            {
+                literalCodes[symbol] = reverse(0xC0 + (symbol - 280), 8);
+            }
+        }
+
+        for (int symbol = 0; symbol < 30; symbol++)
+        {
+            distanceCodes[symbol] = reverse(symbol, 5);
+        }
+
+        for (uint8_t symbol = 0; symbol < kLengthBases.size(); symbol++)
+        {
+            for (int length = kLengthBases[symbol]; length <= kMaxMatchLength;
+                 length++)
+            {
+                lengthSymbols[length] = symbol;
+            }
+        }
+
+        for (uint8_t symbol = 0; symbol < kDistanceBases.size(); symbol++)
+        {
+            for (int64_t distance = kDistanceBases[symbol];
+                 distance <= kWindowSize;
+                 distance++)
+            {
+                distanceSymbols[distance] = symbol;
+            }
+        }
+    }
+
+    static const FixedHuffmanTables&
+    GetInstance()
+    {
+        static const FixedHuffmanTables tables;
+        return tables;
+    }
+};
+
+//! LSBから詰めていくビット列の書き込み
+class BitWriter
+{
+public:
+    explicit BitWriter(std::vector<uint8_t>* out)
+      : m_out(out)
+    {
+    }
+
+    void
+    Write(uint32_t bits, int numBits)
+    {
+        m_bitBuffer |= static_cast<uint64_t>(bits) << m_numBits;
+        m_numBits += numBits;
+        while (m_numBits >= 8)
+        {
+            m_out->push_back(static_cast<uint8_t>(m_bitBuffer));
+            m_bitBuffer >>= 8;
+            m_numBits -= 8;
+        }
+    }
+
+    void
+    Write(const HuffmanCode& code)
+    {
+        Write(code.bits, code.numBits);
+    }
+
+    void
+    AlignToByte()
+    {
+        if (m_numBits > 0)
+        {
+            Write(0, 8 - m_numBits);
+        }
+    }
+
+private:
+    std::vector<uint8_t>* m_out = nullptr;
+    uint64_t m_bitBuffer = 0;
+    int m_numBits = 0;
+};
+
+//! LZ77の一致
+struct Match
+{
+    int length = 0;
+    int64_t distance = 0;
+};
+
+//! ハッシュチェインによる一致の探索
+class MatchFinder
+{
+public:
+    MatchFinder(const uint8_t* data, int64_t size)
+      : m_data(data)
+      , m_size(size)
+      , m_heads(size_t(1) << kHashBits, -1)
+      , m_prevs(kWindowSize, -1)
+    {
+    }
+
+    //! pos から始まる最長の一致を探す
+    Match
+    Find(int64_t pos) const
+    {
+        Match best;
+        if (pos + kMinMatchLength > m_size)
+        {
+            return best;
+        }
+
+        const int maxLength =
+          static_cast<int>(std::min<int64_t>(kMaxMatchLength, m_size - pos));
+        const uint8_t* const current = m_data + pos;
+
+        int64_t candidate = m_heads[CalcHash(pos)];
+        for (int chain = 0; chain < kMaxChainLength && candidate >= 0 &&
+                            pos - candidate <= kWindowSize;
+             chain++)
+        {
+            const uint8_t* const past = m_data + candidate;
+            if (past[best.length] == current[best.length])
+            {
+                int length = 0;
+                while (length < maxLength && past[length] == current[length])
+                {
+                    length++;
+                }
+
+                if (length > best.length)
+                {
+                    best.length = length;
+                    best.distance = pos - candidate;
+                    if (length == maxLength)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            candidate = m_prevs[candidate % kWindowSize];
+        }
+
+        if (best.length < kMinMatchLength)
+        {
+            best.length = 0;
+        }
+        return best;
+    }
+
+    //! pos をハッシュチェインに登録する
+    void
+    Insert(int64_t pos)
+    {
+        if (pos + kMinMatchLength > m_size)
+        {
+            return;
+        }
+
+        int64_t& head = m_heads[CalcHash(pos)];
+        m_prevs[pos % kWindowSize] = head;
+        head = pos;
+    }
+
+private:
+    uint32_t
+    CalcHash(int64_t pos) const
+    {
+        const uint32_t key = (m_data[pos] << 16) | (m_data[pos + 1] << 8) |
+                             m_data[pos + 2];
+        return (key * 2654435761u) >> (32 - kHashBits);
+    }
+
+    const uint8_t* m_data = nullptr;
+    int64_t m_size = 0;
+    std::vector<int64_t> m_heads; //!< ハッシュごとの最新の位置
+    std::vector<int64_t> m_prevs; //!< 同じハッシュの1つ前の位置
+};
+
+} // namespace
+
+void
+CompressDeflate(const uint8_t* data,
+                size_t size,
+                bool isFinal,
+                std::vector<uint8_t>* out)
+{
+    const FixedHuffmanTables& tables = FixedHuffmanTables::GetInstance();
+    BitWriter writer(out);
+
+    // 全体を1つの固定ハフマン符号のブロックにする
+    writer.Write(isFinal ? 1 : 0, 1);
+    writer.Write(1, 2);
+
+    const auto writeLiteral = [&](uint8_t literal) {
+        writer.Write(tables.literalCodes[literal]);
+    };
+
+    const auto writeMatch = [&](const Match& match) {
+        const uint8_t lengthSymbol = tables.lengthSymbols[match.length];
+        writer.Write(tables.literalCodes[kEndOfBlock + 1 + lengthSymbol]);
+        writer.Write(match.length - kLengthBases[lengthSymbol],
+                     kLengthExtraBits[lengthSymbol]);
+
+        const uint8_t distanceSymbol = tables.distanceSymbols[match.distance];
+        writer.Write(tables.distanceCodes[distanceSymbol]);
+        writer.Write(
+          static_cast<uint32_t>(match.distance -
+                                kDistanceBases[distanceSymbol]),
+          kDistanceExtraBits[distanceSymbol]);
+    };
+
+    const auto numBytes = static_cast<int64_t>(size);
+    MatchFinder matchFinder(data, numBytes);
+
+    int64_t pos = 0;
+    while (pos < numBytes)
+    {
+        const Match match = matchFinder.Find(pos);
+        matchFinder.Insert(pos);
+
+        if (match.length == 0)
+        {
+            writeLiteral(data[pos]);
+            pos++;
+            continue;
+        }
+
+        // 1つ先から始めた方が長く一致する場合は、ここをリテラルにする
+        if (matchFinder.Find(pos + 1).length > match.length)
+        {
+            writeLiteral(data[pos]);
+            pos++;
+            continue;
+        }
+
+        writeMatch(match);
+        for (int i = 1; i < match.length; i++)
+        {
+            matchFinder.Insert(pos + i);
+        }
+        pos += match.length;
+    }
+
+    writer.Write(tables.literalCodes[kEndOfBlock]);
+
+    if (isFinal)
+    {
+        writer.AlignToByte();
+        return;
+    }
+
+    // 空の非圧縮ブロックでバイト境界に揃える
+    writer.Write(0, 1);
+    writer.Write(0, 2);
+    writer.AlignToByte();
+    out->insert(out->end(), { 0x00, 0x00, 0xFF, 0xFF });
+}
+
+void
+CompressZlib(const uint8_t* data, size_t size, std::vector<uint8_t>* out)
+{
+    WriteZlibHeader(out);
+    CompressDeflate(data, size, true, out);
+
+    const uint32_t adler = CalcAdler32(data, size);
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        out->push_back(static_cast<uint8_t>(adler >> shift));
+    }
+}
+
+void
+WriteZlibHeader(std::vector<uint8_t>* out)
+{
+    // Deflate、ウィンドウサイズ 32KiB
+    out->insert(out->end(), { 0x78, 0x5E });
+}
+
+uint32_t
+CalcAdler32(const uint8_t* data, size_t size, uint32_t adler)
+{
+    constexpr uint32_t kBase = 65521;
+
+    // 32bitで溢れない最大のバイト数ごとに剰余を取る
+    constexpr size_t kMaxBlockSize = 5552;
+
+    uint32_t sum1 = adler & 0xFFFF;
+    uint32_t sum2 = adler >> 16;
+    while (size > 0)
+    {
+        const size_t blockSize = std::min(size, kMaxBlockSize);
+        for (size_t i = 0; i < blockSize; i++)
+        {
+            sum1 += data[i];
+            sum2 += sum1;
+        }
+        sum1 %= kBase;
+        sum2 %= kBase;
+
+        data += blockSize;
+        size -= blockSize;
+    }
+
+    return (sum2 << 16) | sum1;
+}
+
+uint32_t
+CombineAdler32(uint32_t adler1, uint32_t adler2, size_t size2)
+{
+    // zlib の adler32_combine() と同じ計算
+    constexpr uint32_t kBase = 65521;
+
+    const auto remainder = static_cast<uint32_t>(size2 % kBase);
+    uint32_t sum1 = adler1 & 0xFFFF;
+    uint32_t sum2 = static_cast<uint32_t>(
+      (static_cast<uint64_t>(remainder) * sum1) % kBase);
+    sum1 += (adler2 & 0xFFFF) + kBase - 1;
+    sum2 += (adler1 >> 16) + (adler2 >> 16) + kBase - remainder;
+
+    if (sum1 >= kBase)
+    {
+        sum1 -= kBase;
+    }
+    if (sum1 >= kBase)
+    {
+        sum1 -= kBase;
+    }
+    if (sum2 >= 2 * kBase)
+    {
+        sum2 -= 2 * kBase;
+    }
+    if (sum2 >= kBase)
+    {
+        sum2 -= kBase;
+    }
+
+    return (sum2 << 16) | sum1;
+}
+
+uint32_t
+CalcCRC32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> table_{};
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table_[i] = c;
+        }
+        return table_;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! Deflate(RFC 1951)の圧縮
+//! 固定ハフマン符号とハッシュチェインによるLZ77だけの簡易な実装。
+//! 非終端で圧縮したデータは空の非圧縮ブロックでバイト境界に揃えて終える
+//! (zlibの Z_SYNC_FLUSH 相当)ので、別々に圧縮した結果をそのまま連結できる。
+//! 連結したものは、最後に isFinal = true で圧縮したデータで終えること
+//! @param isFinal 最終ブロックとして終えるか
+//! @param out 圧縮結果を末尾に追加する
+void
+CompressDeflate(const uint8_t* data,
+                size_t size,
+                bool isFinal,
+                std::vector<uint8_t>* out);
+
+//! zlib(RFC 1950)形式で圧縮する
+//! @param out 圧縮結果を末尾に追加する
+void
+CompressZlib(const uint8_t* data, size_t size, std::vector<uint8_t>* out);
+
+//! zlib形式のヘッダ(2byte)を書き込む
+void
+WriteZlibHeader(std::vector<uint8_t>* out);
+
+//! Adler-32 チェックサムを計算する
+//! @param adler 続きから計算する場合は直前までの値
+uint32_t
+CalcAdler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+//! 連続する2つのデータの Adler-32 を結合する
+//! @param size2 後半のデータのバイト数
+uint32_t
+CombineAdler32(uint32_t adler1, uint32_t adler2, size_t size2);
+
+//! CRC-32 を計算する
+//! @param crc 続きから計算する場合は直前までの値
+uint32_t
+CalcCRC32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+} // namespace Core
+} // namespace Petrichor
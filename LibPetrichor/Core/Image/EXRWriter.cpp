@@ -0,0 +1,543 @@
+#include "EXRWriter.h"
+
+#include "Core/Image/Deflate.h"
+#include "Core/Logger.h"
+#include "Core/Texture2D.h"
+#include "Core/Thread/ThreadPool.h"
+#include "Math/Half.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+constexpr std::array<char, 3> kComponentNames = { 'R', 'G', 'B' };
+
+//! ファイルのバージョン番号
+constexpr uint32_t kVersion = 2;
+
+//! 32文字以上の属性名やチャンネル名を含む場合のフラグ
+constexpr uint32_t kLongNamesFlag = 0x400;
+
+//! タイル形式のフラグ
+constexpr uint32_t kTiledFlag = 0x200;
+
+constexpr size_t kMaxShortNameLength = 31;
+
+//! チャンネルの型(HALF)
+constexpr int32_t kPixelTypeHalf = 1;
+
+struct Channel
+{
+    std::string name;
+    const Color3f* pixels = nullptr; //!< 左上の画素
+    size_t rowStride = 0;            //!< 隣り合う行の間隔[画素]
+    int component = 0;
+};
+
+uint8_t
+GetCompressionId(EXRWriter::Compression compression)
+{
+    return compression == EXRWriter::Compression::Zip ? 3 : 0;
+}
+
+int
+GetNumLinesInChunk(EXRWriter::Compression compression)
+{
+    return compression == EXRWriter::Compression::Zip ? 16 : 1;
+}
+
+// ---- リトルエンディアンでの書き込み ----
+
+void
+AppendUInt32(uint32_t value, std::vector<uint8_t>* out)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void
+AppendUInt64(uint64_t value, std::vector<uint8_t>* out)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void
+AppendFloat(float value, std::vector<uint8_t>* out)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    AppendUInt32(bits, out);
+}
+
+void
+AppendString(const std::string& str, std::vector<uint8_t>* out)
+{
+    out->insert(out->end(), str.begin(), str.end());
+    out->push_back('\0');
+}
+
+//! 属性(名前、型名、サイズ、値)を追加する
+void
+AppendAttribute(const std::string& name,
+                const std::string& typeName,
+                const std::vector<uint8_t>& value,
+                std::vector<uint8_t>* out)
+{
+    AppendString(name, out);
+    AppendString(typeName, out);
+    AppendUInt32(static_cast<uint32_t>(value.size()), out);
+    out->insert(out->end(), value.begin(), value.end());
+}
+
+//! ヘッダを作る
+//! @param tileWidth 0 の場合はスキャンライン、それ以外はタイルの形式にする
+std::vector<uint8_t>
+MakeHeader(const std::vector<Channel>& channels,
+           EXRWriter::Compression compression,
+           int width,
+           int height,
+           int tileWidth = 0,
+           int tileHeight = 0)
+{
+    std::vector<uint8_t> header = { 0x76, 0x2F, 0x31, 0x01 };
+
+    const bool isTiled = tileWidth > 0;
+    const bool hasLongName =
+      std::any_of(channels.begin(), channels.end(), [](const Channel& ch) {
+          return ch.name.size() > kMaxShortNameLength;
+      });
+    AppendUInt32(kVersion | (isTiled ? kTiledFlag : 0) |
+                   (hasLongName ? kLongNamesFlag : 0),
+                 &header);
+
+    std::vector<uint8_t> value;
+
+    value.clear();
+    for (const Channel& channel : channels)
+    {
+        AppendString(channel.name, &value);
+        AppendUInt32(kPixelTypeHalf, &value);
+        value.insert(value.end(), { 0, 0, 0, 0 }); // pLinear と予約領域
+        AppendUInt32(1, &value);                   // xSampling
+        AppendUInt32(1, &value);                   // ySampling
+    }
+    value.push_back('\0');
+    AppendAttribute("channels", "chlist", value, &header);
+
+    value = { GetCompressionId(compression) };
+    AppendAttribute("compression", "compression", value, &header);
+
+    value.clear();
+    AppendUInt32(0, &value);
+    AppendUInt32(0, &value);
+    AppendUInt32(width - 1, &value);
+    AppendUInt32(height - 1, &value);
+    AppendAttribute("dataWindow", "box2i", value, &header);
+    AppendAttribute("displayWindow", "box2i", value, &header);
+
+    // タイルは完成した順に書き込むので RANDOM_Y にする
+    value = { static_cast<uint8_t>(isTiled ? 2 : 0) };
+    AppendAttribute("lineOrder", "lineOrder", value, &header);
+
+    value.clear();
+    AppendFloat(1.0f, &value);
+    AppendAttribute("pixelAspectRatio", "float", value, &header);
+
+    value.clear();
+    AppendFloat(0.0f, &value);
+    AppendFloat(0.0f, &value);
+    AppendAttribute("screenWindowCenter", "v2f", value, &header);
+
+    value.clear();
+    AppendFloat(1.0f, &value);
+    AppendAttribute("screenWindowWidth", "float", value, &header);
+
+    if (isTiled)
+    {
+        value.clear();
+        AppendUInt32(tileWidth, &value);
+        AppendUInt32(tileHeight, &value);
+        value.push_back(0); // ONE_LEVEL
+        AppendAttribute("tiles", "tiledesc", value, &header);
+    }
+
+    header.push_back('\0');
+    return header;
+}
+
+//! チャンネル R, G, B を作る
+void
+AppendChannels(const std::string& layerName,
+               const Color3f* pixels,
+               size_t rowStride,
+               std::vector<Channel>* channels)
+{
+    for (int component = 0; component < 3; component++)
+    {
+        Channel channel;
+        channel.name = layerName.empty() ? "" : layerName + ".";
+        channel.name += kComponentNames[component];
+        channel.pixels = pixels;
+        channel.rowStride = rowStride;
+        channel.component = component;
+        channels->emplace_back(std::move(channel));
+    }
+}
+
+//! チャンネルを名前の昇順に並べる(ファイル内の順序)
+void
+SortChannels(std::vector<Channel>* channels)
+{
+    std::sort(channels->begin(),
+              channels->end(),
+              [](const Channel& a, const Channel& b) {
+                  return a.name < b.name;
+              });
+}
+
+//! ZIP 圧縮の前処理
+//! 半精度の上位と下位のバイトを分けて並べ、隣との差分をとる
+std::vector<uint8_t>
+ReorderAndPredict(const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> out(data.size());
+
+    const size_t numEvenBytes = (data.size() + 1) / 2;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        out[(i % 2 == 0) ? i / 2 : numEvenBytes + i / 2] = data[i];
+    }
+
+    for (size_t i = out.size() - 1; i > 0; i--)
+    {
+        out[i] = static_cast<uint8_t>(out[i] - out[i - 1] + 128);
+    }
+
+    return out;
+}
+
+//! 行ごとに、チャンネル名の順に1行分の半精度の値を並べる
+std::vector<uint8_t>
+PackLines(const std::vector<Channel>& channels,
+          int width,
+          int lineBegin,
+          int lineEnd)
+{
+    std::vector<uint8_t> data;
+    data.reserve(static_cast<size_t>(lineEnd - lineBegin) * channels.size() *
+                 width * sizeof(uint16_t));
+    for (int y = lineBegin; y < lineEnd; y++)
+    {
+        for (const Channel& channel : channels)
+        {
+            const Color3f* row = channel.pixels + y * channel.rowStride;
+            for (int x = 0; x < width; x++)
+            {
+                const uint16_t half =
+                  Math::FloatToHalf(row[x][channel.component]);
+                data.push_back(static_cast<uint8_t>(half));
+                data.push_back(static_cast<uint8_t>(half >> 8));
+            }
+        }
+    }
+    return data;
+}
+
+//! チャンクのデータのサイズとデータを追加する
+void
+AppendChunkData(const std::vector<uint8_t>& data,
+                EXRWriter::Compression compression,
+                std::vector<uint8_t>* chunk)
+{
+    const size_t sizePos = chunk->size();
+    AppendUInt32(0, chunk); // データのサイズ(後で埋める)
+
+    if (compression == EXRWriter::Compression::Zip)
+    {
+        const std::vector<uint8_t> predicted = ReorderAndPredict(data);
+        CompressZlib(predicted.data(), predicted.size(), chunk);
+    }
+
+    // 圧縮で小さくならなければ無圧縮で格納する(読み込み側はサイズで判別する)
+    const size_t dataPos = sizePos + sizeof(uint32_t);
+    if (compression == EXRWriter::Compression::None ||
+        chunk->size() - dataPos >= data.size())
+    {
+        chunk->resize(dataPos);
+        chunk->insert(chunk->end(), data.begin(), data.end());
+    }
+
+    const auto dataSize = static_cast<uint32_t>(chunk->size() - dataPos);
+    for (int i = 0; i < 4; i++)
+    {
+        (*chunk)[sizePos + i] = static_cast<uint8_t>(dataSize >> (8 * i));
+    }
+}
+
+} // namespace
+
+void
+EXRWriter::AddLayer(const std::string& layerName, const Texture2D& texture)
+{
+    m_layers.push_back({ layerName, &texture });
+}
+
+bool
+EXRWriter::Write(const std::filesystem::path& path, uint32_t numThreads) const
+{
+    if (m_layers.empty())
+    {
+        Logger::Error("No layers to write. [{}]", path.string());
+        return false;
+    }
+
+    const int width = m_layers.front().texture->GetWidth();
+    const int height = m_layers.front().texture->GetHeight();
+    for (const Layer& layer : m_layers)
+    {
+        if (width <= 0 || height <= 0 ||
+            layer.texture->GetWidth() != width ||
+            layer.texture->GetHeight() != height)
+        {
+            Logger::Error("Invalid layer size. [{}] (layer: {})",
+                          path.string(),
+                          layer.name);
+            return false;
+        }
+    }
+
+    std::vector<Channel> channels;
+    for (const Layer& layer : m_layers)
+    {
+        AppendChannels(
+          layer.name, layer.texture->GetPixelData(), width, &channels);
+    }
+    SortChannels(&channels);
+
+    const auto duplicated = std::adjacent_find(
+      channels.begin(), channels.end(), [](const Channel& a, const Channel& b) {
+          return a.name == b.name;
+      });
+    if (duplicated != channels.end())
+    {
+        Logger::Error("Duplicated channel name. [{}] (channel: {})",
+                      path.string(),
+                      duplicated->name);
+        return false;
+    }
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs)
+    {
+        Logger::Error("Could not open file. [{}]", path.string());
+        return false;
+    }
+
+    // ---- チャンクごとに変換して圧縮する ----
+    const int numLinesInChunk = GetNumLinesInChunk(m_compression);
+    const int numChunks = (height + numLinesInChunk - 1) / numLinesInChunk;
+
+    std::vector<std::vector<uint8_t>> chunks(numChunks);
+    {
+        ThreadPool threadPool(numThreads);
+        for (int chunkIndex = 0; chunkIndex < numChunks; chunkIndex++)
+        {
+            threadPool.Push([&, chunkIndex](size_t) {
+                const int lineBegin = chunkIndex * numLinesInChunk;
+                const int lineEnd =
+                  std::min(lineBegin + numLinesInChunk, height);
+
+                std::vector<uint8_t>& chunk = chunks[chunkIndex];
+                AppendUInt32(lineBegin, &chunk);
+                AppendChunkData(PackLines(channels, width, lineBegin, lineEnd),
+                                m_compression,
+                                &chunk);
+            });
+        }
+    }
+
+    // ---- 書き出し ----
+    const std::vector<uint8_t> header =
+      MakeHeader(channels, m_compression, width, height);
+
+    std::vector<uint8_t> offsetTable;
+    uint64_t offset = header.size() + sizeof(uint64_t) * numChunks;
+    for (const std::vector<uint8_t>& chunk : chunks)
+    {
+        AppendUInt64(offset, &offsetTable);
+        offset += chunk.size();
+    }
+
+    ofs.write(reinterpret_cast<const char*>(header.data()), header.size());
+    ofs.write(reinterpret_cast<const char*>(offsetTable.data()),
+              offsetTable.size());
+    for (const std::vector<uint8_t>& chunk : chunks)
+    {
+        ofs.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+    }
+
+    if (!ofs)
+    {
+        Logger::Error("Could not write file. [{}]", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+TiledEXRWriter::~TiledEXRWriter()
+{
+    Close();
+}
+
+bool
+TiledEXRWriter::Open(const std::filesystem::path& path,
+                     int width,
+                     int height,
+                     int tileWidth,
+                     int tileHeight,
+                     EXRWriter::Compression compression)
+{
+    Close();
+
+    if (width <= 0 || height <= 0 || tileWidth <= 0 || tileHeight <= 0)
+    {
+        Logger::Error("Invalid image or tile size. [{}]", path.string());
+        return false;
+    }
+
+    m_ofs.open(path, std::ios::binary);
+    if (!m_ofs)
+    {
+        Logger::Error("Could not open file. [{}]", path.string());
+        return false;
+    }
+
+    m_path = path;
+    m_width = width;
+    m_height = height;
+    m_tileWidth = tileWidth;
+    m_tileHeight = tileHeight;
+    m_numTilesX = (width + tileWidth - 1) / tileWidth;
+    m_numTilesY = (height + tileHeight - 1) / tileHeight;
+    m_compression = compression;
+
+    // ヘッダにはチャンネル名しか使わないので画素は指さなくてよい
+    std::vector<Channel> channels;
+    AppendChannels("", nullptr, 0, &channels);
+    SortChannels(&channels);
+
+    const std::vector<uint8_t> header =
+      MakeHeader(channels, compression, width, height, tileWidth, tileHeight);
+    m_offsetTablePos = header.size();
+
+    // 書き込まれていないタイルのオフセットは0のままにする
+    const std::vector<uint8_t> offsetTable(
+      sizeof(uint64_t) * m_numTilesX * m_numTilesY, 0);
+
+    m_ofs.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_ofs.write(reinterpret_cast<const char*>(offsetTable.data()),
+                offsetTable.size());
+    m_ofs.flush();
+
+    if (!m_ofs)
+    {
+        Logger::Error("Could not write file. [{}]", path.string());
+        m_ofs.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+TiledEXRWriter::WriteTile(int x,
+                          int y,
+                          int width,
+                          int height,
+                          const Color3f* pixels,
+                          size_t rowStride)
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    if (x % m_tileWidth != 0 || y % m_tileHeight != 0 ||
+        width != std::min(m_tileWidth, m_width - x) ||
+        height != std::min(m_tileHeight, m_height - y))
+    {
+        Logger::Error("Tile is not aligned to the tile grid. [{}] "
+                      "(x: {}, y: {}, width: {}, height: {})",
+                      m_path.string(),
+                      x,
+                      y,
+                      width,
+                      height);
+        return false;
+    }
+
+    const int tileX = x / m_tileWidth;
+    const int tileY = y / m_tileHeight;
+
+    // 変換と圧縮は排他せずに行う
+    std::vector<Channel> channels;
+    AppendChannels("", pixels, rowStride, &channels);
+    SortChannels(&channels);
+
+    std::vector<uint8_t> chunk;
+    AppendUInt32(tileX, &chunk);
+    AppendUInt32(tileY, &chunk);
+    AppendUInt32(0, &chunk); // levelX
+    AppendUInt32(0, &chunk); // levelY
+    AppendChunkData(
+      PackLines(channels, width, 0, height), m_compression, &chunk);
+
+    std::vector<uint8_t> offset;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // タイルを末尾に追加してから、オフセットテーブルを更新する
+    m_ofs.seekp(0, std::ios::end);
+    AppendUInt64(static_cast<uint64_t>(m_ofs.tellp()), &offset);
+    m_ofs.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+
+    const size_t tileIndex = static_cast<size_t>(tileY) * m_numTilesX + tileX;
+    m_ofs.seekp(m_offsetTablePos + sizeof(uint64_t) * tileIndex);
+    m_ofs.write(reinterpret_cast<const char*>(offset.data()), offset.size());
+    m_ofs.flush();
+
+    if (!m_ofs)
+    {
+        Logger::Error("Could not write file. [{}]", m_path.string());
+        return false;
+    }
+
+    return true;
+}
+
+void
+TiledEXRWriter::Close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ofs.is_open())
+    {
+        m_ofs.close();
+    }
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Core/Color3f.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+class Texture2D;
+
+//! OpenEXR 形式(半精度浮動小数点数、スキャンライン)の書き出し
+//! 複数のテクスチャをレイヤーとして1つのファイルにまとめられる。
+//! 全てのレイヤーは同じ解像度であること
+class EXRWriter
+{
+public:
+    enum class Compression
+    {
+        None, //!< 無圧縮(1行ごとのチャンク)
+        Zip   //!< 可逆圧縮(16行ごとのチャンクを zlib で圧縮)
+    };
+
+    //! レイヤーを追加する
+    //! テクスチャは Write() を呼ぶまで保持しておくこと
+    //! @param layerName 空の場合はチャンネル名を R, G, B に、
+    //!                  それ以外は layerName.R のようにする
+    void
+    AddLayer(const std::string& layerName, const Texture2D& texture);
+
+    void
+    SetCompression(Compression compression)
+    {
+        m_compression = compression;
+    }
+
+    //! 書き出す
+    //! チャンクの変換と圧縮はスレッドプールで並列に行う
+    //! @param numThreads 0 の場合はハードウェアのスレッド数
+    //! @return 書き出しに成功したか
+    bool
+    Write(const std::filesystem::path& path, uint32_t numThreads = 0) const;
+
+private:
+    struct Layer
+    {
+        std::string name;
+        const Texture2D* texture = nullptr;
+    };
+
+    std::vector<Layer> m_layers;
+    Compression m_compression = Compression::Zip;
+};
+
+//! OpenEXR 形式(半精度浮動小数点数、タイル、RGB)の逐次書き出し
+//! タイルは完成した順に書き込める。タイルを書き込むたびにオフセットテーブルの
+//! 該当箇所を更新してフラッシュするので、途中で異常終了しても
+//! 書き込み済みのタイルは読める
+class TiledEXRWriter
+{
+public:
+    TiledEXRWriter() = default;
+
+    TiledEXRWriter(const TiledEXRWriter&) = delete;
+
+    TiledEXRWriter&
+    operator=(const TiledEXRWriter&) = delete;
+
+    ~TiledEXRWriter();
+
+    //! ファイルを開いてヘッダと空のオフセットテーブルを書き込む
+    //! @return 成功したか
+    bool
+    Open(const std::filesystem::path& path,
+         int width,
+         int height,
+         int tileWidth,
+         int tileHeight,
+         EXRWriter::Compression compression = EXRWriter::Compression::Zip);
+
+    //! タイルを書き込む
+    //! 複数のスレッドから同時に呼んでよい(変換と圧縮は呼び出し元で行う)
+    //! @param x, y タイルの左上の画素の座標(タイルの大きさの倍数であること)
+    //! @param pixels タイルの左上の画素
+    //! @param rowStride pixels の隣り合う行の間隔[画素]
+    //! @return 成功したか
+    bool
+    WriteTile(int x,
+              int y,
+              int width,
+              int height,
+              const Color3f* pixels,
+              size_t rowStride);
+
+    //! ファイルを閉じる
+    void
+    Close();
+
+    bool
+    IsOpen() const
+    {
+        return m_ofs.is_open();
+    }
+
+private:
+    std::ofstream m_ofs;
+    std::mutex m_mutex; //!< m_ofs への書き込みの排他
+
+    std::filesystem::path m_path;
+    int m_width = 0;
+    int m_height = 0;
+    int m_tileWidth = 0;
+    int m_tileHeight = 0;
+    int m_numTilesX = 0;
+    int m_numTilesY = 0;
+    EXRWriter::Compression m_compression = EXRWriter::Compression::Zip;
+
+    //! オフセットテーブルの先頭の位置[byte]
+    uint64_t m_offsetTablePos = 0;
+};
+
+} // namespace Core
+} // namespace Petrichor
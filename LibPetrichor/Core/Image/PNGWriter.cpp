@@ -0,0 +1,279 @@
+#include "PNGWriter.h"
+
+#include "Core/Image/Deflate.h"
+#include "Core/Logger.h"
+#include "Core/Thread/ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+constexpr int kNumChannels = 3;
+
+//! 1つの帯の最小の行数(帯ごとに辞書が切れるので、小さすぎると圧縮率が落ちる)
+constexpr int kMinNumRowsInBand = 32;
+
+//! 帯の数の上限(スレッドあたり)
+constexpr int kNumBandsPerThread = 4;
+
+constexpr size_t kNumFilterTypes = 5;
+
+uint8_t
+PaethPredictor(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+    {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+//! 1行をフィルタする
+//! libpng の既定と同じく、差分の絶対値の和が最小になるフィルタを選ぶ
+//! @param prevRow 1つ上の行(先頭行の場合は0で埋めた行)
+//! @param out フィルタの種類(1byte) + rowSize バイトの書き込み先
+void
+FilterRow(const uint8_t* row,
+          const uint8_t* prevRow,
+          size_t rowSize,
+          std::array<std::vector<uint8_t>, kNumFilterTypes>* candidates,
+          uint8_t* out)
+{
+    uint64_t bestCost = std::numeric_limits<uint64_t>::max();
+    size_t bestFilterType = 0;
+
+    for (size_t filterType = 0; filterType < kNumFilterTypes; filterType++)
+    {
+        std::vector<uint8_t>& filtered = (*candidates)[filterType];
+        filtered.resize(rowSize);
+
+        uint64_t cost = 0;
+        for (size_t i = 0; i < rowSize; i++)
+        {
+            const int left = i >= kNumChannels ? row[i - kNumChannels] : 0;
+            const int up = prevRow[i];
+            const int upLeft =
+              i >= kNumChannels ? prevRow[i - kNumChannels] : 0;
+
+            uint8_t predicted = 0;
+            switch (filterType)
+            {
+            case 1:
+                predicted = static_cast<uint8_t>(left);
+                break;
+            case 2:
+                predicted = static_cast<uint8_t>(up);
+                break;
+            case 3:
+                predicted = static_cast<uint8_t>((left + up) / 2);
+                break;
+            case 4:
+                predicted = PaethPredictor(left, up, upLeft);
+                break;
+            default:
+                break;
+            }
+
+            filtered[i] = static_cast<uint8_t>(row[i] - predicted);
+            cost += std::abs(static_cast<int8_t>(filtered[i]));
+        }
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestFilterType = filterType;
+        }
+    }
+
+    out[0] = static_cast<uint8_t>(bestFilterType);
+    std::copy((*candidates)[bestFilterType].begin(),
+              (*candidates)[bestFilterType].end(),
+              out + 1);
+}
+
+void
+AppendUInt32(uint32_t value, std::vector<uint8_t>* out)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        out->push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+//! 型(4byte) + データのチャンクを作る(長さとCRCは WriteChunk() で付ける)
+std::vector<uint8_t>
+BeginChunk(const char* type)
+{
+    return std::vector<uint8_t>(type, type + 4);
+}
+
+void
+WriteChunk(std::ofstream& ofs, const std::vector<uint8_t>& typeAndData)
+{
+    std::vector<uint8_t> header;
+    AppendUInt32(static_cast<uint32_t>(typeAndData.size() - 4), &header);
+
+    std::vector<uint8_t> footer;
+    AppendUInt32(CalcCRC32(typeAndData.data(), typeAndData.size()), &footer);
+
+    ofs.write(reinterpret_cast<const char*>(header.data()), header.size());
+    ofs.write(reinterpret_cast<const char*>(typeAndData.data()),
+              typeAndData.size());
+    ofs.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+}
+
+} // namespace
+
+bool
+WritePNG(const std::filesystem::path& path,
+         int width,
+         int height,
+         const PNGRowGenerator& generateRow,
+         uint32_t numThreads)
+{
+    if (width <= 0 || height <= 0 || !generateRow)
+    {
+        Logger::Error("Invalid image. [{}]", path.string());
+        return false;
+    }
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs)
+    {
+        Logger::Error("Could not open file. [{}]", path.string());
+        return false;
+    }
+
+    const size_t rowSize = static_cast<size_t>(width) * kNumChannels;
+
+    // ---- 帯ごとにフィルタして圧縮する ----
+    struct Band
+    {
+        int rowBegin = 0;
+        int rowEnd = 0;
+        std::vector<uint8_t> chunk; //!< IDAT チャンクの型とデータ
+        uint32_t adler = 1;         //!< フィルタ後のデータの Adler-32
+        size_t filteredSize = 0;
+    };
+
+    std::vector<Band> bands;
+    {
+        ThreadPool threadPool(numThreads);
+
+        const int maxNumBands =
+          static_cast<int>(threadPool.GetNumThreads()) * kNumBandsPerThread;
+        const int numRowsInBand = std::max(
+          kMinNumRowsInBand, (height + maxNumBands - 1) / maxNumBands);
+
+        for (int rowBegin = 0; rowBegin < height; rowBegin += numRowsInBand)
+        {
+            Band band;
+            band.rowBegin = rowBegin;
+            band.rowEnd = std::min(rowBegin + numRowsInBand, height);
+            bands.emplace_back(std::move(band));
+        }
+
+        for (size_t bandIndex = 0; bandIndex < bands.size(); bandIndex++)
+        {
+            threadPool.Push([&, bandIndex](size_t) {
+                Band& band = bands[bandIndex];
+
+                // フィルタは1つ上の行を参照するので、帯の直前の行も作る
+                std::vector<uint8_t> row(rowSize);
+                std::vector<uint8_t> prevRow(rowSize, 0);
+                if (band.rowBegin > 0)
+                {
+                    generateRow(band.rowBegin - 1, prevRow.data());
+                }
+
+                std::array<std::vector<uint8_t>, kNumFilterTypes> candidates;
+                std::vector<uint8_t> filtered(
+                  (rowSize + 1) * (band.rowEnd - band.rowBegin));
+                for (int y = band.rowBegin; y < band.rowEnd; y++)
+                {
+                    generateRow(y, row.data());
+                    FilterRow(row.data(),
+                              prevRow.data(),
+                              rowSize,
+                              &candidates,
+                              &filtered[(y - band.rowBegin) * (rowSize + 1)]);
+                    std::swap(row, prevRow);
+                }
+
+                band.chunk = BeginChunk("IDAT");
+                if (bandIndex == 0)
+                {
+                    WriteZlibHeader(&band.chunk);
+                }
+                CompressDeflate(
+                  filtered.data(), filtered.size(), false, &band.chunk);
+
+                band.adler = CalcAdler32(filtered.data(), filtered.size());
+                band.filteredSize = filtered.size();
+            });
+        }
+    }
+
+    // ---- 書き出し ----
+    constexpr std::array<uint8_t, 8> kSignature = { 0x89, 'P',  'N',  'G',
+                                                    '\r', '\n', 0x1A, '\n' };
+    ofs.write(reinterpret_cast<const char*>(kSignature.data()),
+              kSignature.size());
+
+    {
+        std::vector<uint8_t> ihdr = BeginChunk("IHDR");
+        AppendUInt32(width, &ihdr);
+        AppendUInt32(height, &ihdr);
+        ihdr.insert(ihdr.end(),
+                    {
+                      8, // ビット深度
+                      2, // RGB
+                      0, // Deflate
+                      0, // 適応フィルタ
+                      0  // インターレースなし
+                    });
+        WriteChunk(ofs, ihdr);
+    }
+
+    uint32_t adler = 1;
+    for (const Band& band : bands)
+    {
+        WriteChunk(ofs, band.chunk);
+        adler = CombineAdler32(adler, band.adler, band.filteredSize);
+    }
+
+    {
+        // 空の最終ブロックと Adler-32 で zlib のストリームを終える
+        std::vector<uint8_t> idat = BeginChunk("IDAT");
+        CompressDeflate(nullptr, 0, true, &idat);
+        AppendUInt32(adler, &idat);
+        WriteChunk(ofs, idat);
+    }
+
+    WriteChunk(ofs, BeginChunk("IEND"));
+
+    if (!ofs)
+    {
+        Logger::Error("Could not write file. [{}]", path.string());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Core
+} // namespace Petrichor
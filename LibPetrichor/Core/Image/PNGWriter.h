@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! PNGの1行分の画素値(8bitのRGB)を作る関数
+//! 複数のスレッドから異なる行について同時に呼ばれる
+//! @param y 行番号
+//! @param rgb width * 3 バイトの書き込み先
+using PNGRowGenerator = std::function<void(int y, uint8_t* rgb)>;
+
+//! 8bitのRGB画像をPNGで書き出す
+//! 行の生成(トーンマッピング等)、フィルタ、圧縮を行の帯ごとに並列に行い、
+//! 帯ごとに IDAT チャンクにする。画像全体の8bitの画素値は保持しない
+//! @param numThreads 0 の場合はハードウェアのスレッド数
+//! @return 書き出しに成功したか
+bool
+WritePNG(const std::filesystem::path& path,
+         int width,
+         int height,
+         const PNGRowGenerator& generateRow,
+         uint32_t numThreads = 0);
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,134 @@
+#include "ToneMapping.h"
+
+#include "Core/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+constexpr float kColorDepth8Bit = 255.0f;
+
+float
+ACESFilm(float x)
+{
+    float a = 2.51f;
+    float b = 0.03f;
+    float c = 2.43f;
+    float d = 0.59f;
+    float e = 0.14f;
+    return (x * (a * x + b)) / (x * (c * x + d) + e);
+}
+
+float
+ApplyGamma(float value, float gamma = 2.2f)
+{
+    return std::pow(value, gamma);
+}
+
+//! RTCamp7 のトーンカーブ
+//! チャンネルごとに指数が異なるので、チャンネル番号を受け取る
+float
+RTCamp7Tonemap(float value, int channel)
+{
+    constexpr float kGammas[3] = { 1.0f, 1.3f, 1.6f };
+
+    const float x0 = ApplyGamma(0.05f);
+    const float x1 = ApplyGamma(0.9f);
+    value = (ApplyGamma(value, 1.2f) - x0) / (x1 - x0);
+
+    // 負の値は pow で NaN になり、結果的に 0 に量子化されていたので
+    // 先に 0 にしておく
+    value = std::max(value, 0.0f);
+    return channel == 0 ? value : ApplyGamma(value, kGammas[channel]);
+}
+
+float
+ApplyDegamma(float value)
+{
+    value = std::pow(value, 1.1f);
+    value = std::clamp(value, 0.0f, 1.0f);
+    return std::pow(value, 1 / 2.2f);
+}
+
+//! ACESFilm 適用後の値を8bitに変換する
+uint8_t
+ApplyToneCurve(float aces, int channel)
+{
+    if (!(aces > 0.0f))
+    {
+        return 0;
+    }
+
+    const float degamma = ApplyDegamma(RTCamp7Tonemap(aces, channel));
+    return static_cast<uint8_t>((kColorDepth8Bit - kEps) * degamma);
+}
+
+} // namespace
+
+ToneMapper::ToneMapper()
+{
+    for (int channel = 0; channel < 3; channel++)
+    {
+        for (size_t i = 0; i < kTableSize; i++)
+        {
+            // 区間の中央の値で代表させる
+            const float aces = (i + 0.5f) * (kMaxACESFilm / kTableSize);
+            m_tables[channel][i] = ApplyToneCurve(aces, channel);
+        }
+    }
+}
+
+void
+ToneMapper::Apply(const Color3f* pixels,
+                  size_t numPixels,
+                  uint8_t* outRGB) const
+{
+    // ACESFilm は Color3f の演算で行う(PETRICHOR_USE_SIMD 時はSSE)
+    const Color3f a = 2.51f * Color3f::One();
+    const Color3f b = 0.03f * Color3f::One();
+    const Color3f c = 2.43f * Color3f::One();
+    const Color3f d = 0.59f * Color3f::One();
+    const Color3f e = 0.14f * Color3f::One();
+
+    constexpr float kScale = kTableSize / kMaxACESFilm;
+    constexpr float kMaxIndex = kTableSize - 1;
+
+    for (size_t pixelIndex = 0; pixelIndex < numPixels; pixelIndex++)
+    {
+        const Color3f& x = pixels[pixelIndex];
+        const Color3f aces = (x * (a * x + b)) / (x * (c * x + d) + e);
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            // NaN と負の値は先頭の要素(黒)を引く
+            const float t = aces[channel] * kScale;
+            const float index = t > 0.0f ? std::min(t, kMaxIndex) : 0.0f;
+            outRGB[3 * pixelIndex + channel] =
+              m_tables[channel][static_cast<size_t>(index)];
+        }
+    }
+}
+
+std::array<uint8_t, 3>
+ToneMapper::ApplyReference(const Color3f& pixel)
+{
+    return { ApplyToneCurve(ACESFilm(pixel.x), 0),
+             ApplyToneCurve(ACESFilm(pixel.y), 1),
+             ApplyToneCurve(ACESFilm(pixel.z), 2) };
+}
+
+const ToneMapper&
+ToneMapper::GetInstance()
+{
+    static const ToneMapper toneMapper;
+    return toneMapper;
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core/Color3f.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! レンダリング結果を8bitのRGBに変換するトーンマッピング
+//! ACESFilm の後段(RTCamp7のトーンカーブとデガンマ)はチャンネルごとの
+//! 1変数関数なので、ACESFilm の出力で引くテーブルにして画素ごとの pow をなくす
+class ToneMapper
+{
+public:
+    //! テーブルを構築する
+    ToneMapper();
+
+    //! 画素列を変換する
+    //! @param outRGB numPixels * 3 バイトの書き込み先
+    void
+    Apply(const Color3f* pixels, size_t numPixels, uint8_t* outRGB) const;
+
+    //! 変換を1画素だけテーブルを使わずに計算する(テーブルの検証用)
+    static std::array<uint8_t, 3>
+    ApplyReference(const Color3f& pixel);
+
+    //! 共有のインスタンスを取得する
+    static const ToneMapper&
+    GetInstance();
+
+private:
+    //! テーブルの要素数(チャンネルごと)
+    static constexpr size_t kTableSize = 1 << 14;
+
+    //! ACESFilm の出力の上限
+    static constexpr float kMaxACESFilm = 2.51f / 2.43f;
+
+    std::array<std::array<uint8_t, kTableSize>, 3> m_tables;
+};
+
+} // namespace Core
+} // namespace Petrichor
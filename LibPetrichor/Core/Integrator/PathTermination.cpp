@@ -0,0 +1,88 @@
+#include "PathTermination.h"
+
+#include "Core/Assert.h"
+#include <algorithm>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+PathTermination::PathTermination(const RenderSetting& renderSetting)
+  : m_maxBounces(renderSetting.numMaxBounces)
+  , m_maxDiffuseBounces(renderSetting.numMaxDiffuseBounces)
+  , m_maxGlossyBounces(renderSetting.numMaxGlossyBounces)
+  , m_maxTransmissionBounces(renderSetting.numMaxTransmissionBounces)
+  , m_startBounce(renderSetting.russianRouletteStartBounce)
+  , m_minProbability(
+      std::clamp(renderSetting.russianRouletteMinProbability, 0.0f, 1.0f))
+{
+}
+
+bool
+PathTermination::Continue(Ray* ray,
+                          BounceCounts* bounceCounts,
+                          float randomValue) const
+{
+    ASSERT(ray && bounceCounts);
+
+    if (ray->bounce > m_maxBounces)
+    {
+        return false;
+    }
+
+    switch (ray->rayType)
+    {
+    case RayTypes::Diffuse:
+        if (++bounceCounts->diffuse > m_maxDiffuseBounces)
+        {
+            return false;
+        }
+        break;
+
+    case RayTypes::Glossy:
+        if (++bounceCounts->glossy > m_maxGlossyBounces)
+        {
+            return false;
+        }
+        break;
+
+    case RayTypes::Translucent:
+    case RayTypes::Refract:
+        if (++bounceCounts->transmission > m_maxTransmissionBounces)
+        {
+            return false;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // 寄与が無いパスは追跡しても無駄
+    const float maxThroughput = ray->throughput.MaxElem();
+    if (maxThroughput <= 0.0f)
+    {
+        return false;
+    }
+
+    if (ray->bounce < m_startBounce)
+    {
+        return true;
+    }
+
+    // スループットが小さい(暗い)パスほど打ち切られやすくする
+    const float survivalProb =
+      std::clamp(maxThroughput, m_minProbability, 1.0f);
+    if (randomValue >= survivalProb)
+    {
+        return false;
+    }
+
+    ray->throughput /= survivalProb;
+    ray->prob = survivalProb;
+    return true;
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Core/Ray.h"
+#include "Core/RenderSetting.h"
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! パスの種類ごとの反射回数
+struct BounceCounts
+{
+    int diffuse = 0;      //!< 拡散反射
+    int glossy = 0;       //!< 鏡面反射
+    int transmission = 0; //!< 透過・屈折
+};
+
+//! パスを打ち切るかどうかの判定
+//! 全体と種類ごとの最大反射回数、スループットに基づくロシアンルーレットを
+//! 各インテグレータで共通に扱う
+class PathTermination
+{
+public:
+    explicit PathTermination(const RenderSetting& renderSetting);
+
+    //! マテリアルで生成した次のレイを追跡し続けるかを判定する
+    //! 追跡する場合、ロシアンルーレットの生存確率でスループットを補正する
+    //! @param ray 次のレイ
+    //! @param bounceCounts パスの種類ごとの反射回数(ray の種類で加算する)
+    //! @param randomValue [0, 1) の乱数
+    //! @return 追跡を続ける場合は true
+    bool
+    Continue(Ray* ray, BounceCounts* bounceCounts, float randomValue) const;
+
+private:
+    int m_maxBounces = 0;
+    int m_maxDiffuseBounces = 0;
+    int m_maxGlossyBounces = 0;
+    int m_maxTransmissionBounces = 0;
+
+    int m_startBounce = 0;        //!< ロシアンルーレットを始める反射回数
+    float m_minProbability = 0.0f; //!< ロシアンルーレットの最小生存確率
+};
+
+} // namespace Core
+} // namespace Petrichor
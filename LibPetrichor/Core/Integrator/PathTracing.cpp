@@ -2,6 +2,7 @@
 
 #include "Core/Accel/BruteForce.h"
 #include "Core/HitInfo.h"
+#include "Core/Integrator/PathTermination.h"
 #include "Core/Material/Emission.h"
 #include "Core/Sampler/MicroJitteredSampler.h"
 #include "Core/Scene.h"
@@ -23,8 +24,7 @@ PathTracing::Render(uint32_t pixelX,
                     const Scene& scene,
                     const AccelBase& accel,
                     Texture2D* targetTex,
-                    ISampler1D& sampler1D,
-                    ISampler2D& sampler2D)
+                    RenderContext& context)
 {
     const auto* const mainCamera = scene.GetMainCamera();
     if (mainCamera == nullptr)
@@ -34,20 +34,26 @@ PathTracing::Render(uint32_t pixelX,
     }
 
     const uint32_t numSamples = scene.GetRenderSetting().numSamplesPerPixel;
+    const PathTermination pathTermination(scene.GetRenderSetting());
+
+    RandomSampler1D& sampler1D = context.GetSampler1D();
+    RandomSampler2D& sampler2D = context.GetSampler2D();
+
     Color3f pixelColorSum;
     for (uint32_t spp = 0; spp < numSamples; spp++)
     {
+        context.BeginSample(pixelX, pixelY, spp);
+
         Color3f color;
         Ray ray = mainCamera->GenerateRay(pixelX,
                                           pixelY,
                                           targetTex->GetWidth(),
                                           targetTex->GetHeight(),
                                           sampler2D);
-        Ray prevRay = ray;
 
         ShadingInfo shadingInfo;
         {
-            const auto hitInfo = accel.Intersect(ray, scene);
+            const auto hitInfo = accel.Intersect(ray, scene, context);
             if (hitInfo == std::nullopt)
             {
                 // IBL
@@ -69,26 +75,38 @@ PathTracing::Render(uint32_t pixelX,
         }
 
         // ---- 光源以外のオブジェクトにヒットした場合 ----
-        const int maxNumBounces = scene.GetRenderSetting().numMaxBounces;
-        for (int bounce = 0; bounce < maxNumBounces; bounce++)
+        BounceCounts bounceCounts;
+        for (;;)
         {
+            // 法線やテクスチャの参照はこの衝突点で1度だけ行う
+            mat = shadingInfo.material;
+            const BSDFContext bsdfContext =
+              mat->CreateBSDFContext(ray, shadingInfo);
+
             // ---- ライトをサンプリング ----
-            color += CalcLightContribution(
-              scene, accel, shadingInfo, sampler1D, sampler2D, ray);
+            color += CalcLightContribution(scene,
+                                           accel,
+                                           shadingInfo,
+                                           bsdfContext,
+                                           context,
+                                           ray);
 
             // 次のレイを生成
-            prevRay = ray;
-            mat = shadingInfo.material;
-            ray = mat->CreateNextRay(ray, shadingInfo, sampler2D);
+            const BSDFSample bsdfSample =
+              mat->Sample(bsdfContext, ray, sampler2D);
+            ray = bsdfSample.ray;
+            const float pdfBSDF = bsdfSample.pdf;
             ASSERT(ray.throughput.MinElem() >= 0.0f);
+            context.GetRayStatistics().numBounces++;
 
-            if (Math::ApproxEq(ray.throughput.SquaredLength(), 0.0f, kEps))
+            if (!pathTermination.Continue(
+                  &ray, &bounceCounts, sampler1D.Next()))
             {
                 break;
             }
 
             // MIS
-            if (const auto hitInfoNext = accel.Intersect(ray, scene);
+            if (const auto hitInfoNext = accel.Intersect(ray, scene, context);
                 hitInfoNext)
             {
                 const ShadingInfo shadingInfoNext =
@@ -97,7 +115,6 @@ PathTracing::Render(uint32_t pixelX,
                 if (shadingInfoNext.material->GetMaterialType() ==
                     MaterialTypes::Emission)
                 {
-                    float pdfArea = 0.0f;
                     float misWeight = 1.0f;
 
                     const float l2 =
@@ -105,17 +122,11 @@ PathTracing::Render(uint32_t pixelX,
                     const float cosP =
                       std::abs(Math::Dot(ray.dir, shadingInfoNext.normal));
 
-                    // TODO:
-                    // 下の関数が確率密度関数を取得しているだけなのに無駄
-                    PointData pointData;
-                    SampleLight(scene,
-                                ray.o,
-                                sampler1D.Next(),
-                                sampler2D,
-                                &pdfArea,
-                                nullptr);
-
-                    const float pdfBSDF = mat->PDF(prevRay, ray, shadingInfo);
+                    // ライトサンプリングでこの点が選ばれる確率密度
+                    const float pdfArea =
+                      CalcLightSelectionPDF(scene, true) *
+                      hitInfoNext->hitObj->PDFArea(ray.o, shadingInfoNext.pos);
+
                     const float pdfLight = l2 / cosP * pdfArea;
 #ifdef BALANCE_HEURISTIC
                     misWeight = pdfBSDF / (pdfLight + pdfBSDF);
@@ -148,12 +159,12 @@ PathTracing::Render(uint32_t pixelX,
                       std::abs(Math::Dot(shadingInfo.normal, ray.dir));
                     const float sin = sqrt(std::max(0.0f, 1.0f - cos * cos));
 
-                    const float pdfBSDF = mat->PDF(prevRay, ray, shadingInfo);
                     float pdfEnv = 0.0f;
                     float misWeight = 0.0;
                     if (ray.dir.x != 0 && ray.dir.y != 0 && sin > 0)
                     {
                         pdfEnv =
+                          CalcLightSelectionPDF(scene, true) *
                           scene.GetEnvironment().GetImportanceSamplingPDF(
                             ray.dir) /
                           (2.0f * Math::kPi * Math::kPi * sin);
@@ -203,10 +214,13 @@ Petrichor::Color3f
 PathTracing::CalcLightContribution(const Scene& scene,
                                    const AccelBase& accel,
                                    const ShadingInfo& shadingInfo,
-                                   ISampler1D& sampler1D,
-                                   ISampler2D& sampler2D,
+                                   const BSDFContext& bsdfContext,
+                                   RenderContext& context,
                                    const Ray& ray)
 {
+    RandomSampler1D& sampler1D = context.GetSampler1D();
+    RandomSampler2D& sampler2D = context.GetSampler2D();
+
     Color3f lightContribution;
 
     const float dot = -Math::Dot(ray.dir, shadingInfo.normal);
@@ -229,7 +243,7 @@ PathTracing::CalcLightContribution(const Scene& scene,
         Ray rayToLight(
           p, (pointOnLight.pos - p).Normalized(), RayTypes::Shadow);
 
-        const auto hitInfoLight = accel.Intersect(rayToLight, scene);
+        const auto hitInfoLight = accel.Intersect(rayToLight, scene, context);
         if (hitInfoLight && hitInfoLight->hitObj->GetMaterial(sampler1D.Next())
                                 ->GetMaterialType() == MaterialTypes::Emission)
         {
@@ -249,12 +263,14 @@ PathTracing::CalcLightContribution(const Scene& scene,
                 const float cosP =
                   std::abs(Dot(rayToLight.dir, shadingInfoLight.normal));
 
+                const BSDFEval bsdfEval =
+                  mat->Evaluate(bsdfContext, ray, rayToLight.dir);
+
                 float misWeight = 0.0f;
                 if (l2 > 0.0f)
                 {
                     const float pdfLight = pdfArea;
-                    const float pdfBSDF =
-                      mat->PDF(ray, rayToLight, shadingInfo) * cosP / l2;
+                    const float pdfBSDF = bsdfEval.pdf * cosP / l2;
 #ifdef BALANCE_HEURISTIC
                     misWeight = pdfLight / (pdfLight + pdfBSDF);
 #else
@@ -266,7 +282,7 @@ PathTracing::CalcLightContribution(const Scene& scene,
                 const auto matEmission =
                   static_cast<const Emission*>(shadingInfoLight.material);
                 const Color3f li = matEmission->GetLightColor();
-                const Color3f f = mat->BxDF(ray, rayToLight, shadingInfo);
+                const Color3f& f = bsdfEval.value;
                 auto cos =
                   std::abs(Math::Dot(rayToLight.dir, shadingInfo.normal));
 
@@ -285,12 +301,16 @@ PathTracing::CalcLightContribution(const Scene& scene,
         Math::Vector3f sampledDir =
           scene.GetEnvironment().ImportanceSampling(sampler2D, &pdfuv);
 
+        // 環境マップを選んだ確率も含める
+        pdfuv *= CalcLightSelectionPDF(scene, true);
+
         const Math::Vector3f rayOrigin =
           shadingInfo.pos +
           kEps * std::copysign(1.0f, dot) * shadingInfo.normal;
 
         Ray rayToEnv(rayOrigin, sampledDir, RayTypes::Shadow);
-        const std::optional<HitInfo> hitInfo = accel.Intersect(rayToEnv, scene);
+        const std::optional<HitInfo> hitInfo =
+          accel.Intersect(rayToEnv, scene, context);
 
         // 物体に遮られず、環境マップが見えた場合
         if (hitInfo == std::nullopt)
@@ -299,9 +319,11 @@ PathTracing::CalcLightContribution(const Scene& scene,
               std::abs(Math::Dot(rayToEnv.dir, shadingInfo.normal));
             const float sin = sqrt(std::max(0.0f, 1.0f - cos * cos));
             const MaterialBase* const mat = shadingInfo.material;
+            const BSDFEval bsdfEval =
+              mat->Evaluate(bsdfContext, ray, rayToEnv.dir);
 
-            const float pdfBSDF = 2.0f * Math::kPi * Math::kPi * sin *
-                                  mat->PDF(ray, rayToEnv, shadingInfo);
+            const float pdfBSDF =
+              2.0f * Math::kPi * Math::kPi * sin * bsdfEval.pdf;
 
 #ifdef BALANCE_HEURISTIC
             float misWeight = pdfuv / (pdfuv + pdfBSDF);
@@ -311,7 +333,7 @@ PathTracing::CalcLightContribution(const Scene& scene,
 #endif
 
             const Color3f li = scene.GetEnvironment().GetColor(rayToEnv.dir);
-            const Color3f f = mat->BxDF(ray, rayToEnv, shadingInfo);
+            const Color3f& f = bsdfEval.value;
 
             const Color3f contribution =
               misWeight * ray.throughput *
@@ -336,54 +358,50 @@ PathTracing::SampleLight(const Scene& scene,
 {
     const auto& lights = scene.GetLights();
 
-    int index = 0;
-    if (sampleEnvMap == nullptr)
+    // ライト(と環境マップ)から一様に1つ選ぶ
+    const size_t numCandidates = lights.size() + (sampleEnvMap ? 1 : 0);
+    if (numCandidates == 0)
     {
-        index = static_cast<int>(randomVal * lights.size());
-        index = std::min(index, static_cast<int>(lights.size() - 1));
-
-        if (sampleEnvMap)
+        if (pdfArea)
         {
-            *sampleEnvMap = false;
+            *pdfArea = 0.0f;
         }
+        return PointData{};
     }
-    else
-    {
-        index = static_cast<int>(randomVal * (lights.size() + 1));
-        index = std::min(index, static_cast<int>(lights.size()));
-        ASSERT(index < lights.size() + 1);
 
-        if (index >= lights.size())
+    const size_t index = std::min(
+      static_cast<size_t>(randomVal * numCandidates), numCandidates - 1);
+
+    if (sampleEnvMap)
+    {
+        *sampleEnvMap = (index >= lights.size());
+        if (*sampleEnvMap)
         {
-            *sampleEnvMap = true;
             return PointData{};
         }
     }
 
-    float sumArea = 0.0f;
-
     PointData result;
-    for (size_t i = 0; i < lights.size(); i++)
-    {
-        float pdfAreaEach = 0.0f;
-        PointData pointOnSurface;
-        lights[i]->SampleSurface(
-          shadowRayOrigin, sampler2D, &pointOnSurface, &pdfAreaEach);
-        sumArea += 1.0f / pdfAreaEach;
-
-        if (i == index)
-        {
-            result = pointOnSurface;
-        }
-    }
+    float pdfAreaLight = 0.0f;
+    lights[index]->SampleSurface(
+      shadowRayOrigin, sampler2D, &result, &pdfAreaLight);
 
     if (pdfArea)
     {
-        *pdfArea = 1.0f / sumArea;
+        *pdfArea =
+          CalcLightSelectionPDF(scene, sampleEnvMap != nullptr) * pdfAreaLight;
     }
 
     return result;
 }
 
+float
+PathTracing::CalcLightSelectionPDF(const Scene& scene, bool includeEnvMap)
+{
+    const size_t numCandidates =
+      scene.GetLights().size() + (includeEnvMap ? 1 : 0);
+    return numCandidates > 0 ? 1.0f / numCandidates : 0.0f;
+}
+
 } // namespace Core
 } // namespace Petrichor
@@ -2,7 +2,7 @@
 
 #include "Core/Accel/AccelBase.h"
 #include "Core/Geometry/GeometryBase.h"
-#include "Core/Sampler/ISampler1D.h"
+#include "Core/RenderContext.h"
 #include "Core/Sampler/ISampler2D.h"
 
 namespace Petrichor
@@ -27,21 +27,21 @@ public:
            const Scene& scene,
            const AccelBase& accel,
            Texture2D* targetTex,
-           ISampler1D& sampler1D,
-           ISampler2D& sampler2D);
+           RenderContext& context);
 
     Color3f
     CalcLightContribution(const Scene& scene,
                           const AccelBase& accel,
                           const ShadingInfo& shadingInfo,
-                          ISampler1D& sampler1D,
-                          ISampler2D& sampler2D,
+                          const BSDFContext& bsdfContext,
+                          RenderContext& context,
                           const Ray& ray);
 
 private:
     // ランダムにライト上をサンプリング
     //! @param envMapSampling
     //! trueの場合はライトをサンプリングするのではなく、環境マップを直接サンプリングしにいく
+    //! @param pdfArea 選んだライトの確率も含めた確率密度(面積測度)
     PointData
     SampleLight(const Scene& scene,
                 const Math::Vector3f& shadowRayOrigin,
@@ -49,6 +49,11 @@ private:
                 ISampler2D& sampler2D,
                 float* pdfArea,
                 bool* sampleEnvMap);
+
+    //! SampleLight() で各ライト(または環境マップ)が選ばれる確率
+    //! @param includeEnvMap 環境マップも選択肢に含める場合は true
+    static float
+    CalcLightSelectionPDF(const Scene& scene, bool includeEnvMap);
 };
 } // namespace Core
 } // namespace Petrichor
@@ -0,0 +1,66 @@
+#include "RaySorter.h"
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+//! 1軸あたりの量子化ビット数
+constexpr int kNumBitsPerAxis = 10;
+constexpr uint32_t kQuantizeMax = (1u << kNumBitsPerAxis) - 1;
+
+//! 10bitの値を3bitおきに広げる
+uint32_t
+ExpandBits(uint32_t v)
+{
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+//! [0, 1] の値を量子化する
+uint32_t
+Quantize(float t)
+{
+    const float clamped = std::clamp(t, 0.0f, 1.0f);
+    return static_cast<uint32_t>(clamped * kQuantizeMax);
+}
+
+//! [0, 1]^3 の点の30bitモートンコード
+uint32_t
+CalcMortonCode(const Math::Vector3f& p)
+{
+    return (ExpandBits(Quantize(p.x)) << 2) |
+           (ExpandBits(Quantize(p.y)) << 1) | ExpandBits(Quantize(p.z));
+}
+
+} // namespace
+
+uint64_t
+RaySorter::CalcSortKey(const Ray& ray, const AABB& originBound)
+{
+    // 方向の符号が同じレイはBVHを同じ順序で辿る
+    const uint64_t octant = (ray.dir.x < 0.0f ? 4 : 0) |
+                            (ray.dir.y < 0.0f ? 2 : 0) |
+                            (ray.dir.z < 0.0f ? 1 : 0);
+
+    const Math::Vector3f extent = originBound.upper - originBound.lower;
+    const Math::Vector3f originNormalized(
+      extent.x > 0.0f ? (ray.o.x - originBound.lower.x) / extent.x : 0.0f,
+      extent.y > 0.0f ? (ray.o.y - originBound.lower.y) / extent.y : 0.0f,
+      extent.z > 0.0f ? (ray.o.z - originBound.lower.z) / extent.z : 0.0f);
+    const uint64_t originCode = CalcMortonCode(originNormalized);
+
+    const uint64_t dirCode =
+      CalcMortonCode(0.5f * (ray.dir + Math::Vector3f::One()));
+
+    return (octant << 60) | (originCode << 30) | dirCode;
+}
+
+} // namespace Core
+} // namespace Petrichor
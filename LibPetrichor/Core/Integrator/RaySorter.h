@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core/Accel/AABB.h"
+#include "Core/Ray.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! 交差判定の前にレイを並べ替えて、BVHのメモリアクセスを局所化する
+//! 方向の八分円(符号)ごとにまとめ、その中を原点と方向のモートンコード順に並べる
+class RaySorter
+{
+public:
+    //! ソートキーを求める
+    //! 上位から [八分円 3bit][原点のモートンコード 30bit][方向 30bit]
+    //! @param originBound 原点の量子化に用いる範囲
+    static uint64_t
+    CalcSortKey(const Ray& ray, const AABB& originBound);
+
+    //! items を getRay(item) で得られるレイのソートキー順に並べ替える
+    //! 要素ごと並べ替えるので、結果は要素が持つ情報(画素番号など)で書き戻す
+    //! @param scratch 作業用の配列(内容は破棄される)
+    template<typename T, typename GetRay>
+    void
+    Sort(std::vector<T>* items, std::vector<T>* scratch, GetRay getRay);
+
+    //! numItems 個までの並べ替えで確保が起きないよう作業領域を確保しておく
+    void
+    Reserve(size_t numItems)
+    {
+        m_keys.reserve(numItems);
+    }
+
+private:
+    std::vector<std::pair<uint64_t, uint32_t>> m_keys; //!< (キー, 元の番号)
+};
+
+#pragma region Inline functions
+
+template<typename T, typename GetRay>
+void
+RaySorter::Sort(std::vector<T>* items, std::vector<T>* scratch, GetRay getRay)
+{
+    ASSERT(items && scratch);
+
+    AABB originBound;
+    for (const T& item : *items)
+    {
+        originBound.Merge(getRay(item).o);
+    }
+
+    m_keys.clear();
+    m_keys.reserve(items->size());
+    for (size_t i = 0; i < items->size(); i++)
+    {
+        m_keys.emplace_back(CalcSortKey(getRay((*items)[i]), originBound),
+                            static_cast<uint32_t>(i));
+    }
+
+    std::sort(m_keys.begin(), m_keys.end());
+
+    scratch->clear();
+    scratch->reserve(items->size());
+    for (const auto& [key, index] : m_keys)
+    {
+        scratch->emplace_back(std::move((*items)[index]));
+    }
+    items->swap(*scratch);
+}
+
+#pragma endregion
+
+} // namespace Core
+} // namespace Petrichor
@@ -1,7 +1,8 @@
 #include "SimplePathTracing.h"
 
 #include "Core/HitInfo.h"
-#include "Core/Material/Emission.h"
+#include "Core/Integrator/PathTermination.h"
+#include "Core/Memory/AllocationCounter.h"
 #include "Core/Sampler/MicroJitteredSampler.h"
 #include "Core/Scene.h"
 #include <Random/XorShift.h>
@@ -19,8 +20,8 @@ SimplePathTracing::Render(uint32_t pixelX,
                           const Scene& scene,
                           const AccelBase& accel,
                           Texture2D* targetTex,
-                          ISampler1D& sampler1D,
-                          ISampler2D& sampler2D)
+                          int numSamples,
+                          RenderContext& context)
 {
     const auto* const mainCamera = scene.GetMainCamera();
     if (mainCamera == nullptr)
@@ -29,12 +30,21 @@ SimplePathTracing::Render(uint32_t pixelX,
         return;
     }
 
-    const int numSamples = scene.GetRenderSetting().numSamplesPerPixel;
-    const int maxNumBounces = scene.GetRenderSetting().numMaxBounces;
+    const PathTermination pathTermination(scene.GetRenderSetting());
+    const MaterialTable& materialTable = scene.GetMaterialTable();
+
+    RandomSampler1D& sampler1D = context.GetSampler1D();
+    RandomSampler2D& sampler2D = context.GetSampler2D();
+    RayStatistics& rayStatistics = context.GetRayStatistics();
 
     Color3f sumContribution;
     for (int spp = 0; spp < numSamples; spp++)
     {
+        // サンプルごとの処理ではヒープを確保しない
+        const ScopedNoAllocationCheck noAllocationCheck;
+
+        context.BeginSample(pixelX, pixelY, spp);
+
         auto ray = mainCamera->GenerateRay(pixelX,
                                            pixelY,
                                            targetTex->GetWidth(),
@@ -42,9 +52,11 @@ SimplePathTracing::Render(uint32_t pixelX,
                                            sampler2D);
 
         Color3f contribution;
+        BounceCounts bounceCounts;
         for (int bounce = 0;; bounce++)
         {
-            const auto hitInfo = accel.Intersect(ray, scene, kEps);
+            const auto hitInfo =
+              accel.Intersect(ray, scene, kEps, kInfinity, context);
 
             // ヒットしなかった場合
             if (!hitInfo)
@@ -56,12 +68,13 @@ SimplePathTracing::Render(uint32_t pixelX,
             }
 
             // ---- ヒットした場合 ----
-            const MaterialBase* const mat =
-              (hitInfo->hitObj)->GetMaterial(sampler1D.Next());
-            if (mat->GetMaterialType() == MaterialTypes::Emission)
+            const MaterialId materialId = materialTable.Resolve(
+              scene.GetMaterialId(*hitInfo), sampler1D.Next());
+            if (materialTable.GetMaterialType(materialId) ==
+                MaterialTypes::Emission)
             {
-                auto matEmission = static_cast<const Emission*>(mat);
-                contribution += ray.throughput * matEmission->GetLightColor();
+                contribution +=
+                  ray.throughput * materialTable.GetLightColor(materialId);
                 break;
             }
 
@@ -72,22 +85,17 @@ SimplePathTracing::Render(uint32_t pixelX,
 
             const auto shadingInfo =
               (*hitInfo->hitObj).Interpolate(ray, *hitInfo);
-            ray = mat->CreateNextRay(ray, shadingInfo, sampler2D);
+            const BSDFContext bsdfContext =
+              materialTable.CreateBSDFContext(materialId, ray, shadingInfo);
+            const BSDFSample bsdfSample =
+              materialTable.Sample(materialId, bsdfContext, ray, sampler2D);
+            ray = bsdfSample.ray;
+            rayStatistics.numBounces++;
 
-            // 最大反射回数以上でロシアンルーレット
-            if (ray.bounce > maxNumBounces)
+            if (!pathTermination.Continue(
+                  &ray, &bounceCounts, sampler1D.Next()))
             {
-                // #TODO: 大雑把なので条件を考える
-                ray.prob *= 0.9f;
-                ray.prob = std::max(0.1f, ray.prob);
-                if (sampler1D.Next() < ray.prob)
-                {
-                    ray.throughput /= ray.prob;
-                }
-                else
-                {
-                    break;
-                }
+                break;
             }
         }
 
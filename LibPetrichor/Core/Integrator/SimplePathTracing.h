@@ -2,8 +2,7 @@
 
 #include "Core/Accel/AccelBase.h"
 #include "Core/Geometry/GeometryBase.h"
-#include "Core/Sampler/ISampler1D.h"
-#include "Core/Sampler/ISampler2D.h"
+#include "Core/RenderContext.h"
 
 namespace Petrichor
 {
@@ -11,7 +10,6 @@ namespace Core
 {
 
 struct HitInfo;
-class ISampler2D;
 struct Ray;
 class Scene;
 class Texture2D;
@@ -21,14 +19,17 @@ class SimplePathTracing
 public:
     SimplePathTracing() = default;
 
+    //! 画素をレンダリングする
+    //! @param numSamples サンプル数(平均を targetTex に書き込む)
+    //! @param context 呼び出し元スレッドの作業領域(乱数もここから引く)
     void
     Render(uint32_t pixelX,
            uint32_t pixelY,
            const Scene& scene,
            const AccelBase& accel,
            Texture2D* targetTex,
-           ISampler1D& sampler1D,
-           ISampler2D& sampler2D);
+           int numSamples,
+           RenderContext& context);
 };
 } // namespace Core
 } // namespace Petrichor
@@ -0,0 +1,305 @@
+#include "WavefrontPathTracing.h"
+
+#include "Core/AOV/AOVTraversalCost.h"
+#include "Core/Memory/AllocationCounter.h"
+#include "Core/Scene.h"
+#include "Core/Texture2D.h"
+#include "Profiler/Profiler.h"
+#include "Profiler/RayStatistics.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+void
+WavefrontPathTracing::Render(const TileManager::Tile& tile,
+                             const Scene& scene,
+                             const AccelBase& accel,
+                             Texture2D* targetTex,
+                             int numSamples,
+                             RenderContext& context,
+                             Texture2D* traversalCostTex)
+{
+    if (scene.GetMainCamera() == nullptr)
+    {
+        std::cerr << "[Error] Main camera is not found." << std::endl;
+        return;
+    }
+
+    const bool sortRays = scene.GetRenderSetting().sortRays;
+    const size_t numPixels = static_cast<size_t>(tile.width) * tile.height;
+    if (numPixels == 0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    m_pixelContributions.assign(numPixels, Color3f::Zero());
+    if (traversalCostTex)
+    {
+        m_pixelTraversalCosts.assign(numPixels, 0);
+    }
+
+    // パスの数が上限を超えないよう、サンプルを何回かに分けて追跡する
+    const int numSamplesPerWave = static_cast<int>(
+      std::clamp(kMaxNumPaths / numPixels, size_t(1), size_t(numSamples)));
+
+    for (int sampleBegin = 0; sampleBegin < numSamples;
+         sampleBegin += numSamplesPerWave)
+    {
+        const int numSamplesInWave =
+          std::min(numSamplesPerWave, numSamples - sampleBegin);
+        GeneratePaths(
+          tile, scene, *targetTex, sampleBegin, numSamplesInWave, context);
+
+        // カメラレイは生成順のままで十分コヒーレント
+        for (int bounce = 0; !m_paths.empty(); bounce++)
+        {
+            // キューは GeneratePaths() で確保済みなので、ここでは確保しない
+            const ScopedNoAllocationCheck noAllocationCheck;
+
+            if (sortRays && bounce > 0 &&
+                m_paths.size() >= kMinNumPathsToSort)
+            {
+                SortPaths();
+            }
+
+            IntersectPaths(
+              scene, accel, context, traversalCostTex != nullptr);
+            SortHits(scene.GetMaterialTable());
+            ShadeHits(scene, context);
+            std::swap(m_paths, m_nextPaths);
+        }
+
+        // パスの処理順によらないよう、サンプル番号の順に足す
+        for (int spp = 0; spp < numSamplesInWave; spp++)
+        {
+            const Color3f* const contributions =
+              &m_sampleContributions[static_cast<size_t>(spp) * numPixels];
+            for (size_t pixelIndex = 0; pixelIndex < numPixels; pixelIndex++)
+            {
+                m_pixelContributions[pixelIndex] += contributions[pixelIndex];
+            }
+        }
+    }
+
+    for (size_t pixelIndex = 0; pixelIndex < numPixels; pixelIndex++)
+    {
+        const int x = tile.x + static_cast<int>(pixelIndex % tile.width);
+        const int y = tile.y + static_cast<int>(pixelIndex / tile.width);
+
+        const Color3f averagedContribution =
+          m_pixelContributions[pixelIndex] / static_cast<float>(numSamples);
+        targetTex->SetPixel(x, y, averagedContribution);
+
+        if (traversalCostTex)
+        {
+            AOVTraversalCost::Record(x,
+                                     y,
+                                     m_pixelTraversalCosts[pixelIndex],
+                                     numSamples,
+                                     traversalCostTex);
+        }
+    }
+}
+
+void
+WavefrontPathTracing::GeneratePaths(const TileManager::Tile& tile,
+                                    const Scene& scene,
+                                    const Texture2D& targetTex,
+                                    int sampleBegin,
+                                    int numSamples,
+                                    RenderContext& context)
+{
+    PROFILE_SCOPE("Wavefront::Generate");
+
+    const auto* const mainCamera = scene.GetMainCamera();
+    RandomSampler2D& sampler2D = context.GetSampler2D();
+
+    const size_t numPaths =
+      static_cast<size_t>(numSamples) * tile.width * tile.height;
+    m_paths.clear();
+    m_paths.reserve(numPaths);
+    m_sampleContributions.assign(numPaths, Color3f::Zero());
+
+    // バウンスのループ内で確保が起きないよう、他のキューも確保しておく
+    m_nextPaths.reserve(numPaths);
+    m_hits.reserve(numPaths);
+    m_sortedHits.reserve(numPaths);
+    m_raySorter.Reserve(numPaths);
+
+    // 隣り合う画素のレイがキュー内でも隣り合うように、サンプルを外側に回す
+    for (int spp = 0; spp < numSamples; spp++)
+    {
+        uint32_t pixelIndex = 0;
+        for (int y = tile.y; y < tile.y + tile.height; y++)
+        {
+            for (int x = tile.x; x < tile.x + tile.width; x++)
+            {
+                context.BeginSample(x, y, sampleBegin + spp);
+
+                PathState path;
+                path.ray = mainCamera->GenerateRay(x,
+                                                   y,
+                                                   targetTex.GetWidth(),
+                                                   targetTex.GetHeight(),
+                                                   sampler2D);
+                path.samplerState = context.GetSamplerState();
+                path.pixelIndex = pixelIndex;
+                path.sampleSlot = static_cast<uint32_t>(m_paths.size());
+                m_paths.emplace_back(path);
+                pixelIndex++;
+            }
+        }
+    }
+}
+
+void
+WavefrontPathTracing::SortPaths()
+{
+    PROFILE_SCOPE("Wavefront::SortRays");
+
+    // 寄与は画素番号で書き戻すので、パスごと並べ替えてよい
+    m_raySorter.Sort(
+      &m_paths, &m_nextPaths, [](const PathState& path) -> const Ray& {
+          return path.ray;
+      });
+}
+
+void
+WavefrontPathTracing::IntersectPaths(const Scene& scene,
+                                     const AccelBase& accel,
+                                     RenderContext& context,
+                                     bool recordTraversalCost)
+{
+    PROFILE_SCOPE("Wavefront::Intersect");
+
+    RandomSampler1D& sampler1D = context.GetSampler1D();
+    const RayStatistics& rayStatistics = context.GetRayStatistics();
+
+    m_hits.clear();
+    for (uint32_t pathIndex = 0; pathIndex < m_paths.size(); pathIndex++)
+    {
+        PathState& path = m_paths[pathIndex];
+
+        const uint64_t traversalCostBegin = rayStatistics.GetTraversalCost();
+        const auto hitInfo =
+          accel.Intersect(path.ray, scene, kEps, kInfinity, context);
+        if (recordTraversalCost)
+        {
+            m_pixelTraversalCosts[path.pixelIndex] +=
+              rayStatistics.GetTraversalCost() - traversalCostBegin;
+        }
+
+        // ヒットしなかった場合
+        if (!hitInfo)
+        {
+            // IBL
+            m_sampleContributions[path.sampleSlot] +=
+              path.ray.throughput *
+              scene.GetEnvironment().GetColor(path.ray.dir);
+            continue;
+        }
+
+        context.SetSamplerState(path.samplerState);
+
+        HitRecord hit;
+        hit.hitInfo = *hitInfo;
+        hit.materialId = scene.GetMaterialTable().Resolve(
+          scene.GetMaterialId(*hitInfo), sampler1D.Next());
+        hit.pathIndex = pathIndex;
+        path.samplerState = context.GetSamplerState();
+        m_hits.emplace_back(hit);
+    }
+}
+
+void
+WavefrontPathTracing::SortHits(const MaterialTable& materialTable)
+{
+    PROFILE_SCOPE("Wavefront::Sort");
+
+    const auto getKey = [&materialTable](const HitRecord& hit) {
+        return static_cast<size_t>(
+          materialTable.GetMaterialType(hit.materialId));
+    };
+
+    std::array<size_t, kNumMaterialTypes + 1> offsets{};
+    for (const HitRecord& hit : m_hits)
+    {
+        offsets[getKey(hit) + 1]++;
+    }
+
+    for (size_t key = 0; key < kNumMaterialTypes; key++)
+    {
+        offsets[key + 1] += offsets[key];
+    }
+
+    m_sortedHits.resize(m_hits.size());
+    for (const HitRecord& hit : m_hits)
+    {
+        m_sortedHits[offsets[getKey(hit)]++] = hit;
+    }
+}
+
+void
+WavefrontPathTracing::ShadeHits(const Scene& scene, RenderContext& context)
+{
+    PROFILE_SCOPE("Wavefront::Shade");
+
+    RandomSampler1D& sampler1D = context.GetSampler1D();
+    RandomSampler2D& sampler2D = context.GetSampler2D();
+    RayStatistics& rayStatistics = context.GetRayStatistics();
+
+    const PathTermination pathTermination(scene.GetRenderSetting());
+    const MaterialTable& materialTable = scene.GetMaterialTable();
+
+    m_nextPaths.clear();
+    for (const HitRecord& hit : m_sortedHits)
+    {
+        const PathState& path = m_paths[hit.pathIndex];
+        const MaterialId materialId = hit.materialId;
+
+        if (materialTable.GetMaterialType(materialId) ==
+            MaterialTypes::Emission)
+        {
+            m_sampleContributions[path.sampleSlot] +=
+              path.ray.throughput * materialTable.GetLightColor(materialId);
+            continue;
+        }
+
+        context.SetSamplerState(path.samplerState);
+
+        // 次のレイを生成
+        const auto shadingInfo =
+          hit.hitInfo.hitObj->Interpolate(path.ray, hit.hitInfo);
+
+        const BSDFContext bsdfContext =
+          materialTable.CreateBSDFContext(materialId, path.ray, shadingInfo);
+
+        const BSDFSample bsdfSample =
+          materialTable.Sample(materialId, bsdfContext, path.ray, sampler2D);
+
+        PathState nextPath;
+        nextPath.ray = bsdfSample.ray;
+        nextPath.bounceCounts = path.bounceCounts;
+        nextPath.pixelIndex = path.pixelIndex;
+        nextPath.sampleSlot = path.sampleSlot;
+        rayStatistics.numBounces++;
+
+        if (!pathTermination.Continue(
+              &nextPath.ray, &nextPath.bounceCounts, sampler1D.Next()))
+        {
+            continue;
+        }
+
+        nextPath.samplerState = context.GetSamplerState();
+
+        m_nextPaths.emplace_back(nextPath);
+    }
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Core/Accel/AccelBase.h"
+#include "Core/HitInfo.h"
+#include "Core/Integrator/PathTermination.h"
+#include "Core/Integrator/RaySorter.h"
+#include "Core/Material/MaterialTable.h"
+#include "Core/Ray.h"
+#include "Core/RenderContext.h"
+#include "Core/TileManager.h"
+#include <cstdint>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+class Scene;
+class Texture2D;
+
+//! ウェーブフロント(ストリーム)型のパストレーサ
+//! タイル内の全パスをまとめて「交差判定 → マテリアル種別でソート →
+//! シェーディング → 次のレイをキューに積む」のステージ単位で処理する。
+//! 乱数列と寄与の足し合わせの順序をパスごとに SimplePathTracing と揃えるので、
+//! 同じシードでは SimplePathTracing と同じ画像になる。
+//! キューのメモリを使い回すため、インスタンスはスレッドごとに用意すること
+class WavefrontPathTracing
+{
+public:
+    WavefrontPathTracing() = default;
+
+    //! タイル内の画素をレンダリングする
+    //! @param numSamples サンプル数(平均を targetTex に書き込む)
+    //! @param context 呼び出し元スレッドの作業領域(乱数もここから引く)
+    //! @param traversalCostTex
+    //! nullptr でなければ画素ごとのトラバーサルコストを記録する
+    void
+    Render(const TileManager::Tile& tile,
+           const Scene& scene,
+           const AccelBase& accel,
+           Texture2D* targetTex,
+           int numSamples,
+           RenderContext& context,
+           Texture2D* traversalCostTex = nullptr);
+
+private:
+    //! 追跡中のパス
+    struct PathState
+    {
+        Ray ray;
+        BounceCounts bounceCounts;
+        SamplerState samplerState; //!< このパスの乱数の状態
+        uint32_t pixelIndex = 0;   //!< タイル内の画素番号
+        uint32_t sampleSlot = 0;   //!< m_sampleContributions 内の番号
+    };
+
+    //! 交差判定の結果
+    struct HitRecord
+    {
+        HitInfo hitInfo;
+        MaterialId materialId = kInvalidMaterialId;
+        uint32_t pathIndex = 0; //!< m_paths 内の番号
+    };
+
+    //! カメラレイを生成してパスキューに積む
+    //! @param sampleBegin 生成するサンプルの先頭のサンプル番号
+    void
+    GeneratePaths(const TileManager::Tile& tile,
+                  const Scene& scene,
+                  const Texture2D& targetTex,
+                  int sampleBegin,
+                  int numSamples,
+                  RenderContext& context);
+
+    //! 2バウンス目以降のパスを方向と原点で並べ替える
+    void
+    SortPaths();
+
+    //! キュー内の全パスの交差判定を行う
+    //! 何にも当たらなかったパスはここで環境マップの寄与を加えて終了する
+    void
+    IntersectPaths(const Scene& scene,
+                   const AccelBase& accel,
+                   RenderContext& context,
+                   bool recordTraversalCost);
+
+    //! 衝突情報をマテリアルの種類ごとにまとめる(安定な計数ソート)
+    void
+    SortHits(const MaterialTable& materialTable);
+
+    //! マテリアルの種類ごとにシェーディングし、次のレイを積む
+    void
+    ShadeHits(const Scene& scene, RenderContext& context);
+
+private:
+    //! 1回に追跡するパスの最大数
+    static constexpr size_t kMaxNumPaths = 1 << 16;
+
+    //! これより少ないパスは並べ替えても効果が薄いのでそのまま追跡する
+    static constexpr size_t kMinNumPathsToSort = 1024;
+
+    RaySorter m_raySorter;
+
+    std::vector<PathState> m_paths;     //!< 現在のバウンスのパス
+    std::vector<PathState> m_nextPaths; //!< 次のバウンスのパス
+    std::vector<HitRecord> m_hits;
+    std::vector<HitRecord> m_sortedHits;
+
+    //! サンプルごとの寄与(波内のサンプル番号 × 画素数 + 画素番号)
+    //! 画素ごとの和をサンプル番号の順に取るためのもの
+    std::vector<Color3f> m_sampleContributions;
+
+    std::vector<Color3f> m_pixelContributions;   //!< 画素ごとの寄与の和
+    std::vector<uint64_t> m_pixelTraversalCosts; //!< 画素ごとのコストの和
+};
+
+} // namespace Core
+} // namespace Petrichor
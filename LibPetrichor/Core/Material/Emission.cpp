@@ -12,22 +12,30 @@ Emission::Emission(const Color3f& color)
 {
 }
 
-Color3f
-Emission::BxDF(const Ray& rayIn,
-               const Ray& rayOut,
-               const ShadingInfo& shadingInfo) const
+BSDFContext
+Emission::CreateBSDFContext(const Ray& rayIn,
+                            const ShadingInfo& shadingInfo) const
 {
     ASSERT(false);
-    return Color3f::Zero();
+    return BSDFContext();
 }
 
-Ray
-Emission::CreateNextRay(const Ray& rayIn,
-                        const ShadingInfo& shadingInfo,
-                        ISampler2D& sampler2D) const
+BSDFEval
+Emission::Evaluate(const BSDFContext& context,
+                   const Ray& rayIn,
+                   const Math::Vector3f& dirOut) const
 {
     ASSERT(false);
-    return Ray();
+    return BSDFEval();
+}
+
+BSDFSample
+Emission::Sample(const BSDFContext& context,
+                 const Ray& rayIn,
+                 ISampler2D& sampler2D) const
+{
+    ASSERT(false);
+    return BSDFSample();
 }
 
 } // namespace Core
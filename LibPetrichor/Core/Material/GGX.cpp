@@ -19,17 +19,39 @@ GGX::GGX(const Color3f& f0, float roughness)
 {
 }
 
-Petrichor::Color3f
-GGX::BxDF(const Ray& rayIn,
-          const Ray& rayOut,
-          const ShadingInfo& shadingInfo) const
+BSDFContext
+GGX::CreateBSDFContext(const Ray& rayIn,
+                       const ShadingInfo& shadingInfo) const
 {
-    const Math::Vector3f normal = GetNormal(shadingInfo);
+    BSDFContext context;
+    context.pos = shadingInfo.pos;
+    context.shadingNormal = GetNormal(shadingInfo);
 
-    const auto halfVec = (-rayIn.dir + rayOut.dir).Normalized();
+    const float hitSign = -Math::Dot(rayIn.dir, context.shadingNormal);
+    context.normal = context.shadingNormal * std::copysign(1.0f, hitSign);
+
+    const Math::Vector3f& normal = context.normal;
+    const auto t = (std::abs(normal.z) < 0.9999f)
+                     ? Cross(normal, Math::Vector3f::UnitZ())
+                     : Math::Vector3f::UnitX();
+    context.frame.Build(normal, t);
+
+    context.reflectance = GetF0(shadingInfo);
+    context.alpha = GetAlpha(shadingInfo);
+    return context;
+}
+
+BSDFEval
+GGX::Evaluate(const BSDFContext& context,
+              const Ray& rayIn,
+              const Math::Vector3f& dirOut) const
+{
+    const Math::Vector3f& normal = context.normal;
+
+    const auto halfVec = (-rayIn.dir + dirOut).Normalized();
     const float hDotN = std::abs(Dot(halfVec, normal));
 
-    const float alpha = GetAlpha(shadingInfo);
+    const float alpha = context.alpha;
     const float alpha2 = alpha * alpha;
     const float hDotN2 = hDotN * hDotN;
     const float k = (alpha2 - 1.0f) * hDotN2 + 1.0f;
@@ -38,70 +60,49 @@ GGX::BxDF(const Ray& rayIn,
     const float dTerm = alpha2 / (Math::kPi * k * k);
 
     // G
-    const float lambdaIn = Lambda(rayOut.dir, halfVec, alpha);
+    const float lambdaIn = Lambda(dirOut, halfVec, alpha);
     const float lambdaOut = Lambda(-rayIn.dir, halfVec, alpha);
     const float gTerm = 1.0f / (1.0f + lambdaIn + lambdaOut);
 
     // F
-    const float hDotL = std::abs(Dot(halfVec, rayOut.dir));
-    const auto fTerm =
-      GetF0(shadingInfo) +
-      (Color3f::One() - GetF0(shadingInfo)) * Math::Pow<5>(1.0f - hDotL);
+    const float hDotL = std::abs(Dot(halfVec, dirOut));
+    const Color3f& f0 = context.reflectance;
+    const auto fTerm = f0 + (Color3f::One() - f0) * Math::Pow<5>(1.0f - hDotL);
 
-    const float lDotN = std::abs(Dot(rayOut.dir, normal));
+    const float lDotN = std::abs(Dot(dirOut, normal));
     const float vDotN = std::abs(Dot(-rayIn.dir, normal));
 
-    auto f = dTerm * gTerm * fTerm / (4.0f * lDotN * vDotN);
-
-    return f;
-}
-
-float
-GGX::PDF(const Ray& rayIn,
-         const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const
-{
-    const Math::Vector3f normal = GetNormal(shadingInfo);
-
-    const auto halfVec = (-rayIn.dir + rayOut.dir).Normalized();
-    const float hDotN = std::abs(Dot(halfVec, normal));
-
-    const float alpha = GetAlpha(shadingInfo);
-    const float alpha2 = alpha * alpha;
-    const float hDotN2 = hDotN * hDotN;
-
-    // D
-    const float tmp = 1.0f - (1.0f - alpha2) * hDotN2;
-    return tmp > 0 ? Math::kInvPi * alpha2 / (tmp * tmp) : kInfinity;
+    BSDFEval eval;
+    eval.value = dTerm * gTerm * fTerm / (4.0f * lDotN * vDotN);
+    eval.pdf = PDFHalfVector(halfVec, normal, alpha);
+    return eval;
 }
 
-Ray
-GGX::CreateNextRay(const Ray& rayIn,
-                   const ShadingInfo& shadingInfo,
-                   ISampler2D& sampler2D) const
+BSDFSample
+GGX::Sample(const BSDFContext& context,
+            const Ray& rayIn,
+            ISampler2D& sampler2D) const
 {
-    const Math::Vector3f normal0 = GetNormal(shadingInfo);
-    const float hitSign = -Math::Dot(rayIn.dir, normal0);
-    const Math::Vector3f normal = normal0 * std::copysign(1.0f, hitSign);
+    const Math::Vector3f& normal = context.normal;
 
-#if 1 // USE_VNDF_SAMPLING
     Math::Vector3f sampledHalfVec =
-      SampleGGXVNDF(-rayIn.dir, shadingInfo, sampler2D);
-    // sampledHalfVec = hitInfo.normal;
+      SampleGGXVNDF(-rayIn.dir, context, sampler2D);
     Math::Vector3f outDir = (rayIn.dir).Reflected(sampledHalfVec);
 
     // TODO: あとでFresnel()にまとめる
     const float hDotL = std::abs(Math::Dot(sampledHalfVec, outDir));
-    const Color3f f0 = GetF0(shadingInfo);
+    const Color3f& f0 = context.reflectance;
     const auto fTerm = f0 + (Color3f::One() - f0) * Math::Pow<5>(1.0f - hDotL);
 
-    Ray ray(shadingInfo.pos,
-            outDir,
-            RayTypes::Glossy,
-            rayIn.throughput,
-            rayIn.bounce + 1);
+    BSDFSample sample;
+    Ray& ray = sample.ray;
+    ray = Ray(context.pos,
+              outDir,
+              RayTypes::Glossy,
+              rayIn.throughput,
+              rayIn.bounce + 1);
 
-    const float alpha = GetAlpha(shadingInfo);
+    const float alpha = context.alpha;
     const float lambdaIn = Lambda(outDir, sampledHalfVec, alpha);
     const float lambdaOut = Lambda(-rayIn.dir, sampledHalfVec, alpha);
     const float g2 = 1.0f / (1.0f + lambdaIn + lambdaOut);
@@ -110,32 +111,26 @@ GGX::CreateNextRay(const Ray& rayIn,
     ray.throughput *= (fTerm * g2 / g1);
     ASSERT(ray.throughput.MinElem() >= 0.0f);
 
-#else
-    Math::OrthonormalBasis onb;
-    onb.Build(normal);
-
-    auto pointSampled = sampler2D.Next();
-
-    float theta = acos(std::get<0>(pointSampled));
-    float phi = 2.0f * M_PI * std::get<1>(pointSampled);
-    *pdfDir = 1.0f / (2.0f * M_PI);
-
-    auto outDir = onb.GetDir(theta, phi);
-
-    Ray ray(shadingInfo.pos,
-            outDir,
-            RayTypes::Glossy,
-            rayIn.throughput,
-            rayIn.bounce + 1);
+    ray.o += kEps * normal;
 
-    auto f = BxDF(rayIn, ray, shadingInfo);
-    auto cos = std::max(0.0f, Math::Dot(ray.dir, normal));
-    ray.throughput *= (f * cos / *pdfDir);
+    // Evaluate() と同じ値になるよう、出射方向からハーフベクトルを求め直す
+    const auto halfVec = (-rayIn.dir + outDir).Normalized();
+    sample.pdf = PDFHalfVector(halfVec, normal, alpha);
+    return sample;
+}
 
-#endif
+float
+GGX::PDFHalfVector(const Math::Vector3f& halfDir,
+                   const Math::Vector3f& normal,
+                   float alpha) const
+{
+    const float hDotN = std::abs(Dot(halfDir, normal));
+    const float alpha2 = alpha * alpha;
+    const float hDotN2 = hDotN * hDotN;
 
-    ray.o += kEps * normal;
-    return ray;
+    // D
+    const float tmp = 1.0f - (1.0f - alpha2) * hDotN2;
+    return tmp > 0 ? Math::kInvPi * alpha2 / (tmp * tmp) : kInfinity;
 }
 
 float
@@ -153,23 +148,14 @@ GGX::Lambda(const Math::Vector3f& dir,
 }
 Math::Vector3f
 GGX::SampleGGXVNDF(const Math::Vector3f& dirView,
-                   const ShadingInfo& shadingInfo,
+                   const BSDFContext& context,
                    ISampler2D& rng2D) const
 {
-    const Math::Vector3f normal0 = GetNormal(shadingInfo);
-    const float hitSign = Math::Dot(dirView, normal0);
-    const Math::Vector3f normal = normal0 * std::copysign(1.0f, hitSign);
-
     // ---- vを算出 ----
-    Math::OrthonormalBasis onbOnSurface;
-    const auto t = (std::abs(normal.z) < 0.9999f)
-                     ? Cross(normal, Math::Vector3f::UnitZ())
-                     : Math::Vector3f::UnitX();
-
-    onbOnSurface.Build(normal, t);
+    const Math::OrthonormalBasis& onbOnSurface = context.frame;
 
     auto v = onbOnSurface.WorldToLocal(dirView);
-    const float alpha = GetAlpha(shadingInfo);
+    const float alpha = context.alpha;
     v *= Math::Vector3f(alpha, alpha, 1.0f);
     v.Normalize();
 
@@ -18,20 +18,19 @@ class GGX : public MaterialBase
 public:
     GGX(const Color3f& f0, float roughness = 1.0f);
 
-    Color3f
-    BxDF(const Ray& rayIn,
-         const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const override;
+    BSDFContext
+    CreateBSDFContext(const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const override;
 
-    float
-    PDF(const Ray& rayIn,
-        const Ray& rayOut,
-        const ShadingInfo& shadingInfo) const override;
+    BSDFEval
+    Evaluate(const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const override;
 
-    Ray
-    CreateNextRay(const Ray& rayIn,
-                  const ShadingInfo& shadingInfo,
-                  ISampler2D& sampler2D) const override;
+    BSDFSample
+    Sample(const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const override;
 
     MaterialTypes
     GetMaterialType() const override
@@ -53,6 +52,18 @@ public:
         m_normalMap = normalMap;
     }
 
+    const Texture2D*
+    GetRoughnessMap() const
+    {
+        return m_roughnessMap;
+    }
+
+    const Texture2D*
+    GetNormalMap() const
+    {
+        return m_normalMap;
+    }
+
     //! ラフネス用のテクスチャを取得する
     const float
     GetAlpha(const ShadingInfo& shadingInfo) const
@@ -80,6 +91,12 @@ public:
         m_reflectanceMap = texture;
     }
 
+    const Texture2D*
+    GetF0Texture() const
+    {
+        return m_reflectanceMap;
+    }
+
     void
     SetNormalMapStrength(float strength)
     {
@@ -144,9 +161,15 @@ private:
            const Math::Vector3f& halfDir,
            float alpha) const;
 
+    //! 出射方向の確率密度(D項)
+    float
+    PDFHalfVector(const Math::Vector3f& halfDir,
+                  const Math::Vector3f& normal,
+                  float alpha) const;
+
     Math::Vector3f
     SampleGGXVNDF(const Math::Vector3f& dirView,
-                  const ShadingInfo& shadingInfo,
+                  const BSDFContext& context,
                   ISampler2D& rng2D) const;
 
 private:
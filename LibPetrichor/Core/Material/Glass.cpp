@@ -8,57 +8,63 @@ namespace Petrichor
 namespace Core
 {
 
-Color3f
-Glass::BxDF(const Ray& rayIn,
-            const Ray& rayOut,
-            const ShadingInfo& shadingInfo) const
+BSDFContext
+Glass::CreateBSDFContext(const Ray& rayIn,
+                         const ShadingInfo& shadingInfo) const
 {
-    // #TODO: roughnessを追加したらここも変更
-    return Color3f::Zero();
+    const float hitSign = -Math::Dot(rayIn.dir, shadingInfo.normal);
+
+    BSDFContext context;
+    context.pos = shadingInfo.pos;
+    context.shadingNormal = shadingInfo.normal;
+    context.normal = shadingInfo.normal * std::copysign(1.0f, hitSign);
+    context.reflectance = m_color;
+    context.alpha = GetAlpha(shadingInfo);
+    return context;
 }
 
-float
-Glass::PDF(const Ray& rayIn,
-           const Ray& rayOut,
-           const ShadingInfo& shadingInfo) const
+BSDFEval
+Glass::Evaluate(const BSDFContext& context,
+                const Ray& rayIn,
+                const Math::Vector3f& dirOut) const
 {
     // #TODO: roughnessを追加したらここも変更
-    return 0.0f;
+    return BSDFEval();
 }
 
-Ray
-Glass::CreateNextRay(const Ray& rayIn,
-                     const ShadingInfo& shadingInfo,
-                     ISampler2D& sampler2D) const
+BSDFSample
+Glass::Sample(const BSDFContext& context,
+              const Ray& rayIn,
+              ISampler2D& sampler2D) const
 {
-    const float hitSign = -Math::Dot(rayIn.dir, shadingInfo.normal);
-    const Math::Vector3f normal =
-      shadingInfo.normal * std::copysign(1.0f, hitSign);
+    const Math::Vector3f& normal = context.normal;
 
     ASSERT(0 < rayIn.ior);
     const float relativeIOR = m_ior / rayIn.ior;
 
-    Ray rayOut;
+    // 完全鏡面なので確率密度は常に0として扱う
+    BSDFSample sample;
+    Ray& rayOut = sample.ray;
 
     const auto refractDir =
-      rayIn.dir.Refracted(shadingInfo.normal, relativeIOR);
+      rayIn.dir.Refracted(context.shadingNormal, relativeIOR);
 
     if (!refractDir)
     {
         // 全反射
-        rayOut.o = shadingInfo.pos + kEps * normal;
+        rayOut.o = context.pos + kEps * normal;
         rayOut.dir = rayIn.dir.Reflected(normal).Normalized();
         rayOut.throughput = Math::Vector3f::Zero(); //; rayIn.throughput;
         rayOut.rayType = RayTypes::Glossy;
-        rayOut.bounce = rayOut.bounce + 1;
+        rayOut.bounce = rayIn.bounce + 1;
         rayOut.prob = rayIn.prob;
         rayOut.ior = rayIn.ior;
-        return rayOut;
+        return sample;
     }
 
     rayOut.dir = (*refractDir).Normalized();
 
-    const float normalDotOutDir = Math::Dot(shadingInfo.normal, rayOut.dir);
+    const float normalDotOutDir = Math::Dot(context.shadingNormal, rayOut.dir);
     const float refrectance = [&] {
         const float f0 =
           Math::Pow<2>((1.0f - relativeIOR) / (1.0f + relativeIOR));
@@ -70,27 +76,27 @@ Glass::CreateNextRay(const Ray& rayIn,
     if (std::get<0>(sampler2D.Next()) <= refrectance)
     {
         // 反射
-        rayOut.o = shadingInfo.pos + kEps * normal;
+        rayOut.o = context.pos + kEps * normal;
         rayOut.throughput = rayIn.throughput;
         rayOut.rayType = RayTypes::Glossy;
         rayOut.bounce = rayIn.bounce + 1;
         rayOut.prob = rayIn.prob;
         rayOut.ior = rayIn.ior;
-        return rayOut;
+        return sample;
     }
     else
     {
         const bool isEnterMedium = (normalDotOutDir < 0);
 
         // 透過
-        rayOut.o = shadingInfo.pos - kEps * normal;
+        rayOut.o = context.pos - kEps * normal;
         rayOut.throughput = rayIn.throughput;
-        rayOut.rayType = RayTypes::Glossy;
+        rayOut.rayType = RayTypes::Refract;
         rayOut.bounce = rayIn.bounce + 1;
         rayOut.prob = rayIn.prob;
         rayOut.ior =
           isEnterMedium ? rayOut.ior * relativeIOR : rayOut.ior / relativeIOR;
-        return rayOut;
+        return sample;
     }
 }
 
@@ -25,20 +25,19 @@ public:
     {
     }
 
-    Color3f
-    BxDF(const Ray& rayIn,
-         const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const override;
-
-    float
-    PDF(const Ray& rayIn,
-        const Ray& rayOut,
-        const ShadingInfo& shadingInfo) const override;
-
-    Ray
-    CreateNextRay(const Ray& rayIn,
-                  const ShadingInfo& shadingInfo,
-                  ISampler2D& sampler2D) const override;
+    BSDFContext
+    CreateBSDFContext(const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const override;
+
+    BSDFEval
+    Evaluate(const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const override;
+
+    BSDFSample
+    Sample(const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const override;
 
     MaterialTypes
     GetMaterialType() const override
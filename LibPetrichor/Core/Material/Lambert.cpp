@@ -24,42 +24,48 @@ Lambert::Lambert(const Color3f& kd, const Texture2D& albedoTex)
 {
 }
 
-Color3f
-Lambert::BxDF(const Ray& rayIn,
-              const Ray& rayOut,
-              const ShadingInfo& shadingInfo) const
+BSDFContext
+Lambert::CreateBSDFContext(const Ray& rayIn,
+                           const ShadingInfo& shadingInfo) const
 {
-    return m_kd * GetAlbedo(shadingInfo) * Math::kInvPi;
+    const float hitSign = -Math::Dot(rayIn.dir, shadingInfo.normal);
+
+    BSDFContext context;
+    context.pos = shadingInfo.pos;
+    context.shadingNormal = shadingInfo.normal;
+    context.normal = shadingInfo.normal * std::copysign(1.0f, hitSign);
+    context.frame.Build(context.normal);
+    context.reflectance = GetAlbedo(shadingInfo);
+    return context;
 }
 
-float
-Lambert::PDF(const Ray& rayIn,
-             const Ray& rayOut,
-             const ShadingInfo& shadingInfo) const
+BSDFEval
+Lambert::Evaluate(const BSDFContext& context,
+                  const Ray& rayIn,
+                  const Math::Vector3f& dirOut) const
 {
+    BSDFEval eval;
+    eval.value = m_kd * context.reflectance * Math::kInvPi;
+
     if (IsImportanceSamplingEnabled())
     {
-        float cos = std::abs(Math::Dot(rayOut.dir, shadingInfo.normal));
-        return cos * Math::kInvPi;
+        float cos = std::abs(Math::Dot(dirOut, context.normal));
+        eval.pdf = cos * Math::kInvPi;
     }
     else
     {
-        return 0.5f * Math::kInvPi;
+        eval.pdf = 0.5f * Math::kInvPi;
     }
+
+    return eval;
 }
 
-Ray
-Lambert::CreateNextRay(const Ray& rayIn,
-                       const ShadingInfo& shadingInfo,
-                       ISampler2D& sampler2D) const
+BSDFSample
+Lambert::Sample(const BSDFContext& context,
+                const Ray& rayIn,
+                ISampler2D& sampler2D) const
 {
-    const float hitSign = -Math::Dot(rayIn.dir, shadingInfo.normal);
-
-    const Math::Vector3f normal =
-      shadingInfo.normal * std::copysign(1.0f, hitSign);
-
-    Math::OrthonormalBasis onb;
-    onb.Build(normal);
+    const Math::OrthonormalBasis& onb = context.frame;
 
     auto [rand0, rand1] = sampler2D.Next();
 
@@ -74,13 +80,16 @@ Lambert::CreateNextRay(const Ray& rayIn,
         const Math::Vector3f outDir =
           coffU * onb.GetU() + coffV * onb.GetV() + coffW * onb.GetW();
 
-        const Color3f throughput = rayIn.throughput * GetAlbedo(shadingInfo);
+        const Color3f throughput = rayIn.throughput * context.reflectance;
 
-        return { shadingInfo.pos + kEps * normal,
-                 outDir,
-                 RayTypes::Diffuse,
-                 throughput,
-                 rayIn.bounce + 1 };
+        BSDFSample sample;
+        sample.ray = { context.pos + kEps * context.normal,
+                       outDir,
+                       RayTypes::Diffuse,
+                       throughput,
+                       rayIn.bounce + 1 };
+        sample.pdf = coffW * Math::kInvPi;
+        return sample;
     }
     else
     {
@@ -95,16 +104,17 @@ Lambert::CreateNextRay(const Ray& rayIn,
         const Math::Vector3f outDir =
           coffU * onb.GetU() + coffV * onb.GetV() + coffW * onb.GetW();
 
-        Ray rayOut(shadingInfo.pos + kEps * normal,
-                   outDir,
-                   RayTypes::Diffuse,
-                   rayIn.throughput,
-                   rayIn.bounce + 1);
-
-        const auto f = BxDF(rayIn, rayOut, shadingInfo);
-        rayOut.throughput *= (f * cosTheta / PDF(rayIn, rayOut, shadingInfo));
-
-        return rayOut;
+        BSDFSample sample;
+        sample.ray = Ray(context.pos + kEps * context.normal,
+                         outDir,
+                         RayTypes::Diffuse,
+                         rayIn.throughput,
+                         rayIn.bounce + 1);
+
+        const BSDFEval eval = Evaluate(context, rayIn, outDir);
+        sample.ray.throughput *= (eval.value * cosTheta / eval.pdf);
+        sample.pdf = eval.pdf;
+        return sample;
     }
 }
 
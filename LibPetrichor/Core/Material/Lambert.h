@@ -16,20 +16,19 @@ public:
 
     Lambert(const Color3f& kd, const Texture2D& albedoTex);
 
-    Color3f
-    BxDF(const Ray& rayIn,
-         const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const override;
+    BSDFContext
+    CreateBSDFContext(const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const override;
 
-    float
-    PDF(const Ray& rayIn,
-        const Ray& rayOut,
-        const ShadingInfo& shadingInfo) const override;
+    BSDFEval
+    Evaluate(const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const override;
 
-    Ray
-    CreateNextRay(const Ray& rayIn,
-                  const ShadingInfo& shadingInfo,
-                  ISampler2D& sampler2D) const override;
+    BSDFSample
+    Sample(const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const override;
 
     MaterialTypes
     GetMaterialType() const override;
@@ -40,6 +39,12 @@ public:
         m_texAlbedo = texAlbedo;
     }
 
+    const Texture2D*
+    GetTexAlbedo() const
+    {
+        return m_texAlbedo;
+    }
+
     Color3f
     GetAlbedo(const ShadingInfo& shadingInfo) const;
 
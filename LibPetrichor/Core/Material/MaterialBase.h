@@ -2,13 +2,14 @@
 
 #include "Core/Color3f.h"
 #include "Core/HitInfo.h"
+#include "Core/Ray.h"
+#include "Math/OrthonormalBasis.h"
 
 namespace Petrichor
 {
 namespace Core
 {
 
-struct Ray;
 struct HitInfo;
 class ISampler2D;
 
@@ -21,30 +22,91 @@ enum class MaterialTypes
     Mix
 };
 
+//! マテリアルの種類の数
+constexpr size_t kNumMaterialTypes = 5;
+
+//! 衝突点ごとに1度だけ求めるBSDFの評価用の情報
+//! 法線マップやテクスチャの参照、ラフネスの計算を済ませておき、
+//! ライトサンプリングとBSDFサンプリングの両方で使い回す
+struct BSDFContext
+{
+    Math::Vector3f pos;           //!< 衝突点
+    Math::Vector3f shadingNormal; //!< 法線マップ適用後の法線
+    Math::Vector3f normal;        //!< 入射側を向くように反転した法線
+    Math::OrthonormalBasis frame; //!< normal をW軸とする正規直交基底
+    Color3f reflectance;          //!< 反射色(アルベドやF0)
+    float alpha = 0.0f;           //!< Roughness^2
+};
+
+//! BSDFの評価結果
+struct BSDFEval
+{
+    Color3f value;    //!< BSDFの値
+    float pdf = 0.0f; //!< 出射方向の確率密度(立体角測度)
+};
+
+//! BSDFのサンプリング結果
+struct BSDFSample
+{
+    Ray ray;          //!< 次のレイ(スループットは更新済み)
+    float pdf = 0.0f; //!< ray.dir を Evaluate() したときの pdf と同じ値
+};
+
 class MaterialBase
 {
 public:
     MaterialBase() = default;
     virtual ~MaterialBase() {}
 
-    virtual Color3f
+    //! 衝突点のBSDFの評価用の情報を求める
+    //! @param rayIn 衝突点に入射したレイ
+    virtual BSDFContext
+    CreateBSDFContext(const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const = 0;
+
+    //! BSDFの値と確率密度をまとめて評価する
+    //! @param dirOut 出射方向
+    virtual BSDFEval
+    Evaluate(const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const = 0;
+
+    //! 出射方向をサンプリングして次のレイを生成する
+    virtual BSDFSample
+    Sample(const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const = 0;
+
+    //! BSDFの値
+    //! 同じ衝突点で何度も評価する場合は Evaluate() を使うこと
+    Color3f
     BxDF(const Ray& rayIn,
          const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const = 0;
+         const ShadingInfo& shadingInfo) const
+    {
+        const BSDFContext context = CreateBSDFContext(rayIn, shadingInfo);
+        return Evaluate(context, rayIn, rayOut.dir).value;
+    }
 
-    virtual float
+    //! 出射方向の確率密度
+    //! 同じ衝突点で何度も評価する場合は Evaluate() を使うこと
+    float
     PDF(const Ray& rayIn,
         const Ray& rayOut,
         const ShadingInfo& shadingInfo) const
     {
-        ASSERT(false);
-        return 0.0f;
-    };
+        const BSDFContext context = CreateBSDFContext(rayIn, shadingInfo);
+        return Evaluate(context, rayIn, rayOut.dir).pdf;
+    }
 
-    virtual Ray
+    Ray
     CreateNextRay(const Ray& rayIn,
                   const ShadingInfo& shadingInfo,
-                  ISampler2D& sampler2D) const = 0;
+                  ISampler2D& sampler2D) const
+    {
+        const BSDFContext context = CreateBSDFContext(rayIn, shadingInfo);
+        return Sample(context, rayIn, sampler2D).ray;
+    }
 
     virtual MaterialTypes
     GetMaterialType() const = 0;
@@ -0,0 +1,219 @@
+#include "MaterialTable.h"
+
+#include "Core/Logger.h"
+#include "Core/Material/MixMaterial.h"
+
+namespace Petrichor
+{
+namespace Core
+{
+
+void
+MaterialTable::Build(const std::vector<const MaterialBase*>& materials)
+{
+    m_records.clear();
+    m_lamberts.clear();
+    m_glasses.clear();
+    m_emissions.clear();
+    m_ggxs.clear();
+    m_mixes.clear();
+    m_materialIds.clear();
+
+    for (const MaterialBase* material : materials)
+    {
+        if (material)
+        {
+            Register(material);
+        }
+    }
+}
+
+void
+MaterialTable::ReplaceTextures(
+  const std::function<const Texture2D*(const Texture2D*)>& replace)
+{
+    const auto replaceIfSet = [&replace](const Texture2D* texture) {
+        return texture ? replace(texture) : nullptr;
+    };
+
+    for (Lambert& lambert : m_lamberts)
+    {
+        lambert.SetTexAlbedo(replaceIfSet(lambert.GetTexAlbedo()));
+    }
+
+    for (GGX& ggx : m_ggxs)
+    {
+        ggx.SetF0Texture(replaceIfSet(ggx.GetF0Texture()));
+        ggx.SetRoughnessMap(replaceIfSet(ggx.GetRoughnessMap()));
+        ggx.SetNormalMap(replaceIfSet(ggx.GetNormalMap()));
+    }
+}
+
+MaterialId
+MaterialTable::FindMaterialId(const MaterialBase* material) const
+{
+    const auto iter = m_materialIds.find(material);
+    return iter != m_materialIds.end() ? iter->second : kInvalidMaterialId;
+}
+
+const MaterialBase*
+MaterialTable::GetMaterial(MaterialId materialId) const
+{
+    const Record& record = m_records[materialId];
+    switch (GetMaterialType(materialId))
+    {
+    case MaterialTypes::Lambert:
+        return &m_lamberts[record.index];
+    case MaterialTypes::Glass:
+        return &m_glasses[record.index];
+    case MaterialTypes::Emission:
+        return &m_emissions[record.index];
+    case MaterialTypes::Glossy:
+        return &m_ggxs[record.index];
+    default:
+        ASSERT(false && "Mix material must be resolved.");
+        return nullptr;
+    }
+}
+
+BSDFContext
+MaterialTable::CreateBSDFContext(MaterialId materialId,
+                                 const Ray& rayIn,
+                                 const ShadingInfo& shadingInfo) const
+{
+    const Record& record = m_records[materialId];
+    switch (GetMaterialType(materialId))
+    {
+    case MaterialTypes::Lambert:
+        return m_lamberts[record.index].Lambert::CreateBSDFContext(
+          rayIn, shadingInfo);
+    case MaterialTypes::Glass:
+        return m_glasses[record.index].Glass::CreateBSDFContext(rayIn,
+                                                                shadingInfo);
+    case MaterialTypes::Glossy:
+        return m_ggxs[record.index].GGX::CreateBSDFContext(rayIn, shadingInfo);
+    default:
+        ASSERT(false && "Invalid material type.");
+        return BSDFContext();
+    }
+}
+
+BSDFEval
+MaterialTable::Evaluate(MaterialId materialId,
+                        const BSDFContext& context,
+                        const Ray& rayIn,
+                        const Math::Vector3f& dirOut) const
+{
+    const Record& record = m_records[materialId];
+    switch (GetMaterialType(materialId))
+    {
+    case MaterialTypes::Lambert:
+        return m_lamberts[record.index].Lambert::Evaluate(
+          context, rayIn, dirOut);
+    case MaterialTypes::Glass:
+        return m_glasses[record.index].Glass::Evaluate(context, rayIn, dirOut);
+    case MaterialTypes::Glossy:
+        return m_ggxs[record.index].GGX::Evaluate(context, rayIn, dirOut);
+    default:
+        ASSERT(false && "Invalid material type.");
+        return BSDFEval();
+    }
+}
+
+BSDFSample
+MaterialTable::Sample(MaterialId materialId,
+                      const BSDFContext& context,
+                      const Ray& rayIn,
+                      ISampler2D& sampler2D) const
+{
+    const Record& record = m_records[materialId];
+    switch (GetMaterialType(materialId))
+    {
+    case MaterialTypes::Lambert:
+        return m_lamberts[record.index].Lambert::Sample(
+          context, rayIn, sampler2D);
+    case MaterialTypes::Glass:
+        return m_glasses[record.index].Glass::Sample(
+          context, rayIn, sampler2D);
+    case MaterialTypes::Glossy:
+        return m_ggxs[record.index].GGX::Sample(context, rayIn, sampler2D);
+    default:
+        ASSERT(false && "Invalid material type.");
+        return BSDFSample();
+    }
+}
+
+MaterialId
+MaterialTable::Register(const MaterialBase* material)
+{
+    if (const auto iter = m_materialIds.find(material);
+        iter != m_materialIds.end())
+    {
+        return iter->second;
+    }
+
+    Record record;
+    record.materialType = material->GetMaterialType();
+
+    // MixMaterial の参照先は先に登録しておく
+    MixRecord mix;
+    if (record.materialType == MaterialTypes::Mix)
+    {
+        const auto* mixMaterial = static_cast<const MixMaterial*>(material);
+        for (size_t i = 0; i < 2; i++)
+        {
+            const MaterialBase* child = mixMaterial->GetMaterials()[i];
+            ASSERT(child && "Mix material has no child.");
+            mix.materialIds[i] = Register(child);
+            if (mix.materialIds[i] == kInvalidMaterialId)
+            {
+                return kInvalidMaterialId;
+            }
+        }
+        mix.mix = mixMaterial->GetMix();
+    }
+
+    // 番号が足りない場合は、種類ごとの配列にも追加しない
+    if (m_records.size() >= kInvalidMaterialId)
+    {
+        Logger::Error("Too many materials. [{}]", m_records.size());
+        ASSERT(false);
+        return kInvalidMaterialId;
+    }
+
+    switch (record.materialType)
+    {
+    case MaterialTypes::Lambert:
+        record.index = static_cast<uint16_t>(m_lamberts.size());
+        m_lamberts.emplace_back(*static_cast<const Lambert*>(material));
+        break;
+
+    case MaterialTypes::Glass:
+        record.index = static_cast<uint16_t>(m_glasses.size());
+        m_glasses.emplace_back(*static_cast<const Glass*>(material));
+        break;
+
+    case MaterialTypes::Emission:
+        record.index = static_cast<uint16_t>(m_emissions.size());
+        m_emissions.emplace_back(*static_cast<const Emission*>(material));
+        break;
+
+    case MaterialTypes::Glossy:
+        record.index = static_cast<uint16_t>(m_ggxs.size());
+        m_ggxs.emplace_back(*static_cast<const GGX*>(material));
+        break;
+
+    case MaterialTypes::Mix:
+        record.index = static_cast<uint16_t>(m_mixes.size());
+        m_mixes.emplace_back(mix);
+        break;
+    }
+
+    const auto materialId = static_cast<MaterialId>(m_records.size());
+    m_records.emplace_back(record);
+    m_materialIds[material] = materialId;
+    return materialId;
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Core/Material/Emission.h"
+#include "Core/Material/GGX.h"
+#include "Core/Material/Glass.h"
+#include "Core/Material/Lambert.h"
+#include "Core/Material/MaterialBase.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! MaterialTable 内のマテリアルの番号
+using MaterialId = uint16_t;
+
+//! マテリアルが割り当てられていないことを表す番号
+constexpr MaterialId kInvalidMaterialId =
+  std::numeric_limits<MaterialId>::max();
+
+//! レンダリング用のマテリアルのテーブル
+//! シーンの確定時に、ジオメトリから参照されるマテリアルを種類ごとの連続した
+//! 配列へコピーし、16bitの番号で参照できるようにする。
+//! シェーディングは種類による switch で分岐するので、仮想関数を経由しない
+class MaterialTable
+{
+public:
+    MaterialTable() = default;
+
+    //! テーブルを構築する
+    //! MixMaterial が参照するマテリアルもまとめて登録する
+    //! @param materials 登録するマテリアル(重複や nullptr を含んでもよい)
+    void
+    Build(const std::vector<const MaterialBase*>& materials);
+
+    //! マテリアルが参照するテクスチャを差し替える
+    //! NUMA ノードごとに複製したテクスチャを参照させるためのもの
+    //! @param replace 元のテクスチャから差し替え先を返す(nullptr は渡さない)
+    void
+    ReplaceTextures(
+      const std::function<const Texture2D*(const Texture2D*)>& replace);
+
+    //! 構築時に登録したマテリアルの番号を取得する
+    //! @return 登録されていない場合は kInvalidMaterialId
+    MaterialId
+    FindMaterialId(const MaterialBase* material) const;
+
+    //! 登録されたマテリアルの数
+    size_t
+    GetNumMaterials() const
+    {
+        return m_records.size();
+    }
+
+    //! マテリアルの種類を取得する
+    MaterialTypes
+    GetMaterialType(MaterialId materialId) const
+    {
+        ASSERT(materialId < m_records.size());
+        return m_records[materialId].materialType;
+    }
+
+    //! MixMaterial を解決して、単一のマテリアルの番号を取得する
+    //! 入れ子の MixMaterial は、選んだ側の範囲に乱数を引き伸ばして辿る
+    //! @param rand [0, 1]の乱数
+    MaterialId
+    Resolve(MaterialId materialId, float rand) const
+    {
+        while (GetMaterialType(materialId) == MaterialTypes::Mix)
+        {
+            const MixRecord& mix = m_mixes[m_records[materialId].index];
+            if (mix.mix <= rand)
+            {
+                materialId = mix.materialIds[0];
+                rand = mix.mix < 1.0f ? (rand - mix.mix) / (1.0f - mix.mix)
+                                      : 0.0f;
+            }
+            else
+            {
+                materialId = mix.materialIds[1];
+                rand = rand / mix.mix;
+            }
+        }
+        return materialId;
+    }
+
+    //! テーブル内のマテリアルを取得する
+    const MaterialBase*
+    GetMaterial(MaterialId materialId) const;
+
+    //! 光源の色を取得する
+    const Color3f&
+    GetLightColor(MaterialId materialId) const
+    {
+        ASSERT(GetMaterialType(materialId) == MaterialTypes::Emission);
+        return m_emissions[m_records[materialId].index].GetLightColor();
+    }
+
+    //! MaterialBase::CreateBSDFContext() を種類で分岐して呼ぶ
+    BSDFContext
+    CreateBSDFContext(MaterialId materialId,
+                      const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const;
+
+    //! MaterialBase::Evaluate() を種類で分岐して呼ぶ
+    BSDFEval
+    Evaluate(MaterialId materialId,
+             const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const;
+
+    //! MaterialBase::Sample() を種類で分岐して呼ぶ
+    BSDFSample
+    Sample(MaterialId materialId,
+           const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const;
+
+private:
+    //! 番号から種類ごとの配列を引くためのレコード
+    struct Record
+    {
+        MaterialTypes materialType = MaterialTypes::Lambert;
+        uint16_t index = 0; //!< 種類ごとの配列内の番号
+    };
+
+    //! MixMaterial のパラメータ
+    struct MixRecord
+    {
+        MaterialId materialIds[2] = { kInvalidMaterialId, kInvalidMaterialId };
+        float mix = 0.0f;
+    };
+
+    //! マテリアルを1つ登録する(登録済みの場合は何もしない)
+    MaterialId
+    Register(const MaterialBase* material);
+
+private:
+    std::vector<Record> m_records;
+
+    std::vector<Lambert> m_lamberts;
+    std::vector<Glass> m_glasses;
+    std::vector<Emission> m_emissions;
+    std::vector<GGX> m_ggxs;
+    std::vector<MixRecord> m_mixes;
+
+    //! 構築時に使う、元のマテリアルから番号への対応
+    std::unordered_map<const MaterialBase*, MaterialId> m_materialIds;
+};
+
+} // namespace Core
+} // namespace Petrichor
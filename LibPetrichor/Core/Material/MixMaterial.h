@@ -3,6 +3,7 @@
 #include "Core/HitInfo.h"
 #include "Core/Ray.h"
 #include "MaterialBase.h"
+#include <array>
 
 namespace Petrichor
 {
@@ -16,22 +17,30 @@ class MixMaterial : public MaterialBase
 public:
     MixMaterial(const MaterialBase* mat0, const MaterialBase* mat1, float mix);
 
-    Color3f
-    BxDF(const Ray& rayIn,
-         const Ray& rayOut,
-         const ShadingInfo& shadingInfo) const override
+    BSDFContext
+    CreateBSDFContext(const Ray& rayIn,
+                      const ShadingInfo& shadingInfo) const override
     {
         ASSERT(false);
-        return Color3f();
+        return BSDFContext();
     }
 
-    Ray
-    CreateNextRay(const Ray& rayIn,
-                  const ShadingInfo& shadingInfo,
-                  ISampler2D& sampler2D) const override
+    BSDFEval
+    Evaluate(const BSDFContext& context,
+             const Ray& rayIn,
+             const Math::Vector3f& dirOut) const override
     {
         ASSERT(false);
-        return Ray();
+        return BSDFEval();
+    }
+
+    BSDFSample
+    Sample(const BSDFContext& context,
+           const Ray& rayIn,
+           ISampler2D& sampler2D) const override
+    {
+        ASSERT(false);
+        return BSDFSample();
     }
 
     MaterialTypes
@@ -48,6 +57,20 @@ public:
         return m_mix <= rand ? m_mat0 : m_mat1;
     }
 
+    //! ミックスする2つのマテリアルを取得する
+    std::array<const MaterialBase*, 2>
+    GetMaterials() const
+    {
+        return { m_mat0, m_mat1 };
+    }
+
+    //! ミックスの割合を取得する
+    float
+    GetMix() const
+    {
+        return m_mix;
+    }
+
 private:
     const MaterialBase* m_mat0 = nullptr;
     const MaterialBase* m_mat1 = nullptr;
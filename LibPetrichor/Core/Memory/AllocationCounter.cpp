@@ -0,0 +1,152 @@
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef PETRICHOR_COUNT_ALLOCATIONS
+
+namespace
+{
+
+thread_local uint64_t t_numAllocations = 0;
+
+void*
+CountedAllocate(size_t size)
+{
+    t_numAllocations++;
+    if (void* const p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void*
+CountedAllocateAligned(size_t size, std::align_val_t alignment)
+{
+    t_numAllocations++;
+
+    const auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    void* const p = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc はサイズがアライメントの倍数である必要がある
+    const size_t alignedSize = (std::max<size_t>(size, 1) + align - 1) &
+                               ~(align - 1);
+    void* const p = std::aligned_alloc(align, alignedSize);
+#endif
+    if (p)
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void
+FreeAligned(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void*
+operator new(size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void*
+operator new[](size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void*
+operator new(size_t size, std::align_val_t alignment)
+{
+    return CountedAllocateAligned(size, alignment);
+}
+
+void*
+operator new[](size_t size, std::align_val_t alignment)
+{
+    return CountedAllocateAligned(size, alignment);
+}
+
+void
+operator delete(void* p, std::align_val_t) noexcept
+{
+    FreeAligned(p);
+}
+
+void
+operator delete[](void* p, std::align_val_t) noexcept
+{
+    FreeAligned(p);
+}
+
+void
+operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(p);
+}
+
+void
+operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    FreeAligned(p);
+}
+
+#endif
+
+namespace Petrichor
+{
+namespace Core
+{
+
+uint64_t
+AllocationCounter::GetThreadLocalCount()
+{
+#ifdef PETRICHOR_COUNT_ALLOCATIONS
+    return t_numAllocations;
+#else
+    return 0;
+#endif
+}
+
+} // namespace Core
+} // namespace Petrichor
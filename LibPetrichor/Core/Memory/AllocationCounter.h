@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Core/Assert.h"
+#include <cstdint>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! ヒープ確保の回数
+//! PETRICHOR_COUNT_ALLOCATIONS を定義したビルドでのみ、グローバルな
+//! operator new を置き換えてスレッドごとに数える。それ以外では常に 0
+class AllocationCounter
+{
+public:
+    //! 呼び出し元スレッドでこれまでに行われたヒープ確保の回数
+    static uint64_t
+    GetThreadLocalCount();
+};
+
+//! スコープ内で呼び出し元スレッドがヒープ確保していないことを
+//! スコープを抜ける時に ASSERT で確認する
+class ScopedNoAllocationCheck
+{
+public:
+#ifdef PETRICHOR_COUNT_ALLOCATIONS
+    ScopedNoAllocationCheck()
+      : m_countBegin(AllocationCounter::GetThreadLocalCount())
+    {
+    }
+
+    ~ScopedNoAllocationCheck()
+    {
+        ASSERT(AllocationCounter::GetThreadLocalCount() == m_countBegin &&
+               "Heap allocation in the hot path.");
+    }
+#else
+    // 何もしないが、トリビアルにしないことで未使用変数の警告を避ける
+    ScopedNoAllocationCheck() {}
+
+    ~ScopedNoAllocationCheck() {}
+#endif
+
+    ScopedNoAllocationCheck(const ScopedNoAllocationCheck&) = delete;
+
+    ScopedNoAllocationCheck&
+    operator=(const ScopedNoAllocationCheck&) = delete;
+
+#ifdef PETRICHOR_COUNT_ALLOCATIONS
+private:
+    uint64_t m_countBegin = 0;
+#endif
+};
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,117 @@
+#include "ArenaAllocator.h"
+
+#include <algorithm>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+//! offset を alignment の倍数に切り上げる
+uintptr_t
+AlignUp(uintptr_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+} // namespace
+
+ArenaAllocator::ArenaAllocator(size_t blockSize)
+  : m_blockSize(AlignUp(std::max<size_t>(blockSize, kPageSize), kPageSize))
+{
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    Reset();
+}
+
+ArenaAllocator::ArenaAllocator(ArenaAllocator&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+ArenaAllocator&
+ArenaAllocator::operator=(ArenaAllocator&& other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+
+        m_blockSize = other.m_blockSize;
+        m_blocks = std::move(other.m_blocks);
+        m_current = std::exchange(other.m_current, nullptr);
+        m_end = std::exchange(other.m_end, nullptr);
+        m_destructors = std::exchange(other.m_destructors, nullptr);
+        m_numBytesUsed = std::exchange(other.m_numBytesUsed, 0);
+        m_numBytesReserved = std::exchange(other.m_numBytesReserved, 0);
+        other.m_blocks.clear();
+    }
+
+    return *this;
+}
+
+void*
+ArenaAllocator::Allocate(size_t size, size_t alignment)
+{
+    ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+    ASSERT(alignment <= kPageSize);
+
+    auto current = reinterpret_cast<uintptr_t>(m_current);
+    auto aligned = AlignUp(current, alignment);
+    if (m_current == nullptr ||
+        aligned + size > reinterpret_cast<uintptr_t>(m_end))
+    {
+        // ブロックの先頭はページ境界なので、整列のための余白は要らない
+        AllocateBlock(size);
+        current = reinterpret_cast<uintptr_t>(m_current);
+        aligned = current;
+    }
+
+    m_current = reinterpret_cast<std::byte*>(aligned + size);
+    m_numBytesUsed += size;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void
+ArenaAllocator::Reset()
+{
+    for (Destructor* destructor = m_destructors; destructor;
+         destructor = destructor->next)
+    {
+        destructor->destroy(destructor->object);
+    }
+    m_destructors = nullptr;
+
+    for (const auto& [block, blockSize] : m_blocks)
+    {
+        ::operator delete(block, std::align_val_t(kPageSize));
+    }
+    m_blocks.clear();
+
+    m_current = nullptr;
+    m_end = nullptr;
+    m_numBytesUsed = 0;
+    m_numBytesReserved = 0;
+}
+
+void
+ArenaAllocator::AllocateBlock(size_t size)
+{
+    // 既定より大きな要求は専用のブロックにする
+    const size_t blockSize = AlignUp(std::max(size, m_blockSize), kPageSize);
+
+    auto* const block = static_cast<std::byte*>(
+      ::operator new(blockSize, std::align_val_t(kPageSize)));
+    m_blocks.emplace_back(block, blockSize);
+
+    m_current = block;
+    m_end = block + blockSize;
+    m_numBytesReserved += blockSize;
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Core/Assert.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! ページ境界に揃えたブロックから順に切り出していくアロケータ
+//! 確保したオブジェクトは個別には解放せず、Reset() またはデストラクタで
+//! まとめて破棄する。トリビアルに破棄できない型だけデストラクタを記録しておき、
+//! 生成と逆順に呼ぶ。スレッドセーフではない
+class ArenaAllocator
+{
+public:
+    //! ブロックの境界
+    static constexpr size_t kPageSize = 4096;
+
+    //! ブロックの既定のサイズ
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+public:
+    explicit ArenaAllocator(size_t blockSize = kDefaultBlockSize);
+
+    ~ArenaAllocator();
+
+    ArenaAllocator(const ArenaAllocator&) = delete;
+
+    ArenaAllocator&
+    operator=(const ArenaAllocator&) = delete;
+
+    ArenaAllocator(ArenaAllocator&& other) noexcept;
+
+    ArenaAllocator&
+    operator=(ArenaAllocator&& other) noexcept;
+
+    //! 未初期化のメモリを確保する
+    //! @param alignment 2のべき乗かつ kPageSize 以下
+    void*
+    Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    //! T をアリーナ上に生成する
+    //! 返したポインタはアリーナを Reset() するまで有効
+    template<typename T, typename... Args>
+    T*
+    New(Args&&... args)
+    {
+        void* const memory = Allocate(sizeof(T), alignof(T));
+        T* const object = new (memory) T(std::forward<Args>(args)...);
+
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            auto* const destructor = static_cast<Destructor*>(
+              Allocate(sizeof(Destructor), alignof(Destructor)));
+            destructor->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+            destructor->object = object;
+            destructor->next = m_destructors;
+            m_destructors = destructor;
+        }
+
+        return object;
+    }
+
+    //! 生成したオブジェクトを全て破棄し、ブロックを解放する
+    void
+    Reset();
+
+    //! 切り出したバイト数
+    size_t
+    GetNumBytesUsed() const
+    {
+        return m_numBytesUsed;
+    }
+
+    //! ブロックとして確保しているバイト数
+    size_t
+    GetNumBytesReserved() const
+    {
+        return m_numBytesReserved;
+    }
+
+private:
+    //! 破棄時に呼ぶデストラクタ(アリーナ上に置く単方向リスト)
+    struct Destructor
+    {
+        void (*destroy)(void*) = nullptr;
+        void* object = nullptr;
+        Destructor* next = nullptr;
+    };
+
+    //! size バイト以上の新しいブロックを確保して切り出し位置を移す
+    void
+    AllocateBlock(size_t size);
+
+private:
+    size_t m_blockSize = kDefaultBlockSize;
+
+    std::vector<std::pair<std::byte*, size_t>> m_blocks; //!< 先頭とサイズ
+    std::byte* m_current = nullptr; //!< 現在のブロックの切り出し位置
+    std::byte* m_end = nullptr;     //!< 現在のブロックの終端
+
+    Destructor* m_destructors = nullptr; //!< 最後に生成したものが先頭
+
+    size_t m_numBytesUsed = 0;
+    size_t m_numBytesReserved = 0;
+};
+
+} // namespace Core
+} // namespace Petrichor
@@ -2,7 +2,9 @@
 
 #include "Core/AOV/AOVDenoisingAlbedo.h"
 #include "Core/AOV/AOVDenoisingNormal.h"
+#include "Core/AOV/AOVTraversalCost.h"
 #include "Core/AOV/AOVUVCoordinate.h"
+#include "Core/Accel/BinnedSAHBVH.h"
 #include "Core/Camera.h"
 #include "Core/Geometry/Mesh.h"
 #include "Core/Geometry/Sphere.h"
@@ -10,16 +12,22 @@
 #include "Core/Geometry/Vertex.h"
 #include "Core/Integrator/PathTracing.h"
 #include "Core/Integrator/SimplePathTracing.h"
+#include "Core/Integrator/WavefrontPathTracing.h"
 #include "Core/Logger.h"
 #include "Core/Material/Emission.h"
 #include "Core/Material/GGX.h"
 #include "Core/Material/Lambert.h"
 #include "Core/Material/MixMaterial.h"
+#include "Core/RenderCheckpoint.h"
+#include "Core/RenderContext.h"
 #include "Core/Sampler/MicroJitteredSampler.h"
 #include "Core/Sampler/RandomSampler1D.h"
 #include "Core/Sampler/RandomSampler2D.h"
 #include "Core/TileManager.h"
+#include "Core/TileSink.h"
+#include "Profiler/Profiler.h"
 #include "Random/XorShift.h"
+#include "Thread/CpuTopology.h"
 #include "Thread/ThreadPool.h"
 #include <fstream>
 #include <iomanip>
@@ -35,240 +43,1012 @@ void
 Petrichor::Render(const Scene& scene)
 {
     SCOPE_LOGGER(__FUNCTION__);
+    PROFILE_SCOPE("Render");
+
+    if (!scene.IsFinalized())
+    {
+        Logger::Error("Scene is not finalized.");
+        return;
+    }
+
+    RayStatisticsCounter::Reset();
 
     // #TODO 外部から設定可能にする
     // BruteForce accel;
-    const BinnedSAHBVH accel = [&] {
-        BinnedSAHBVH accel_;
-        accel_.Build(scene);
-        return accel_;
-    }();
+    const BinnedSAHBVH& accel = PrepareAccel(scene);
 
     const uint32_t tileWidth = scene.GetRenderSetting().tileWidth;
     const uint32_t tileHeight = scene.GetRenderSetting().tileHeight;
 
+    // 乱数列はシードと画素とサンプル番号だけから決まり、
+    // スレッド数やタイルの大きさによらない
+    const uint32_t seed = scene.GetRenderSetting().seed;
+
+    const std::unique_ptr<RenderCheckpoint> checkpoint =
+      BeginCheckpoint(scene);
+
+    // デノイズ用の AOV は軽いので Rendered より先に描画しておく
+    // (TileSink でデノイズする場合に、Rendered のタイルが揃ったそばから始められる)
+
+    // Albedo
     {
-        Texture2D* const targetTexure =
-          scene.GetTargetTexture(Scene::AOVType::Rendered);
-        if (targetTexure)
+        Texture2D* const denoisingAlbedoTexture =
+          scene.GetTargetTexture(Scene::AOVType::DenoisingAlbedo);
+        if (denoisingAlbedoTexture)
         {
-            SCOPE_LOGGER("[AOV] Rendered");
+            SCOPE_LOGGER("[AOV] DenoisingAlbedo");
+            PROFILE_SCOPE("AOV::DenoisingAlbedo");
 
-            // #TODO: 外部から設定可能にする
-            SimplePathTracing pt;
+            AOVDenoisingAlbedo renderer;
 
-            const int outputWidth = targetTexure->GetWidth();
-            const int outputHeight = targetTexure->GetHeight();
+            const uint32_t tileWidth = scene.GetRenderSetting().tileWidth;
+            const uint32_t tileHeight = scene.GetRenderSetting().tileHeight;
+
+            const int outputWidth = denoisingAlbedoTexture->GetWidth();
+            const int outputHeight = denoisingAlbedoTexture->GetHeight();
             const TileManager tileManager(
               outputWidth, outputHeight, tileWidth, tileHeight);
-            m_numTiles = tileManager.GetNumTiles();
 
             m_numRenderedTiles = 0;
 
+            const bool isTileSinkActive =
+              BeginTileSink(Scene::AOVType::DenoisingAlbedo,
+                            *denoisingAlbedoTexture,
+                            tileWidth,
+                            tileHeight);
+
             {
                 const uint32_t numThreads = scene.GetRenderSetting().numThreads;
-                ThreadPool threadPool(numThreads);
+                ThreadPool threadPool(numThreads,
+                                      scene.GetRenderSetting().threadAffinity);
 
                 int tileIndex = 0;
                 for (const TileManager::Tile& tile : tileManager.GetTiles())
                 {
-                    threadPool.Push([&, tile, tileIndex](size_t threadIndex) {
-                        RandomSampler1D sampler1D(tileIndex);
-                        RandomSampler2D sampler2D(tileIndex, tileIndex + 1);
+                    if (!m_partition.IsTileAssigned(tileIndex))
+                    {
+                        m_numRenderedTiles++;
+                        tileIndex++;
+                        continue;
+                    }
+
+                    threadPool.Push([&, tile](size_t threadIndex) {
+                        PROFILE_SCOPE("Tile");
+
+                        if (RestoreTile(checkpoint.get(),
+                                        Scene::AOVType::DenoisingAlbedo,
+                                        tile,
+                                        denoisingAlbedoTexture))
+                        {
+                            if (isTileSinkActive)
+                            {
+                                NotifyTileFinished(
+                                  Scene::AOVType::DenoisingAlbedo,
+                                  tile,
+                                  *denoisingAlbedoTexture);
+                            }
+
+                            m_numRenderedTiles++;
+                            return;
+                        }
+
+                        RenderContext& context =
+                          RenderContext::GetThreadLocal();
+                        context.BeginTile(seed);
 
                         for (int y = tile.y; y < tile.y + tile.height; y++)
                         {
                             for (int x = tile.x; x < tile.x + tile.width; x++)
                             {
-                                pt.Render(x,
-                                          y,
-                                          scene,
-                                          accel,
-                                          targetTexure,
-                                          sampler1D,
-                                          sampler2D);
+                                context.BeginSample(x, y, 0);
+                                renderer.Render(x,
+                                                y,
+                                                scene,
+                                                GetNodeAccel(accel),
+                                                denoisingAlbedoTexture,
+                                                context.GetSampler1D(),
+                                                context.GetSampler2D());
                             }
                         }
 
+                        if (checkpoint)
+                        {
+                            checkpoint->Accumulate(
+                              Scene::AOVType::DenoisingAlbedo,
+                              tile,
+                              scene.GetRenderSetting().numSppForDenoising,
+                              denoisingAlbedoTexture);
+                            SaveCheckpoint(*checkpoint, false);
+                        }
+
+                        if (isTileSinkActive)
+                        {
+                            NotifyTileFinished(Scene::AOVType::DenoisingAlbedo,
+                                               tile,
+                                               *denoisingAlbedoTexture);
+                        }
+
                         m_numRenderedTiles++;
                     });
+                    tileIndex++;
                 }
             }
-        }
-        else
-        {
-            Logger::Error("Target texture has not been set.\n");
+
+            if (isTileSinkActive)
+            {
+                EndTileSink(Scene::AOVType::DenoisingAlbedo);
+            }
         }
     }
 
-    // UV
+    // WorldNormal
     {
-        Texture2D* const uvCoordinateTexture =
-          scene.GetTargetTexture(Scene::AOVType::UV);
-        if (uvCoordinateTexture)
+        Texture2D* const aovWorldNormalTexture =
+          scene.GetTargetTexture(Scene::AOVType::DenoisingNormal);
+        if (aovWorldNormalTexture)
         {
-            SCOPE_LOGGER("[AOV] UV");
+            SCOPE_LOGGER("[AOV] DenoisingNormal");
+            PROFILE_SCOPE("AOV::DenoisingNormal");
 
-            AOVUVCoordinate renderer;
+            AOVDenoisingNormal renderer;
 
             const uint32_t tileWidth = scene.GetRenderSetting().tileWidth;
             const uint32_t tileHeight = scene.GetRenderSetting().tileHeight;
 
-            const int outputWidth = uvCoordinateTexture->GetWidth();
-            const int outputHeight = uvCoordinateTexture->GetHeight();
+            const int outputWidth = aovWorldNormalTexture->GetWidth();
+            const int outputHeight = aovWorldNormalTexture->GetHeight();
             const TileManager tileManager(
               outputWidth, outputHeight, tileWidth, tileHeight);
 
             m_numRenderedTiles = 0;
 
+            const bool isTileSinkActive =
+              BeginTileSink(Scene::AOVType::DenoisingNormal,
+                            *aovWorldNormalTexture,
+                            tileWidth,
+                            tileHeight);
+
             {
                 const uint32_t numThreads = scene.GetRenderSetting().numThreads;
-                ThreadPool threadPool(numThreads);
+                ThreadPool threadPool(numThreads,
+                                      scene.GetRenderSetting().threadAffinity);
 
                 int tileIndex = 0;
                 for (const TileManager::Tile& tile : tileManager.GetTiles())
                 {
-                    threadPool.Push([&, tile, tileIndex](size_t threadIndex) {
-                        RandomSampler1D sampler1D(tileIndex);
-                        RandomSampler2D sampler2D(tileIndex, tileIndex + 1);
+                    if (!m_partition.IsTileAssigned(tileIndex))
+                    {
+                        m_numRenderedTiles++;
+                        tileIndex++;
+                        continue;
+                    }
+
+                    threadPool.Push([&, tile](size_t threadIndex) {
+                        PROFILE_SCOPE("Tile");
+
+                        if (RestoreTile(checkpoint.get(),
+                                        Scene::AOVType::DenoisingNormal,
+                                        tile,
+                                        aovWorldNormalTexture))
+                        {
+                            if (isTileSinkActive)
+                            {
+                                NotifyTileFinished(
+                                  Scene::AOVType::DenoisingNormal,
+                                  tile,
+                                  *aovWorldNormalTexture);
+                            }
+
+                            m_numRenderedTiles++;
+                            return;
+                        }
+
+                        RenderContext& context =
+                          RenderContext::GetThreadLocal();
+                        context.BeginTile(seed);
 
                         for (int y = tile.y; y < tile.y + tile.height; y++)
                         {
                             for (int x = tile.x; x < tile.x + tile.width; x++)
                             {
+                                context.BeginSample(x, y, 0);
                                 renderer.Render(x,
                                                 y,
                                                 scene,
-                                                accel,
-                                                uvCoordinateTexture,
-                                                sampler1D,
-                                                sampler2D);
+                                                GetNodeAccel(accel),
+                                                aovWorldNormalTexture,
+                                                context.GetSampler1D(),
+                                                context.GetSampler2D());
                             }
                         }
 
+                        if (checkpoint)
+                        {
+                            checkpoint->Accumulate(
+                              Scene::AOVType::DenoisingNormal,
+                              tile,
+                              scene.GetRenderSetting().numSppForDenoising,
+                              aovWorldNormalTexture);
+                            SaveCheckpoint(*checkpoint, false);
+                        }
+
+                        if (isTileSinkActive)
+                        {
+                            NotifyTileFinished(Scene::AOVType::DenoisingNormal,
+                                               tile,
+                                               *aovWorldNormalTexture);
+                        }
+
                         m_numRenderedTiles++;
                     });
                     tileIndex++;
                 }
             }
+
+            if (isTileSinkActive)
+            {
+                EndTileSink(Scene::AOVType::DenoisingNormal);
+            }
         }
     }
 
-    // Albedo
+    // Rendered
     {
-        Texture2D* const denoisingAlbedoTexture =
-          scene.GetTargetTexture(Scene::AOVType::DenoisingAlbedo);
-        if (denoisingAlbedoTexture)
+        Texture2D* const targetTexure =
+          scene.GetTargetTexture(Scene::AOVType::Rendered);
+        if (targetTexure)
         {
-            SCOPE_LOGGER("[AOV] DenoisingAlbedo");
+            SCOPE_LOGGER("[AOV] Rendered");
+            PROFILE_SCOPE("AOV::Rendered");
 
-            AOVDenoisingAlbedo renderer;
+            const IntegratorTypes integrator =
+              scene.GetRenderSetting().integrator;
+            Logger::Info("Integrator: {}", GetIntegratorName(integrator));
 
-            const uint32_t tileWidth = scene.GetRenderSetting().tileWidth;
-            const uint32_t tileHeight = scene.GetRenderSetting().tileHeight;
+            SimplePathTracing pt;
 
-            const int outputWidth = denoisingAlbedoTexture->GetWidth();
-            const int outputHeight = denoisingAlbedoTexture->GetHeight();
+            // 作業領域とウェーブフロント型のキューはスレッドごとに使い回す
+            // (スレッドより先に破棄されないようスレッドプールの外で持つ)
+            std::vector<RenderContext> renderContexts;
+            std::vector<WavefrontPathTracing> wavefrontPTs;
+
+            const int outputWidth = targetTexure->GetWidth();
+            const int outputHeight = targetTexure->GetHeight();
             const TileManager tileManager(
               outputWidth, outputHeight, tileWidth, tileHeight);
-
+            // 進捗の表示が前の AOV の数を見ないよう、先にリセットする
             m_numRenderedTiles = 0;
+            m_numTiles = tileManager.GetNumTiles();
+
+            // トラバーサルコストのヒートマップ
+            Texture2D* traversalCostTexture =
+              scene.GetTargetTexture(Scene::AOVType::TraversalCost);
+            if (traversalCostTexture &&
+                (traversalCostTexture->GetWidth() != outputWidth ||
+                 traversalCostTexture->GetHeight() != outputHeight))
+            {
+                Logger::Error("[AOV] TraversalCost: texture size mismatch.");
+                traversalCostTexture = nullptr;
+            }
+
+            // 分散レンダリングではサンプルの一部だけを受け持つことがある
+            const int sampleBegin = m_partition.GetSampleBegin(
+              scene.GetRenderSetting().numSamplesPerPixel);
+            const int numSamples =
+              m_partition.GetSampleEnd(
+                scene.GetRenderSetting().numSamplesPerPixel) -
+              sampleBegin;
+
+            const bool isTileSinkActive = BeginTileSink(
+              Scene::AOVType::Rendered, *targetTexure, tileWidth, tileHeight);
 
             {
                 const uint32_t numThreads = scene.GetRenderSetting().numThreads;
-                ThreadPool threadPool(numThreads);
+                ThreadPool threadPool(numThreads,
+                                      scene.GetRenderSetting().threadAffinity);
+                renderContexts.resize(threadPool.GetNumThreads());
+                if (integrator == IntegratorTypes::WavefrontPathTracing)
+                {
+                    wavefrontPTs.resize(threadPool.GetNumThreads());
+                }
 
                 int tileIndex = 0;
                 for (const TileManager::Tile& tile : tileManager.GetTiles())
                 {
-                    threadPool.Push([&, tile, tileIndex](size_t threadIndex) {
-                        RandomSampler1D sampler1D(tileIndex);
-                        RandomSampler2D sampler2D(tileIndex, tileIndex + 1);
+                    if (!m_partition.IsRenderedTileAssigned(tileIndex))
+                    {
+                        m_numRenderedTiles++;
+                        tileIndex++;
+                        continue;
+                    }
 
-                        for (int y = tile.y; y < tile.y + tile.height; y++)
+                    threadPool.Push([&, tile](size_t threadIndex) {
+                        PROFILE_SCOPE("Tile");
+
+                        // チェックポイントに保存済みのサンプルは描画しない
+                        const int numSavedSamples =
+                          checkpoint
+                            ? static_cast<int>(std::min<uint32_t>(
+                                checkpoint->GetNumSamples(
+                                  Scene::AOVType::Rendered, tile),
+                                numSamples))
+                            : 0;
+                        const int numNewSamples = numSamples - numSavedSamples;
+                        if (numSavedSamples > 0)
                         {
-                            for (int x = tile.x; x < tile.x + tile.width; x++)
+                            checkpoint->Restore(
+                              Scene::AOVType::Rendered, tile, targetTexure);
+                        }
+
+                        // 保存済みのサンプルの続きのサンプル番号から描画する
+                        RenderContext& context = renderContexts[threadIndex];
+                        context.BeginTile(seed, sampleBegin + numSavedSamples);
+
+                        if (integrator ==
+                              IntegratorTypes::WavefrontPathTracing &&
+                            numNewSamples > 0)
+                        {
+                            wavefrontPTs[threadIndex].Render(
+                              tile,
+                              scene,
+                              GetNodeAccel(accel),
+                              targetTexure,
+                              numNewSamples,
+                              context,
+                              traversalCostTexture);
+                        }
+                        else if (numNewSamples > 0)
+                        {
+                            const RayStatistics& rayStatistics =
+                              context.GetRayStatistics();
+
+                            for (int y = tile.y; y < tile.y + tile.height; y++)
                             {
-                                renderer.Render(x,
-                                                y,
-                                                scene,
-                                                accel,
-                                                denoisingAlbedoTexture,
-                                                sampler1D,
-                                                sampler2D);
+                                for (int x = tile.x; x < tile.x + tile.width;
+                                     x++)
+                                {
+                                    const uint64_t traversalCostBegin =
+                                      rayStatistics.GetTraversalCost();
+
+                                    pt.Render(x,
+                                              y,
+                                              scene,
+                                              GetNodeAccel(accel),
+                                              targetTexure,
+                                              numNewSamples,
+                                              context);
+
+                                    if (traversalCostTexture)
+                                    {
+                                        AOVTraversalCost::Record(
+                                          x,
+                                          y,
+                                          rayStatistics.GetTraversalCost() -
+                                            traversalCostBegin,
+                                          numNewSamples,
+                                          traversalCostTexture);
+                                    }
+                                }
                             }
                         }
 
+                        // 追加したサンプルを蓄積済みのサンプルと合わせる
+                        if (checkpoint && numNewSamples > 0)
+                        {
+                            checkpoint->Accumulate(Scene::AOVType::Rendered,
+                                                   tile,
+                                                   numNewSamples,
+                                                   targetTexure);
+                            SaveCheckpoint(*checkpoint, false);
+                        }
+
+                        if (isTileSinkActive)
+                        {
+                            NotifyTileFinished(
+                              Scene::AOVType::Rendered, tile, *targetTexure);
+                        }
+
                         m_numRenderedTiles++;
                     });
                     tileIndex++;
                 }
             }
+
+            if (isTileSinkActive)
+            {
+                EndTileSink(Scene::AOVType::Rendered);
+            }
+
+            if (traversalCostTexture)
+            {
+                // テクスチャにはコストをそのまま残す(ヒートマップは書き出し時)
+                Logger::Info(
+                  "[AOV] TraversalCost: max cost per sample {}",
+                  AOVTraversalCost::CalcMaxCost(*traversalCostTexture));
+            }
+        }
+        else
+        {
+            Logger::Error("Target texture has not been set.\n");
         }
     }
 
-    // WorldNormal
+    // UV
     {
-        Texture2D* const aovWorldNormalTexture =
-          scene.GetTargetTexture(Scene::AOVType::DenoisingNormal);
-        if (aovWorldNormalTexture)
+        Texture2D* const uvCoordinateTexture =
+          scene.GetTargetTexture(Scene::AOVType::UV);
+        if (uvCoordinateTexture)
         {
-            SCOPE_LOGGER("[AOV] DenoisingNormal");
+            SCOPE_LOGGER("[AOV] UV");
+            PROFILE_SCOPE("AOV::UV");
 
-            AOVDenoisingNormal renderer;
+            AOVUVCoordinate renderer;
 
             const uint32_t tileWidth = scene.GetRenderSetting().tileWidth;
             const uint32_t tileHeight = scene.GetRenderSetting().tileHeight;
 
-            const int outputWidth = aovWorldNormalTexture->GetWidth();
-            const int outputHeight = aovWorldNormalTexture->GetHeight();
+            const int outputWidth = uvCoordinateTexture->GetWidth();
+            const int outputHeight = uvCoordinateTexture->GetHeight();
             const TileManager tileManager(
               outputWidth, outputHeight, tileWidth, tileHeight);
 
             m_numRenderedTiles = 0;
 
+            const bool isTileSinkActive = BeginTileSink(
+              Scene::AOVType::UV, *uvCoordinateTexture, tileWidth, tileHeight);
+
             {
                 const uint32_t numThreads = scene.GetRenderSetting().numThreads;
-                ThreadPool threadPool(numThreads);
+                ThreadPool threadPool(numThreads,
+                                      scene.GetRenderSetting().threadAffinity);
 
                 int tileIndex = 0;
                 for (const TileManager::Tile& tile : tileManager.GetTiles())
                 {
-                    threadPool.Push([&, tile, tileIndex](size_t threadIndex) {
-                        RandomSampler1D sampler1D(tileIndex);
-                        RandomSampler2D sampler2D(tileIndex, tileIndex + 1);
+                    if (!m_partition.IsTileAssigned(tileIndex))
+                    {
+                        m_numRenderedTiles++;
+                        tileIndex++;
+                        continue;
+                    }
+
+                    threadPool.Push([&, tile](size_t threadIndex) {
+                        PROFILE_SCOPE("Tile");
+
+                        RenderContext& context =
+                          RenderContext::GetThreadLocal();
+                        context.BeginTile(seed);
 
                         for (int y = tile.y; y < tile.y + tile.height; y++)
                         {
                             for (int x = tile.x; x < tile.x + tile.width; x++)
                             {
+                                context.BeginSample(x, y, 0);
                                 renderer.Render(x,
                                                 y,
                                                 scene,
-                                                accel,
-                                                aovWorldNormalTexture,
-                                                sampler1D,
-                                                sampler2D);
+                                                GetNodeAccel(accel),
+                                                uvCoordinateTexture,
+                                                context.GetSampler1D(),
+                                                context.GetSampler2D());
                             }
                         }
 
+                        if (isTileSinkActive)
+                        {
+                            NotifyTileFinished(
+                              Scene::AOVType::UV, tile, *uvCoordinateTexture);
+                        }
+
                         m_numRenderedTiles++;
                     });
                     tileIndex++;
                 }
             }
+
+            if (isTileSinkActive)
+            {
+                EndTileSink(Scene::AOVType::UV);
+            }
         }
     }
 
+    if (checkpoint)
+    {
+        SaveCheckpoint(*checkpoint, true);
+    }
+
     Finalize();
 }
 
+void
+Petrichor::RenderPreview(
+  Scene& scene,
+  const PreviewSetting& previewSetting,
+  const std::function<void(const PreviewImage&)>& onPassFinished)
+{
+    SCOPE_LOGGER(__FUNCTION__);
+    PROFILE_SCOPE("RenderPreview");
+
+    if (!scene.IsFinalized())
+    {
+        Logger::Error("Scene is not finalized.");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_previewMutex);
+        m_isPreviewStopRequested = false;
+    }
+
+    // BVH はジオメトリが変わった場合だけ作り直す
+    const BinnedSAHBVH* accel = &PrepareAccel(scene);
+
+    const int width = scene.GetRenderSetting().outputWidth;
+    const int height = scene.GetRenderSetting().outputHeight;
+    const int initialDownscale = std::max(previewSetting.initialDownscale, 1);
+    const int numSamplesPerPass = std::max(previewSetting.numSamplesPerPass, 1);
+
+    Texture2D passTexture(width, height);
+    Texture2D previewTexture(width, height);
+    std::vector<RenderContext> renderContexts;
+
+    int downscale = initialDownscale;
+    int numSamples = 0;
+    int passIndex = 0;
+    auto resetTime = ClockType::now();
+
+    for (;;)
+    {
+        // シーンの変更を反映する(描画中のパスはないので書き換えてよい)
+        std::vector<std::function<void(Scene&)>> sceneUpdates;
+        {
+            std::unique_lock<std::mutex> lock(m_previewMutex);
+
+            // 上限まで累積したら、変更か停止を待つ
+            const bool isConverged = previewSetting.maxSamples > 0 &&
+                                     numSamples >= previewSetting.maxSamples;
+            m_previewCondition.wait(lock, [&] {
+                return !isConverged || !m_previewSceneUpdates.empty() ||
+                       m_isPreviewStopRequested;
+            });
+
+            if (m_isPreviewStopRequested)
+            {
+                break;
+            }
+
+            sceneUpdates.swap(m_previewSceneUpdates);
+            m_isPreviewPassCancelled = false;
+        }
+
+        if (!sceneUpdates.empty())
+        {
+            for (const auto& update : sceneUpdates)
+            {
+                update(scene);
+            }
+
+            // マテリアルの変更は MaterialTable を作り直せば反映される
+            scene.Finalize();
+            accel = &PrepareAccel(scene);
+
+            downscale = initialDownscale;
+            numSamples = 0;
+            passIndex = 0;
+            resetTime = ClockType::now();
+        }
+
+        PreviewImage previewImage;
+        previewImage.downscale = downscale;
+        previewImage.passIndex = passIndex;
+
+        if (downscale > 1)
+        {
+            // 縮小したパスは累積せず、次のパスで置き換える
+            Texture2D lowResTexture(std::max(width / downscale, 1),
+                                    std::max(height / downscale, 1));
+            if (!RenderPreviewPass(scene,
+                                   *accel,
+                                   &lowResTexture,
+                                   nullptr,
+                                   numSamplesPerPass,
+                                   0,
+                                   &renderContexts))
+            {
+                continue;
+            }
+
+            previewImage.texture = &lowResTexture;
+            previewImage.numSamples = numSamplesPerPass;
+            onPassFinished(previewImage);
+
+            downscale /= 2;
+        }
+        else
+        {
+            if (!RenderPreviewPass(scene,
+                                   *accel,
+                                   &passTexture,
+                                   &previewTexture,
+                                   numSamplesPerPass,
+                                   numSamples,
+                                   &renderContexts))
+            {
+                continue;
+            }
+
+            numSamples += numSamplesPerPass;
+
+            previewImage.texture = &previewTexture;
+            previewImage.numSamples = numSamples;
+            onPassFinished(previewImage);
+        }
+
+        if (passIndex == 0)
+        {
+            Logger::Info(
+              "[Preview] First image in {} ms",
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                ClockType::now() - resetTime)
+                .count());
+        }
+        passIndex++;
+    }
+}
+
+void
+Petrichor::UpdatePreviewScene(const std::function<void(Scene&)>& update)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_previewMutex);
+        m_previewSceneUpdates.emplace_back(update);
+        m_isPreviewPassCancelled = true;
+    }
+    m_previewCondition.notify_all();
+}
+
+void
+Petrichor::StopPreview()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_previewMutex);
+        m_isPreviewStopRequested = true;
+        m_isPreviewPassCancelled = true;
+    }
+    m_previewCondition.notify_all();
+}
+
+const BinnedSAHBVH&
+Petrichor::PrepareAccel(const Scene& scene)
+{
+    // アドレスは破棄後に再利用されるので、世代番号でシーンの同一性を判定する
+    // 同じシーンでも、構築設定が変わった場合は構築し直す
+    if (m_accel &&
+        m_accelGeometryGeneration == scene.GetGeometryGeneration() &&
+        m_accel->GetBuildOptions() ==
+          BinnedSAHBVH::MakeBuildOptions(scene.GetRenderSetting()))
+    {
+        Logger::Info("[BVH] Reuse the BVH of the previous render.");
+    }
+    else
+    {
+        m_accel = std::make_unique<BinnedSAHBVH>();
+        m_accel->Build(scene);
+        m_accelReplicas.clear();
+
+        m_accelGeometryGeneration = scene.GetGeometryGeneration();
+    }
+
+    // シーンのマテリアル等を NUMA ノードに複製した場合は BVH も複製する
+    if (!scene.IsReplicatedToNodes())
+    {
+        m_accelReplicas.clear();
+    }
+    else if (m_accelReplicas.empty())
+    {
+        const CpuTopology& topology = CpuTopology::Get();
+        m_accelReplicas.resize(topology.GetNumNodes());
+        for (int nodeIndex = 0; nodeIndex < topology.GetNumNodes();
+             nodeIndex++)
+        {
+            topology.RunOnNode(nodeIndex, [&] {
+                m_accelReplicas[nodeIndex] =
+                  std::make_unique<BinnedSAHBVH>(*m_accel);
+            });
+        }
+        Logger::Info("[BVH] Replicated the BVH to {} NUMA nodes.",
+                     m_accelReplicas.size());
+    }
+
+    return *m_accel;
+}
+
+const AccelBase&
+Petrichor::GetNodeAccel(const AccelBase& accel) const
+{
+    const int nodeIndex = ThreadPool::GetCurrentNodeIndex();
+    if (&accel != m_accel.get() || nodeIndex < 0 ||
+        static_cast<int>(m_accelReplicas.size()) <= nodeIndex)
+    {
+        return accel;
+    }
+    return *m_accelReplicas[nodeIndex];
+}
+
+bool
+Petrichor::RenderPreviewPass(const Scene& scene,
+                             const AccelBase& accel,
+                             Texture2D* passTexture,
+                             Texture2D* previewTexture,
+                             int numSamples,
+                             int numPrevSamples,
+                             std::vector<RenderContext>* renderContexts)
+{
+    PROFILE_SCOPE("PreviewPass");
+
+    SimplePathTracing pt;
+
+    const TileManager tileManager(passTexture->GetWidth(),
+                                  passTexture->GetHeight(),
+                                  scene.GetRenderSetting().tileWidth,
+                                  scene.GetRenderSetting().tileHeight);
+
+    // 累積済みの平均に対する、このパスの重み
+    const float weight =
+      static_cast<float>(numSamples) / (numPrevSamples + numSamples);
+
+    {
+        ThreadPool threadPool(scene.GetRenderSetting().numThreads,
+                              scene.GetRenderSetting().threadAffinity);
+        renderContexts->resize(threadPool.GetNumThreads());
+
+        for (const TileManager::Tile& tile : tileManager.GetTiles())
+        {
+            threadPool.Push([&, tile](size_t threadIndex) {
+                PROFILE_SCOPE("Tile");
+
+                // 打ち切られたパスの残りのタイルは描画しない
+                if (m_isPreviewPassCancelled)
+                {
+                    return;
+                }
+
+                RenderContext& context = (*renderContexts)[threadIndex];
+                context.BeginTile(scene.GetRenderSetting().seed,
+                                  numPrevSamples);
+
+                for (int y = tile.y; y < tile.y + tile.height; y++)
+                {
+                    for (int x = tile.x; x < tile.x + tile.width; x++)
+                    {
+                        pt.Render(x,
+                                  y,
+                                  scene,
+                                  GetNodeAccel(accel),
+                                  passTexture,
+                                  numSamples,
+                                  context);
+                    }
+                }
+
+                if (previewTexture == nullptr)
+                {
+                    return;
+                }
+
+                const Color3f* const passPixels = passTexture->GetPixelData();
+                const Color3f* const previewPixels =
+                  previewTexture->GetPixelData();
+                for (int y = tile.y; y < tile.y + tile.height; y++)
+                {
+                    for (int x = tile.x; x < tile.x + tile.width; x++)
+                    {
+                        const size_t pixelIndex =
+                          static_cast<size_t>(y) * passTexture->GetWidth() + x;
+                        const Color3f& prev = previewPixels[pixelIndex];
+                        previewTexture->SetPixel(
+                          x,
+                          y,
+                          prev + (passPixels[pixelIndex] - prev) * weight);
+                    }
+                }
+            });
+        }
+    }
+
+    return !m_isPreviewPassCancelled;
+}
+
+bool
+Petrichor::BeginTileSink(Scene::AOVType::Value aovType,
+                         const Texture2D& texture,
+                         uint32_t tileWidth,
+                         uint32_t tileHeight)
+{
+    if (!m_tileSink)
+    {
+        return false;
+    }
+
+    return m_tileSink->OnBegin(aovType,
+                               texture.GetWidth(),
+                               texture.GetHeight(),
+                               tileWidth,
+                               tileHeight);
+}
+
+void
+Petrichor::NotifyTileFinished(Scene::AOVType::Value aovType,
+                              const TileManager::Tile& tile,
+                              const Texture2D& texture)
+{
+    // 画面端で割り切れた場合は大きさ0のタイルができる
+    if (tile.width <= 0 || tile.height <= 0)
+    {
+        return;
+    }
+
+    TilePixels pixels;
+    pixels.pixels =
+      texture.GetPixelData() + tile.y * texture.GetWidth() + tile.x;
+    pixels.rowStride = texture.GetWidth();
+    m_tileSink->OnTileFinished(aovType, tile, pixels);
+}
+
+void
+Petrichor::EndTileSink(Scene::AOVType::Value aovType)
+{
+    m_tileSink->OnEnd(aovType);
+}
+
+std::unique_ptr<RenderCheckpoint>
+Petrichor::BeginCheckpoint(const Scene& scene)
+{
+    const std::filesystem::path& path = m_checkpointSetting.path;
+    const Texture2D* const targetTexture =
+      scene.GetTargetTexture(Scene::AOVType::Rendered);
+    if (path.empty() || targetTexture == nullptr)
+    {
+        if (m_partition.numParts > 1)
+        {
+            Logger::Error("Partial render result will not be saved because "
+                          "checkpoint path is not set.");
+        }
+        return nullptr;
+    }
+
+    const int width = targetTexture->GetWidth();
+    const int height = targetTexture->GetHeight();
+    const int tileWidth = scene.GetRenderSetting().tileWidth;
+    const int tileHeight = scene.GetRenderSetting().tileHeight;
+    const int numTiles =
+      TileManager(width, height, tileWidth, tileHeight).GetNumTiles();
+
+    auto checkpoint = std::make_unique<RenderCheckpoint>();
+
+    bool isLoaded = false;
+    if (m_checkpointSetting.resume && std::filesystem::exists(path))
+    {
+        isLoaded = checkpoint->Load(path);
+        if (isLoaded && !checkpoint->IsCompatible(
+                          width, height, tileWidth, tileHeight, numTiles))
+        {
+            Logger::Error("Checkpoint does not match the render setting. "
+                          "[{}]",
+                          path.string());
+            isLoaded = false;
+        }
+    }
+
+    if (isLoaded)
+    {
+        Logger::Info("Resume from checkpoint: {}", path.string());
+    }
+    else
+    {
+        checkpoint->Initialize(width, height, tileWidth, tileHeight, numTiles);
+    }
+
+    // 再開した場合も、これから蓄積し終えたときの範囲にする
+    const int numSamplesPerPixel = scene.GetRenderSetting().numSamplesPerPixel;
+    checkpoint->SetSampleRange(m_partition.GetSampleBegin(numSamplesPerPixel),
+                               m_partition.GetSampleEnd(numSamplesPerPixel));
+
+    checkpoint->AddLayer(Scene::AOVType::Rendered);
+    for (const auto aovType :
+         { Scene::AOVType::DenoisingAlbedo, Scene::AOVType::DenoisingNormal })
+    {
+        const Texture2D* const texture = scene.GetTargetTexture(aovType);
+        if (texture && texture->GetWidth() == width &&
+            texture->GetHeight() == height)
+        {
+            checkpoint->AddLayer(aovType);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_checkpointMutex);
+    m_lastCheckpointTime = ClockType::now();
+
+    return checkpoint;
+}
+
+bool
+Petrichor::RestoreTile(const RenderCheckpoint* checkpoint,
+                       Scene::AOVType::Value aovType,
+                       const TileManager::Tile& tile,
+                       Texture2D* texture) const
+{
+    if (checkpoint == nullptr || !checkpoint->HasLayer(aovType) ||
+        checkpoint->GetNumSamples(aovType, tile) == 0)
+    {
+        return false;
+    }
+
+    checkpoint->Restore(aovType, tile, texture);
+    return true;
+}
+
+void
+Petrichor::SaveCheckpoint(const RenderCheckpoint& checkpoint, bool force)
+{
+    std::unique_lock<std::mutex> lock(m_checkpointMutex, std::defer_lock);
+    if (force)
+    {
+        lock.lock();
+    }
+    else if (!lock.try_lock() || ClockType::now() - m_lastCheckpointTime <
+                                   m_checkpointSetting.interval)
+    {
+        return;
+    }
+
+    PROFILE_SCOPE("SaveCheckpoint");
+
+    if (checkpoint.Save(m_checkpointSetting.path))
+    {
+        Logger::Info("Checkpoint saved: {}",
+                     m_checkpointSetting.path.string());
+    }
+    m_lastCheckpointTime = ClockType::now();
+}
+
 void
 Petrichor::Finalize()
 {
+    const RayStatistics rayStatistics = RayStatisticsCounter::Aggregate();
+    {
+        const auto perRay = [&](uint64_t count) {
+            return rayStatistics.numRays > 0
+                     ? static_cast<double>(count) / rayStatistics.numRays
+                     : 0.0;
+        };
+
+        Logger::Info("[RayStatistics] Rays: {} (camera: {}, shadow: {}, "
+                     "diffuse: {}, translucent: {}, glossy: {}, refract: {})",
+                     rayStatistics.numRays,
+                     rayStatistics.numRaysPerType[0],
+                     rayStatistics.numRaysPerType[1],
+                     rayStatistics.numRaysPerType[2],
+                     rayStatistics.numRaysPerType[3],
+                     rayStatistics.numRaysPerType[4],
+                     rayStatistics.numRaysPerType[5]);
+        Logger::Info("[RayStatistics] Node visits: {} ({:.2f} / ray)",
+                     rayStatistics.numNodeVisits,
+                     perRay(rayStatistics.numNodeVisits));
+        Logger::Info("[RayStatistics] AABB tests: {} ({:.2f} / ray)",
+                     rayStatistics.numAABBTests,
+                     perRay(rayStatistics.numAABBTests));
+        Logger::Info("[RayStatistics] Primitive tests: {} ({:.2f} / ray)",
+                     rayStatistics.numPrimitiveTests,
+                     perRay(rayStatistics.numPrimitiveTests));
+        Logger::Info("[RayStatistics] Bounces: {}", rayStatistics.numBounces);
+    }
+
     if (m_onRenderingFinished)
     {
         RenderingResult renderingResult;
+        renderingResult.rayStatistics = rayStatistics;
         m_onRenderingFinished(renderingResult);
     }
 }
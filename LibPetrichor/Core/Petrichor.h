@@ -1,11 +1,18 @@
 #pragma once
 
 #include "Core/Scene.h"
+#include "Core/TileManager.h"
 #include "Logger.h"
+#include "Profiler/RayStatistics.h"
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <filesystem>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace Petrichor
 {
@@ -13,23 +20,145 @@ namespace Petrichor
 struct RenderingResult
 {
     float totalSec;
+
+    //! フレーム全体のレイの統計
+    RayStatistics rayStatistics;
 };
 
 namespace Core
 {
 
+class AccelBase;
+class RenderCheckpoint;
+class RenderContext;
+class TileSink;
+
 using ClockType = std::chrono::high_resolution_clock;
 
+//! チェックポイントの設定
+struct CheckpointSetting
+{
+    //! 保存先(空の場合はチェックポイントを使わない)
+    std::filesystem::path path;
+
+    //! 保存の間隔
+    std::chrono::seconds interval = std::chrono::minutes(10);
+
+    //! path のチェックポイントから再開するか
+    bool resume = false;
+};
+
+//! 分散レンダリングでこのプロセスが受け持つ範囲
+//! 各プロセスはチェックポイントに部分的な結果を書き出し、
+//! RenderCheckpoint::Merge() で合わせる
+struct RenderPartition
+{
+    enum class Mode
+    {
+        Tiles,   //!< タイルを numParts 個おきに受け持つ
+        Samples, //!< 全てのタイルのサンプルの一部を受け持つ
+    };
+
+    Mode mode = Mode::Tiles;
+    int numParts = 1;  //!< 分割数
+    int partIndex = 0; //!< 受け持つ部分の番号 [0, numParts)
+
+    //! タイルを受け持つか
+    //! Samples でも、Rendered 以外の AOV はタイルで分ける
+    bool
+    IsTileAssigned(int tileIndex) const
+    {
+        return tileIndex % numParts == partIndex;
+    }
+
+    //! Rendered のタイルを受け持つか
+    bool
+    IsRenderedTileAssigned(int tileIndex) const
+    {
+        return mode == Mode::Samples || IsTileAssigned(tileIndex);
+    }
+
+    //! 受け持つサンプルの範囲の先頭
+    int
+    GetSampleBegin(int numSamples) const
+    {
+        return mode == Mode::Samples ? numSamples * partIndex / numParts : 0;
+    }
+
+    //! 受け持つサンプルの範囲の末尾(含まない)
+    int
+    GetSampleEnd(int numSamples) const
+    {
+        return mode == Mode::Samples
+                 ? numSamples * (partIndex + 1) / numParts
+                 : numSamples;
+    }
+};
+
+//! インタラクティブなプレビューの設定
+struct PreviewSetting
+{
+    //! 最初のパスの縮小率(2 の冪)
+    //! 1/initialDownscale の解像度から始めて、パスごとに解像度を倍にする
+    int initialDownscale = 8;
+
+    //! 1パスで描画する画素あたりのサンプル数
+    int numSamplesPerPass = 1;
+
+    //! 全解像度で累積するサンプル数の上限(0 の場合は上限なし)
+    //! 上限に達した後はシーンの変更か停止を待つ
+    int maxSamples = 0;
+};
+
+//! プレビューの1パスの結果
+struct PreviewImage
+{
+    //! 表示する画像(縮小したパスでは縮小した大きさ)
+    const Texture2D* texture = nullptr;
+
+    //! 縮小率(1 の場合は全解像度)
+    int downscale = 1;
+
+    //! 画素あたりの累積サンプル数
+    int numSamples = 0;
+
+    //! 累積をやり直してから何パス目か
+    int passIndex = 0;
+};
+
 class Petrichor
 {
 public:
     Petrichor() {}
 
     //! シーンをレンダリングする
+    //! 前回と同じシーンでジオメトリが変わっていなければ、BVH は作り直さない。
+    //! (カメラだけを動かしたフレームを続けて描画する場合など)
     //! @param scene レンダリングするシーン
     void
     Render(const Scene& scene);
 
+    //! シーンを繰り返し描画して、パスごとに結果を onPassFinished に渡す
+    //! 低い解像度から描き始め、全解像度になった後はサンプルを累積していく。
+    //! StopPreview() が呼ばれるまで戻らない。
+    //! onPassFinished はこの関数を呼んだスレッドから呼ばれ、渡した画像は
+    //! 呼び出しの間だけ有効
+    void
+    RenderPreview(
+      Scene& scene,
+      const PreviewSetting& previewSetting,
+      const std::function<void(const PreviewImage&)>& onPassFinished);
+
+    //! プレビュー中のシーンを変更する(どのスレッドから呼んでもよい)
+    //! 描画中のパスを打ち切り、次のパスの前に update を呼んで累積をやり直す。
+    //! カメラやマテリアルの変更では BVH を作り直さない
+    void
+    UpdatePreviewScene(const std::function<void(Scene&)>& update);
+
+    //! RenderPreview() を終了させる(どのスレッドから呼んでもよい)
+    void
+    StopPreview();
+
     void
     SetRenderCallback(
       const std::function<void(const RenderingResult&)>& onRenderingFinished)
@@ -37,6 +166,34 @@ public:
         m_onRenderingFinished = onRenderingFinished;
     }
 
+    //! レンダリングが終わったタイルの受け取り先を設定する
+    //! Render() の間は tileSink を破棄しないこと
+    //! @param tileSink 受け取り先(nullptr の場合は解除)
+    void
+    SetTileSink(TileSink* tileSink)
+    {
+        m_tileSink = tileSink;
+    }
+
+    //! レンダリング結果(Rendered)のチェックポイントを設定する
+    //! 完了したタイルのサンプルを一定間隔とレンダリング終了時に保存する。
+    //! 再開時は保存済みのサンプル数に満たないタイルだけを描画する。
+    //! 保存済みより多いサンプル数を設定すると、続きのサンプルを追加する
+    void
+    SetCheckpoint(const CheckpointSetting& checkpointSetting)
+    {
+        m_checkpointSetting = checkpointSetting;
+    }
+
+    //! このプロセスが受け持つ範囲を設定する
+    //! 部分的な結果はチェックポイントに書き出すので、合わせて SetCheckpoint()
+    //! すること
+    void
+    SetPartition(const RenderPartition& partition)
+    {
+        m_partition = partition;
+    }
+
     //! レンダリング済みタイルの個数を取得する。
     uint32_t
     GetNumRenderedTiles() const
@@ -54,6 +211,69 @@ private:
     void
     Finalize();
 
+    //! タイルの受け取り先に AOV のレンダリング開始を通知する
+    //! @return 受け取り先がこの AOV のタイルを受け取るか
+    bool
+    BeginTileSink(Scene::AOVType::Value aovType,
+                  const Texture2D& texture,
+                  uint32_t tileWidth,
+                  uint32_t tileHeight);
+
+    //! タイルの受け取り先にタイルを渡す
+    void
+    NotifyTileFinished(Scene::AOVType::Value aovType,
+                       const TileManager::Tile& tile,
+                       const Texture2D& texture);
+
+    //! タイルの受け取り先に AOV のレンダリング終了を通知する
+    void
+    EndTileSink(Scene::AOVType::Value aovType);
+
+    //! チェックポイントを用意する
+    //! Rendered と同じ大きさのデノイズ用の AOV もチェックポイントに含める。
+    //! 再開する場合はファイルから読み込む
+    //! @return 使えるチェックポイント(チェックポイントを使わない場合は nullptr)
+    std::unique_ptr<RenderCheckpoint>
+    BeginCheckpoint(const Scene& scene);
+
+    //! チェックポイントに保存済みのタイルをテクスチャに書き込む
+    //! @return 書き込んだか(書き込んだ場合はタイルを描画しなくてよい)
+    bool
+    RestoreTile(const RenderCheckpoint* checkpoint,
+                Scene::AOVType::Value aovType,
+                const TileManager::Tile& tile,
+                Texture2D* texture) const;
+
+    //! シーンの BVH を用意する
+    //! 前回と同じシーンで、ジオメトリと BVH の構築設定が変わっていなければ
+    //! 使い回す
+    const BinnedSAHBVH&
+    PrepareAccel(const Scene& scene);
+
+    //! 呼び出し元のワーカースレッドの NUMA ノードに複製した BVH を取得する
+    //! @return accel が PrepareAccel() の BVH でないか、複製がなければ accel
+    const AccelBase&
+    GetNodeAccel(const AccelBase& accel) const;
+
+    //! プレビューの1パスを描画する
+    //! passTexture に numSamples サンプルずつ描画し、previewTexture が
+    //! nullptr でなければ numPrevSamples サンプル分の平均と合わせる
+    //! @return 最後まで描画したか(UpdatePreviewScene() 等で打ち切った場合は false)
+    bool
+    RenderPreviewPass(const Scene& scene,
+                      const AccelBase& accel,
+                      Texture2D* passTexture,
+                      Texture2D* previewTexture,
+                      int numSamples,
+                      int numPrevSamples,
+                      std::vector<RenderContext>* renderContexts);
+
+    //! 前回の保存から設定の間隔が経っていればチェックポイントを保存する
+    //! 他のスレッドが保存中の場合は何もしない
+    //! @param force 間隔に関わらず保存する
+    void
+    SaveCheckpoint(const RenderCheckpoint& checkpoint, bool force);
+
 private:
     //! レンダリング済みタイルの個数
     std::atomic<uint32_t> m_numRenderedTiles = 0;
@@ -61,8 +281,48 @@ private:
     //! レンダリング終了時に呼ばれる
     std::function<void(const RenderingResult&)> m_onRenderingFinished;
 
+    //! レンダリングが終わったタイルの受け取り先
+    TileSink* m_tileSink = nullptr;
+
+    //! チェックポイントの設定
+    CheckpointSetting m_checkpointSetting;
+
+    //! このプロセスが受け持つ範囲
+    RenderPartition m_partition;
+
+    //! チェックポイントの保存の排他
+    std::mutex m_checkpointMutex;
+
+    //! 最後にチェックポイントを保存した時刻(m_checkpointMutex で保護)
+    ClockType::time_point m_lastCheckpointTime;
+
     //!
     uint32_t m_numTiles = 0;
+
+    //! 構築済みの BVH
+    std::unique_ptr<BinnedSAHBVH> m_accel;
+
+    //! m_accel を構築したときのシーンのジオメトリの世代番号
+    //! (構築設定は m_accel->GetBuildOptions() と比べる)
+    uint64_t m_accelGeometryGeneration = 0;
+
+    //! NUMA ノードごとの m_accel の複製(複製しない場合は空)
+    std::vector<std::unique_ptr<BinnedSAHBVH>> m_accelReplicas;
+
+    //! プレビュー中のシーンの変更の排他
+    std::mutex m_previewMutex;
+
+    //! シーンの変更か停止を待つ
+    std::condition_variable m_previewCondition;
+
+    //! 次のパスの前に反映するシーンの変更(m_previewMutex で保護)
+    std::vector<std::function<void(Scene&)>> m_previewSceneUpdates;
+
+    //! プレビューの停止が要求されたか(m_previewMutex で保護)
+    bool m_isPreviewStopRequested = false;
+
+    //! 描画中のパスを打ち切るか
+    std::atomic<bool> m_isPreviewPassCancelled = false;
 };
 
 } // namespace Core
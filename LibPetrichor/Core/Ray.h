@@ -17,6 +17,9 @@ enum class RayTypes : uint8_t
     Refract,     //!< 屈折したレイ
 };
 
+//! レイの種類の数
+constexpr size_t kNumRayTypes = 6;
+
 struct Ray
 {
     Ray() = default;
@@ -0,0 +1,503 @@
+#include "RenderCheckpoint.h"
+
+#include "Core/Logger.h"
+#include "Core/Texture2D.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+#include <tuple>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+constexpr std::array<char, 4> kMagic = { 'P', 'C', 'K', 'P' };
+constexpr uint32_t kVersion = 4;
+
+//! 読み込むサンプルの番号の範囲の数の上限(壊れたファイルへの備え)
+constexpr int32_t kMaxNumSampleRanges = 1 << 16;
+
+//! ファイルの先頭に置く情報
+//! この後に Rendered のサンプルの番号の範囲 (先頭, 末尾) が
+//! numSampleRanges 個、AOV ごとに (種類, サンプルの和, サンプル数) が続く
+struct Header
+{
+    std::array<char, 4> magic = kMagic;
+    uint32_t version = kVersion;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t tileWidth = 0;
+    int32_t tileHeight = 0;
+    int32_t numTiles = 0;
+    int32_t numLayers = 0;
+    int32_t numSampleRanges = 0;
+};
+
+template<typename T>
+void
+WriteArray(const std::vector<T>& values, std::ofstream* ofs)
+{
+    ofs->write(reinterpret_cast<const char*>(values.data()),
+               values.size() * sizeof(T));
+}
+
+template<typename T>
+void
+ReadArray(size_t size, std::ifstream* ifs, std::vector<T>* values)
+{
+    values->resize(size);
+    ifs->read(reinterpret_cast<char*>(values->data()), size * sizeof(T));
+}
+
+} // namespace
+
+void
+RenderCheckpoint::Initialize(int width,
+                             int height,
+                             int tileWidth,
+                             int tileHeight,
+                             int numTiles)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_width = width;
+    m_height = height;
+    m_tileWidth = tileWidth;
+    m_tileHeight = tileHeight;
+    m_numTiles = numTiles;
+
+    m_layers.clear();
+    m_sampleRanges.clear();
+}
+
+void
+RenderCheckpoint::SetSampleRange(int sampleBegin, int sampleEnd)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_sampleRanges.assign(1, SampleRange{ sampleBegin, sampleEnd });
+}
+
+void
+RenderCheckpoint::AddLayer(Scene::AOVType::Value aovType)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (FindLayer(aovType))
+    {
+        return;
+    }
+
+    const size_t numPixels = static_cast<size_t>(m_width) * m_height;
+
+    Layer layer;
+    layer.aovType = aovType;
+    layer.sampleSums.assign(3 * numPixels, 0.0f);
+    layer.sampleCounts.assign(numPixels, 0);
+    m_layers.emplace_back(std::move(layer));
+}
+
+bool
+RenderCheckpoint::HasLayer(Scene::AOVType::Value aovType) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FindLayer(aovType) != nullptr;
+}
+
+bool
+RenderCheckpoint::Load(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs)
+    {
+        Logger::Error("Could not open file. [{}]", path.string());
+        return false;
+    }
+
+    Header header;
+    ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!ifs || header.magic != kMagic || header.version != kVersion ||
+        header.width <= 0 || header.height <= 0 || header.tileWidth <= 0 ||
+        header.tileHeight <= 0 || header.numTiles <= 0 || header.numLayers < 0 ||
+        header.numLayers > Scene::AOVType::NumAOVTypes ||
+        header.numSampleRanges < 0 ||
+        header.numSampleRanges > kMaxNumSampleRanges)
+    {
+        Logger::Error("Invalid checkpoint file. [{}]", path.string());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_width = header.width;
+    m_height = header.height;
+    m_tileWidth = header.tileWidth;
+    m_tileHeight = header.tileHeight;
+    m_numTiles = header.numTiles;
+
+    m_sampleRanges.resize(header.numSampleRanges);
+    for (SampleRange& range : m_sampleRanges)
+    {
+        ifs.read(reinterpret_cast<char*>(&range.begin), sizeof(range.begin));
+        ifs.read(reinterpret_cast<char*>(&range.end), sizeof(range.end));
+        if (ifs && (range.begin < 0 || range.end < range.begin))
+        {
+            Logger::Error("Invalid sample range in checkpoint file. [{}]",
+                          path.string());
+            m_sampleRanges.clear();
+            return false;
+        }
+    }
+
+    const size_t numPixels = static_cast<size_t>(m_width) * m_height;
+    std::array<bool, Scene::AOVType::NumAOVTypes> hasLayer{};
+    m_layers.resize(header.numLayers);
+    for (Layer& layer : m_layers)
+    {
+        int32_t aovType = 0;
+        ifs.read(reinterpret_cast<char*>(&aovType), sizeof(aovType));
+        if (!ifs)
+        {
+            break;
+        }
+
+        // 層は AOV で引くので、範囲外の AOV や重複は受け付けない
+        if (aovType < 0 || aovType >= Scene::AOVType::NumAOVTypes ||
+            hasLayer[aovType])
+        {
+            Logger::Error("Invalid or duplicate AOV layer {} in checkpoint "
+                          "file. [{}]",
+                          aovType,
+                          path.string());
+            m_layers.clear();
+            return false;
+        }
+        hasLayer[aovType] = true;
+        layer.aovType = static_cast<Scene::AOVType::Value>(aovType);
+
+        ReadArray(3 * numPixels, &ifs, &layer.sampleSums);
+        ReadArray(numPixels, &ifs, &layer.sampleCounts);
+    }
+
+    if (!ifs)
+    {
+        Logger::Error("Checkpoint file is truncated. [{}]", path.string());
+        m_layers.clear();
+        m_sampleRanges.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool
+RenderCheckpoint::Save(const std::filesystem::path& path) const
+{
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream ofs(tempPath, std::ios::binary);
+        if (!ofs)
+        {
+            Logger::Error("Could not open file. [{}]", tempPath.string());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        Header header;
+        header.width = m_width;
+        header.height = m_height;
+        header.tileWidth = m_tileWidth;
+        header.tileHeight = m_tileHeight;
+        header.numTiles = m_numTiles;
+        header.numLayers = static_cast<int32_t>(m_layers.size());
+        header.numSampleRanges = static_cast<int32_t>(m_sampleRanges.size());
+
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const SampleRange& range : m_sampleRanges)
+        {
+            ofs.write(reinterpret_cast<const char*>(&range.begin),
+                      sizeof(range.begin));
+            ofs.write(reinterpret_cast<const char*>(&range.end),
+                      sizeof(range.end));
+        }
+        for (const Layer& layer : m_layers)
+        {
+            const auto aovType = static_cast<int32_t>(layer.aovType);
+            ofs.write(reinterpret_cast<const char*>(&aovType),
+                      sizeof(aovType));
+
+            WriteArray(layer.sampleSums, &ofs);
+            WriteArray(layer.sampleCounts, &ofs);
+        }
+
+        ofs.close();
+        if (!ofs)
+        {
+            Logger::Error("Could not write file. [{}]", tempPath.string());
+            return false;
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(tempPath, path, errorCode);
+    if (errorCode)
+    {
+        Logger::Error("Could not replace file. [{}] ({})",
+                      path.string(),
+                      errorCode.message());
+        return false;
+    }
+
+    return true;
+}
+
+bool
+RenderCheckpoint::Merge(const RenderCheckpoint& other)
+{
+    if (&other == this)
+    {
+        return false;
+    }
+
+    std::scoped_lock lock(m_mutex, other.m_mutex);
+
+    if (m_width != other.m_width || m_height != other.m_height ||
+        m_tileWidth != other.m_tileWidth ||
+        m_tileHeight != other.m_tileHeight || m_numTiles != other.m_numTiles)
+    {
+        Logger::Error("Checkpoints with different image or tile size cannot "
+                      "be merged.");
+        return false;
+    }
+
+    // 同じ画素に同じ番号のサンプルがある場合は、同じ部分を2回渡している
+    // (Tiles では部分ごとに画素が、Samples ではサンプルの番号が重ならない)
+    const bool hasSameSampleIndex = std::any_of(
+      m_sampleRanges.begin(), m_sampleRanges.end(), [&](const auto& range) {
+          return std::any_of(other.m_sampleRanges.begin(),
+                             other.m_sampleRanges.end(),
+                             [&](const auto& otherRange) {
+                                 return range.begin < otherRange.end &&
+                                        otherRange.begin < range.end;
+                             });
+      });
+    const Layer* rendered = FindLayer(Scene::AOVType::Rendered);
+    const Layer* otherRendered = other.FindLayer(Scene::AOVType::Rendered);
+    if (hasSameSampleIndex && rendered && otherRendered)
+    {
+        for (size_t pixelIndex = 0; pixelIndex < rendered->sampleCounts.size();
+             pixelIndex++)
+        {
+            if (rendered->sampleCounts[pixelIndex] > 0 &&
+                otherRendered->sampleCounts[pixelIndex] > 0)
+            {
+                Logger::Error("Checkpoints have the same samples and cannot be "
+                              "merged. (The same part may be passed twice.)");
+                return false;
+            }
+        }
+    }
+
+    for (const Layer& otherLayer : other.m_layers)
+    {
+        Layer* layer = FindLayer(otherLayer.aovType);
+        if (layer == nullptr)
+        {
+            m_layers.emplace_back(otherLayer);
+            continue;
+        }
+
+        std::transform(layer->sampleSums.begin(),
+                       layer->sampleSums.end(),
+                       otherLayer.sampleSums.begin(),
+                       layer->sampleSums.begin(),
+                       std::plus<>());
+        std::transform(layer->sampleCounts.begin(),
+                       layer->sampleCounts.end(),
+                       otherLayer.sampleCounts.begin(),
+                       layer->sampleCounts.begin(),
+                       std::plus<>());
+    }
+
+    m_sampleRanges.insert(m_sampleRanges.end(),
+                          other.m_sampleRanges.begin(),
+                          other.m_sampleRanges.end());
+    std::sort(m_sampleRanges.begin(),
+              m_sampleRanges.end(),
+              [](const SampleRange& lhs, const SampleRange& rhs) {
+                  return std::tie(lhs.begin, lhs.end) <
+                         std::tie(rhs.begin, rhs.end);
+              });
+    m_sampleRanges.erase(
+      std::unique(m_sampleRanges.begin(),
+                  m_sampleRanges.end(),
+                  [](const SampleRange& lhs, const SampleRange& rhs) {
+                      return lhs.begin == rhs.begin && lhs.end == rhs.end;
+                  }),
+      m_sampleRanges.end());
+
+    return true;
+}
+
+bool
+RenderCheckpoint::IsCompatible(int width,
+                               int height,
+                               int tileWidth,
+                               int tileHeight,
+                               int numTiles) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_width == width && m_height == height &&
+           m_tileWidth == tileWidth && m_tileHeight == tileHeight &&
+           m_numTiles == numTiles;
+}
+
+uint32_t
+RenderCheckpoint::GetNumSamples(Scene::AOVType::Value aovType,
+                                const TileManager::Tile& tile) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Layer* layer = FindLayer(aovType);
+    if (layer == nullptr)
+    {
+        return 0;
+    }
+
+    uint32_t numSamples = UINT32_MAX;
+    for (int y = tile.y; y < tile.y + tile.height; y++)
+    {
+        const auto first = layer->sampleCounts.begin() +
+                           static_cast<size_t>(y) * m_width + tile.x;
+        numSamples =
+          std::min(numSamples, *std::min_element(first, first + tile.width));
+    }
+    return numSamples;
+}
+
+std::vector<int>
+RenderCheckpoint::FindTilesWithoutSamples(Scene::AOVType::Value aovType) const
+{
+    const TileManager tileManager(m_width, m_height, m_tileWidth, m_tileHeight);
+
+    std::vector<int> tileIndices;
+    int tileIndex = 0;
+    for (const TileManager::Tile& tile : tileManager.GetTiles())
+    {
+        if (GetNumSamples(aovType, tile) == 0)
+        {
+            tileIndices.emplace_back(tileIndex);
+        }
+        tileIndex++;
+    }
+    return tileIndices;
+}
+
+void
+RenderCheckpoint::Restore(Scene::AOVType::Value aovType,
+                          const TileManager::Tile& tile,
+                          Texture2D* targetTex) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const Layer* layer = FindLayer(aovType);
+    if (layer == nullptr)
+    {
+        return;
+    }
+
+    for (int y = tile.y; y < tile.y + tile.height; y++)
+    {
+        for (int x = tile.x; x < tile.x + tile.width; x++)
+        {
+            const size_t pixelIndex = static_cast<size_t>(y) * m_width + x;
+            const uint32_t numSamples = layer->sampleCounts[pixelIndex];
+            if (numSamples == 0)
+            {
+                continue;
+            }
+
+            const float* sum = &layer->sampleSums[3 * pixelIndex];
+            targetTex->SetPixel(
+              x,
+              y,
+              Color3f(sum[0], sum[1], sum[2]) / static_cast<float>(numSamples));
+        }
+    }
+}
+
+void
+RenderCheckpoint::Restore(Scene::AOVType::Value aovType,
+                          Texture2D* targetTex) const
+{
+    Restore(aovType, TileManager::Tile(m_width, m_height), targetTex);
+}
+
+void
+RenderCheckpoint::Accumulate(Scene::AOVType::Value aovType,
+                             const TileManager::Tile& tile,
+                             int numSamples,
+                             Texture2D* targetTex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Layer* layer = FindLayer(aovType);
+    if (layer == nullptr)
+    {
+        return;
+    }
+
+    // GetPixel() は読み込んだテクスチャ以外では使えないので、直接参照する
+    const Color3f* const pixels = targetTex->GetPixelData();
+
+    for (int y = tile.y; y < tile.y + tile.height; y++)
+    {
+        for (int x = tile.x; x < tile.x + tile.width; x++)
+        {
+            const size_t pixelIndex = static_cast<size_t>(y) * m_width + x;
+            const Color3f added =
+              pixels[pixelIndex] * static_cast<float>(numSamples);
+
+            float* sum = &layer->sampleSums[3 * pixelIndex];
+            sum[0] += added.x;
+            sum[1] += added.y;
+            sum[2] += added.z;
+
+            uint32_t& count = layer->sampleCounts[pixelIndex];
+            count += numSamples;
+
+            targetTex->SetPixel(
+              x,
+              y,
+              Color3f(sum[0], sum[1], sum[2]) / static_cast<float>(count));
+        }
+    }
+}
+
+const RenderCheckpoint::Layer*
+RenderCheckpoint::FindLayer(Scene::AOVType::Value aovType) const
+{
+    const auto it =
+      std::find_if(m_layers.begin(), m_layers.end(), [&](const Layer& layer) {
+          return layer.aovType == aovType;
+      });
+    return it != m_layers.end() ? &*it : nullptr;
+}
+
+RenderCheckpoint::Layer*
+RenderCheckpoint::FindLayer(Scene::AOVType::Value aovType)
+{
+    return const_cast<Layer*>(
+      static_cast<const RenderCheckpoint*>(this)->FindLayer(aovType));
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Core/Scene.h"
+#include "Core/TileManager.h"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+class Texture2D;
+
+//! レンダリングのチェックポイント
+//! AOV ごとに画素ごとのサンプルの和とサンプル数を持ち、
+//! バイナリファイルに保存・復元する。
+//! 乱数列はサンプル番号から決まるので、乱数の状態は保存しない。
+//! 強制終了されたレンダリングを、完了したタイルの結果を引き継いで再開したり、
+//! 完了したレンダリングにサンプルを追加したりするためのもの。
+//! 分散レンダリングでは各プロセスの部分的な結果として書き出し、Merge() で合わせる
+class RenderCheckpoint
+{
+public:
+    RenderCheckpoint() = default;
+
+    RenderCheckpoint(const RenderCheckpoint&) = delete;
+
+    RenderCheckpoint&
+    operator=(const RenderCheckpoint&) = delete;
+
+    //! AOV を持たない状態で初期化する
+    void
+    Initialize(int width,
+               int height,
+               int tileWidth,
+               int tileHeight,
+               int numTiles);
+
+    //! Rendered に蓄積するサンプルの番号の範囲を設定する
+    //! Merge() で同じサンプルを二重に足し合わせないように記録する
+    void
+    SetSampleRange(int sampleBegin, int sampleEnd);
+
+    //! サンプルのない AOV を追加する(既にある場合は何もしない)
+    void
+    AddLayer(Scene::AOVType::Value aovType);
+
+    //! AOV を持っているか
+    bool
+    HasLayer(Scene::AOVType::Value aovType) const;
+
+    //! ファイルから読み込む
+    //! @return 成功したか
+    bool
+    Load(const std::filesystem::path& path);
+
+    //! ファイルに保存する
+    //! 一時ファイルに書き込んでから置き換えるので、保存中に強制終了されても
+    //! 前回のチェックポイントは壊れない。
+    //! 保存中は Accumulate() が待たされる
+    //! @return 成功したか
+    bool
+    Save(const std::filesystem::path& path) const;
+
+    //! 他のチェックポイントのサンプルを足し合わせる
+    //! 画像とタイルの大きさが一致すること。
+    //! 自分にない AOV は追加する。
+    //! 同じ画素に同じ番号のサンプルを持つ場合(同じ部分を2回渡した場合など)は
+    //! 足し合わせない
+    //! @return 成功したか
+    bool
+    Merge(const RenderCheckpoint& other);
+
+    //! 画像とタイルの大きさが一致するか
+    bool
+    IsCompatible(int width,
+                 int height,
+                 int tileWidth,
+                 int tileHeight,
+                 int numTiles) const;
+
+    int
+    GetWidth() const
+    {
+        return m_width;
+    }
+
+    int
+    GetHeight() const
+    {
+        return m_height;
+    }
+
+    //! タイル内の画素のサンプル数の最小値
+    uint32_t
+    GetNumSamples(Scene::AOVType::Value aovType,
+                  const TileManager::Tile& tile) const;
+
+    //! サンプルのない画素を含むタイルの番号を求める
+    //! AOV がない場合は全てのタイル
+    std::vector<int>
+    FindTilesWithoutSamples(Scene::AOVType::Value aovType) const;
+
+    //! 蓄積済みのサンプルの平均をテクスチャに書き込む
+    //! サンプルのない画素は書き換えない
+    void
+    Restore(Scene::AOVType::Value aovType,
+            const TileManager::Tile& tile,
+            Texture2D* targetTex) const;
+
+    //! 画像全体について Restore() する
+    void
+    Restore(Scene::AOVType::Value aovType, Texture2D* targetTex) const;
+
+    //! タイルの画素にサンプルを追加する
+    //! targetTex のタイルの範囲には、追加する numSamples 個のサンプルの平均が
+    //! 入っていること。蓄積済みのサンプルと合わせた平均で上書きする。
+    //! 複数のスレッドから同時に呼んでよい
+    void
+    Accumulate(Scene::AOVType::Value aovType,
+               const TileManager::Tile& tile,
+               int numSamples,
+               Texture2D* targetTex);
+
+private:
+    //! AOV ごとのサンプル
+    struct Layer
+    {
+        Scene::AOVType::Value aovType = Scene::AOVType::Rendered;
+
+        //! 画素ごとのサンプルの和(RGB)
+        std::vector<float> sampleSums;
+
+        //! 画素ごとのサンプル数
+        std::vector<uint32_t> sampleCounts;
+    };
+
+    //! サンプルの番号の範囲 [begin, end)
+    struct SampleRange
+    {
+        int32_t begin = 0;
+        int32_t end = 0;
+    };
+
+    const Layer*
+    FindLayer(Scene::AOVType::Value aovType) const;
+
+    Layer*
+    FindLayer(Scene::AOVType::Value aovType);
+
+    //! m_layers 等の読み書きの排他
+    mutable std::mutex m_mutex;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_tileWidth = 0;
+    int m_tileHeight = 0;
+    int m_numTiles = 0;
+
+    std::vector<Layer> m_layers;
+
+    //! Rendered のサンプルの番号の範囲(Merge() した場合は合わせた全ての範囲)
+    std::vector<SampleRange> m_sampleRanges;
+};
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,44 @@
+#include "RenderContext.h"
+
+namespace Petrichor
+{
+namespace Core
+{
+
+RenderContext::RenderContext()
+  : m_rayStatistics(&RayStatisticsCounter::GetThreadLocal())
+{
+}
+
+void
+RenderContext::BeginTile(uint32_t seed, int sampleBegin)
+{
+    m_seed = seed;
+    m_sampleBegin = sampleBegin;
+    m_traversalStack.Clear();
+    m_rayStatistics = &RayStatisticsCounter::GetThreadLocal();
+}
+
+void
+RenderContext::BeginSample(int pixelX, int pixelY, int sampleIndex)
+{
+    // サンプル番号は画像全体で通すので、分散した範囲を合わせると
+    // 分散しないときと同じサンプルになる
+    m_sampleKey = Math::CounterBasedRandom::MakeKey(
+      m_seed,
+      static_cast<uint32_t>(pixelX),
+      static_cast<uint32_t>(pixelY),
+      static_cast<uint32_t>(m_sampleBegin + sampleIndex));
+    m_sampler1D = RandomSampler1D(m_sampleKey);
+    m_sampler2D = RandomSampler2D(m_sampleKey);
+}
+
+RenderContext&
+RenderContext::GetThreadLocal()
+{
+    thread_local RenderContext context;
+    return context;
+}
+
+} // namespace Core
+} // namespace Petrichor
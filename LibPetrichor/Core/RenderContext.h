@@ -0,0 +1,150 @@
+#pragma once
+
+#include "Core/Assert.h"
+#include "Core/Sampler/RandomSampler1D.h"
+#include "Core/Sampler/RandomSampler2D.h"
+#include "Profiler/RayStatistics.h"
+#include <array>
+#include <cstdint>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! 固定長のトラバーサルスタック
+//! ヒープを使わない。容量を超えて積んだ場合は ASSERT で検出する
+class TraversalStack
+{
+public:
+    //! 積める要素の最大数
+    //! 深さ d のBVHのトラバーサルには d + 1 要素あれば足りるので、
+    //! BVHの最大深さはこれ未満に制限する
+    static constexpr int kCapacity = 128;
+
+    void
+    Push(int nodeIndex)
+    {
+        ASSERT(m_size < kCapacity);
+        m_nodeIndices[m_size++] = nodeIndex;
+    }
+
+    int
+    Pop()
+    {
+        ASSERT(m_size > 0);
+        return m_nodeIndices[--m_size];
+    }
+
+    bool
+    IsEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    void
+    Clear()
+    {
+        m_size = 0;
+    }
+
+private:
+    std::array<int, kCapacity> m_nodeIndices;
+    int m_size = 0;
+};
+
+//! RenderContext の乱数の状態
+//! ウェーブフロント型のインテグレータで、パスごとに持ち回るためのもの
+struct SamplerState
+{
+    uint64_t key = 0;         //!< 乱数列のキー
+    uint32_t dimension1D = 0; //!< 1次元の乱数を引いた個数
+    uint32_t dimension2D = 0; //!< 2次元の乱数を引いた個数
+};
+
+//! レンダリングスレッドごとの作業領域
+//! トラバーサルスタック、乱数の状態、レイ統計のカウンタへの参照をまとめて持ち、
+//! インテグレータからアクセラレータまで引き回す。
+//! サンプルごとのヒープ確保とスレッドローカル変数の参照をなくすためのもの。
+//! 1つのインスタンスを複数のスレッドから同時に使わないこと
+class RenderContext
+{
+public:
+    RenderContext();
+
+    //! タイルの描画を始める
+    //! 乱数のシードとサンプル番号の先頭を設定し、
+    //! 呼び出し元スレッドのレイ統計に結び付ける
+    //! @param seed 乱数のシード(フレームごとのシード)
+    //! @param sampleBegin 描画するサンプル番号の先頭
+    //! (分散レンダリングや再開で、続きのサンプルを描画するためのもの)
+    void
+    BeginTile(uint32_t seed, int sampleBegin = 0);
+
+    //! 画素のサンプルの描画を始める
+    //! 乱数列を (シード, 画素, サンプル番号) から決めるので、
+    //! 画像はスレッド数、タイルの大きさ、描画順によらず同じになる
+    //! @param sampleIndex BeginTile() の sampleBegin からのサンプル番号
+    void
+    BeginSample(int pixelX, int pixelY, int sampleIndex);
+
+    //! 乱数の状態を取得する
+    SamplerState
+    GetSamplerState() const
+    {
+        return { m_sampleKey,
+                 m_sampler1D.GetDimension(),
+                 m_sampler2D.GetDimension() };
+    }
+
+    //! 乱数の状態を復元する
+    void
+    SetSamplerState(const SamplerState& state)
+    {
+        m_sampleKey = state.key;
+        m_sampler1D = RandomSampler1D(state.key, state.dimension1D);
+        m_sampler2D = RandomSampler2D(state.key, state.dimension2D);
+    }
+
+    RandomSampler1D&
+    GetSampler1D()
+    {
+        return m_sampler1D;
+    }
+
+    RandomSampler2D&
+    GetSampler2D()
+    {
+        return m_sampler2D;
+    }
+
+    TraversalStack&
+    GetTraversalStack()
+    {
+        return m_traversalStack;
+    }
+
+    //! 結び付けたスレッドのレイ統計
+    RayStatistics&
+    GetRayStatistics()
+    {
+        return *m_rayStatistics;
+    }
+
+    //! 呼び出し元スレッドの作業領域を取得
+    //! RenderContext を持たない呼び出し元(AOV等)のためのもの
+    static RenderContext&
+    GetThreadLocal();
+
+private:
+    uint32_t m_seed = 0;
+    int m_sampleBegin = 0;
+    uint64_t m_sampleKey = 0;
+    RandomSampler1D m_sampler1D;
+    RandomSampler2D m_sampler2D;
+    TraversalStack m_traversalStack;
+    RayStatistics* m_rayStatistics = nullptr;
+};
+
+} // namespace Core
+} // namespace Petrichor
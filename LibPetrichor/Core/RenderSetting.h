@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Core/Thread/ThreadAffinity.h"
+#include <cstdint>
 #include <fmt/format.h>
 
 namespace Petrichor
@@ -7,6 +9,27 @@ namespace Petrichor
 namespace Core
 {
 
+//! レンダリングに使うインテグレータ
+enum class IntegratorTypes
+{
+    SimplePathTracing,    //!< 画素ごとに深さ優先で追跡する
+    WavefrontPathTracing, //!< タイル内のパスをステージごとにまとめて処理する
+};
+
+//! 設定ファイルで用いるインテグレータ名
+inline const char*
+GetIntegratorName(IntegratorTypes integrator)
+{
+    switch (integrator)
+    {
+    case IntegratorTypes::WavefrontPathTracing:
+        return "wavefront";
+    case IntegratorTypes::SimplePathTracing:
+    default:
+        return "simple";
+    }
+}
+
 struct RenderSetting
 {
     int outputWidth = 1280;       //!< 出力画像幅[px]
@@ -19,6 +42,61 @@ struct RenderSetting
 
     //! number of render threads (0: use max number of threads)
     int numThreads = 0;
+
+    //! how render threads are pinned to CPUs (Linux only)
+    //! workers are spread over NUMA nodes in proportion to their CPUs,
+    //! using separate physical cores before SMT siblings
+    ThreadAffinityTypes threadAffinity = ThreadAffinityTypes::None;
+
+    //! copy the BVH, material textures and environment map to each NUMA node
+    //! (used only when threadAffinity is not none)
+    bool numaReplication = false;
+
+    //! maximum number of diffuse bounces in a path
+    int numMaxDiffuseBounces = 16;
+
+    //! maximum number of glossy bounces in a path
+    int numMaxGlossyBounces = 16;
+
+    //! maximum number of transmission (refraction) bounces in a path
+    int numMaxTransmissionBounces = 16;
+
+    //! number of bounces before Russian roulette starts
+    int russianRouletteStartBounce = 3;
+
+    //! lower limit of the Russian roulette survival probability
+    float russianRouletteMinProbability = 0.05f;
+
+    //! integrator used for the beauty pass
+    IntegratorTypes integrator = IntegratorTypes::SimplePathTracing;
+
+    //! reorder secondary rays by direction and origin before intersection
+    //! (wavefront integrator only)
+    bool sortRays = false;
+
+    //! build BVH with spatial splits (SBVH)
+    bool useSpatialSplit = false;
+
+    //! upper limit of references duplicated by spatial splits
+    //! (ratio to the number of primitives)
+    float spatialSplitBudget = 0.5f;
+
+    //! number of bins used to find the best BVH split
+    int bvhNumBins = 16;
+
+    //! BVH node traversal cost relative to a primitive intersection
+    float bvhTraversalCost = 1.0f;
+
+    //! maximum number of primitives in a BVH leaf
+    //! (larger leaves are made only when the node cannot be split)
+    int bvhMaxLeafSize = 4;
+
+    //! maximum depth of BVH
+    int bvhMaxDepth = 64;
+
+    //! seed of random numbers
+    //! (the same seed gives identical images for any thread count or tile size)
+    uint32_t seed = 0;
 };
 
 } // namespace Core
@@ -46,7 +124,23 @@ struct fmt::formatter<Petrichor::Core::RenderSetting>
                          "NumMaxBounces: {}\n"
                          "TileWidth: {}\n"
                          "TileHeight: {}\n"
-                         "NumThreads: {}\n",
+                         "NumThreads: {}\n"
+                         "ThreadAffinity: {}\n"
+                         "NUMAReplication: {}\n"
+                         "NumMaxDiffuseBounces: {}\n"
+                         "NumMaxGlossyBounces: {}\n"
+                         "NumMaxTransmissionBounces: {}\n"
+                         "RussianRouletteStartBounce: {}\n"
+                         "RussianRouletteMinProbability: {}\n"
+                         "Integrator: {}\n"
+                         "SortRays: {}\n"
+                         "UseSpatialSplit: {}\n"
+                         "SpatialSplitBudget: {}\n"
+                         "BVHNumBins: {}\n"
+                         "BVHTraversalCost: {}\n"
+                         "BVHMaxLeafSize: {}\n"
+                         "BVHMaxDepth: {}\n"
+                         "Seed: {}\n",
                          input.outputWidth,
                          input.outputHeight,
                          input.numSamplesPerPixel,
@@ -54,6 +148,23 @@ struct fmt::formatter<Petrichor::Core::RenderSetting>
                          input.numMaxBounces,
                          input.tileWidth,
                          input.tileHeight,
-                         input.numThreads);
+                         input.numThreads,
+                         Petrichor::Core::GetThreadAffinityName(
+                           input.threadAffinity),
+                         input.numaReplication,
+                         input.numMaxDiffuseBounces,
+                         input.numMaxGlossyBounces,
+                         input.numMaxTransmissionBounces,
+                         input.russianRouletteStartBounce,
+                         input.russianRouletteMinProbability,
+                         Petrichor::Core::GetIntegratorName(input.integrator),
+                         input.sortRays,
+                         input.useSpatialSplit,
+                         input.spatialSplitBudget,
+                         input.bvhNumBins,
+                         input.bvhTraversalCost,
+                         input.bvhMaxLeafSize,
+                         input.bvhMaxDepth,
+                         input.seed);
     }
 };
@@ -46,6 +46,18 @@ RenderSettingLoaderJson::Load(const std::filesystem::path& path)
         Logger::Error("RenderSetting: key is not found. [{}]", key);
     };
 
+    // 省略可能な設定(キーが無い場合はデフォルト値のまま)
+    auto readOptionalValue =
+      [](auto* result, const std::string& key, const Json& json) -> void {
+        using ValueType = typename std::remove_pointer<decltype(result)>::type;
+
+        const auto iter = json.find(key);
+        if (iter != json.cend())
+        {
+            *result = static_cast<ValueType>(*iter);
+        }
+    };
+
     readValueIfKeyExists(
       &renderSetting.outputWidth, "outputWidth", renderSettingJson);
     readValueIfKeyExists(
@@ -63,6 +75,73 @@ RenderSettingLoaderJson::Load(const std::filesystem::path& path)
     readValueIfKeyExists(
       &renderSetting.numThreads, "numThreads", renderSettingJson);
 
+    readOptionalValue(&renderSetting.numMaxDiffuseBounces,
+                      "maxDiffuseBounces",
+                      renderSettingJson);
+    readOptionalValue(&renderSetting.numMaxGlossyBounces,
+                      "maxGlossyBounces",
+                      renderSettingJson);
+    readOptionalValue(&renderSetting.numMaxTransmissionBounces,
+                      "maxTransmissionBounces",
+                      renderSettingJson);
+    readOptionalValue(&renderSetting.russianRouletteStartBounce,
+                      "russianRouletteStartBounce",
+                      renderSettingJson);
+    readOptionalValue(&renderSetting.russianRouletteMinProbability,
+                      "russianRouletteMinProbability",
+                      renderSettingJson);
+
+    {
+        std::string integratorName;
+        readOptionalValue(&integratorName, "integrator", renderSettingJson);
+        if (integratorName == "wavefront")
+        {
+            renderSetting.integrator = IntegratorTypes::WavefrontPathTracing;
+        }
+        else if (!integratorName.empty() && integratorName != "simple")
+        {
+            Logger::Error("RenderSetting: unknown integrator. [{}]",
+                          integratorName);
+        }
+    }
+
+    {
+        std::string threadAffinityName;
+        readOptionalValue(
+          &threadAffinityName, "threadAffinity", renderSettingJson);
+        if (threadAffinityName == "core")
+        {
+            renderSetting.threadAffinity = ThreadAffinityTypes::Core;
+        }
+        else if (threadAffinityName == "node")
+        {
+            renderSetting.threadAffinity = ThreadAffinityTypes::Node;
+        }
+        else if (!threadAffinityName.empty() && threadAffinityName != "none")
+        {
+            Logger::Error("RenderSetting: unknown thread affinity. [{}]",
+                          threadAffinityName);
+        }
+    }
+    readOptionalValue(
+      &renderSetting.numaReplication, "numaReplication", renderSettingJson);
+
+    readOptionalValue(&renderSetting.sortRays, "sortRays", renderSettingJson);
+    readOptionalValue(
+      &renderSetting.useSpatialSplit, "bvhSpatialSplit", renderSettingJson);
+    readOptionalValue(&renderSetting.spatialSplitBudget,
+                      "bvhSpatialSplitBudget",
+                      renderSettingJson);
+    readOptionalValue(
+      &renderSetting.bvhNumBins, "bvhNumBins", renderSettingJson);
+    readOptionalValue(
+      &renderSetting.bvhTraversalCost, "bvhTraversalCost", renderSettingJson);
+    readOptionalValue(
+      &renderSetting.bvhMaxLeafSize, "bvhMaxLeafSize", renderSettingJson);
+    readOptionalValue(
+      &renderSetting.bvhMaxDepth, "bvhMaxDepth", renderSettingJson);
+    readOptionalValue(&renderSetting.seed, "seed", renderSettingJson);
+
     return renderSetting;
 }
 
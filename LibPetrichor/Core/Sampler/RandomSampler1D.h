@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include "ISampler1D.h"
-#include "Random/XorShift.h"
+#include "Random/CounterBasedRandom.h"
 
 namespace Petrichor
 {
@@ -11,17 +11,28 @@ namespace Core
 class RandomSampler1D : public ISampler1D
 {
 public:
-    explicit RandomSampler1D(unsigned seed)
-      : m_xorShift(seed){};
+    RandomSampler1D() = default;
+
+    //! @param key 乱数列のキー
+    //! @param dimension 乱数列の何番目から引くか
+    explicit RandomSampler1D(uint64_t key, uint32_t dimension = 0)
+      : m_random(key, dimension){};
 
     float
     Next() final
     {
-        return m_xorShift.next();
+        return m_random.next();
+    }
+
+    //! これまでに引いた乱数の個数
+    uint32_t
+    GetDimension() const
+    {
+        return m_random.GetCounter();
     }
 
 private:
-    Math::XorShift128 m_xorShift;
+    Math::CounterBasedRandom m_random;
 };
 
 } // namespace Core
@@ -5,9 +5,8 @@ namespace Petrichor
 namespace Core
 {
 
-RandomSampler2D::RandomSampler2D(unsigned seed0, unsigned seed1)
-  : m_xorShift0(seed0)
-  , m_xorShift1(seed1)
+RandomSampler2D::RandomSampler2D(uint64_t key, uint32_t dimension)
+  : m_random(Math::CounterBasedRandom::Hash(key), 2 * dimension)
 {
     // Do nothing
 }
@@ -15,8 +14,8 @@ RandomSampler2D::RandomSampler2D(unsigned seed0, unsigned seed1)
 std::tuple<float, float>
 RandomSampler2D::Next()
 {
-    float x = m_xorShift0.next();
-    float y = m_xorShift1.next();
+    float x = m_random.next();
+    float y = m_random.next();
     return std::tuple<float, float>(x, y);
 }
 
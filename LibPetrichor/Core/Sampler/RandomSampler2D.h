@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include "ISampler2D.h"
-#include "Random/XorShift.h"
+#include "Random/CounterBasedRandom.h"
 
 namespace Petrichor
 {
@@ -11,14 +11,24 @@ namespace Core
 class RandomSampler2D : public ISampler2D
 {
 public:
-    explicit RandomSampler2D(unsigned seed0, unsigned seed1);
+    RandomSampler2D() = default;
+
+    //! @param key 乱数列のキー(同じキーの RandomSampler1D とは別の乱数列になる)
+    //! @param dimension 何組目の乱数から引くか
+    explicit RandomSampler2D(uint64_t key, uint32_t dimension = 0);
 
     std::tuple<float, float>
     Next() final;
 
+    //! これまでに引いた乱数の組の個数
+    uint32_t
+    GetDimension() const
+    {
+        return m_random.GetCounter() / 2;
+    }
+
 private:
-    Math::XorShift128 m_xorShift0;
-    Math::XorShift128 m_xorShift1;
+    Math::CounterBasedRandom m_random;
 };
 
 } // namespace Core
@@ -1,14 +1,121 @@
 #include "Scene.h"
 #include "Core/Logger.h"
 #include "Core/RenderSettingLoader.h"
-#include "Material/Lambert.h"
+#include "Core/Thread/CpuTopology.h"
 #include "SceneLoader.h"
+#include <atomic>
 #include <memory>
+#include <unordered_map>
 
 namespace Petrichor
 {
 namespace Core
 {
+uint64_t
+Scene::NextGeometryGeneration()
+{
+    // シーンの破棄後に同じアドレスに作られたシーンとも区別できるよう、
+    // 全てのシーンで共有するカウンタから発行する
+    static std::atomic<uint64_t> s_generation = 0;
+    return ++s_generation;
+}
+
+void
+Scene::Finalize()
+{
+    std::vector<const MaterialBase*> materials;
+    materials.reserve(m_geometries.size());
+    for (const GeometryBase* geometry : m_geometries)
+    {
+        materials.emplace_back(geometry->GetAssignedMaterial());
+    }
+
+    m_materialTable.Build(materials);
+
+    m_geometryMaterialIds.resize(m_geometries.size());
+    for (size_t geometryIndex = 0; geometryIndex < m_geometries.size();
+         geometryIndex++)
+    {
+        m_geometryMaterialIds[geometryIndex] =
+          m_materialTable.FindMaterialId(materials[geometryIndex]);
+    }
+
+    m_isFinalized = true;
+
+    Logger::Info("Number of materials: {}", m_materialTable.GetNumMaterials());
+
+    ReplicateToNodes();
+}
+
+void
+Scene::ReplicateToNodes()
+{
+    m_nodeReplicas.clear();
+
+    if (!m_renderSetting.numaReplication)
+    {
+        return;
+    }
+
+    // ワーカースレッドがノードに固定されていなければ、複製を引けない
+    if (m_renderSetting.threadAffinity == ThreadAffinityTypes::None)
+    {
+        Logger::Info("NUMA replication is skipped because threadAffinity is "
+                     "none.");
+        return;
+    }
+
+    const CpuTopology& topology = CpuTopology::Get();
+    if (topology.GetNumNodes() < 2)
+    {
+        return;
+    }
+
+    m_nodeReplicas.resize(topology.GetNumNodes());
+    size_t numTextures = 0;
+    for (int nodeIndex = 0; nodeIndex < topology.GetNumNodes(); nodeIndex++)
+    {
+        topology.RunOnNode(nodeIndex, [&] {
+            auto replica = std::make_unique<NodeReplica>();
+
+            // 複数のマテリアルから参照されるテクスチャは1度だけ複製する
+            std::unordered_map<const Texture2D*, const Texture2D*> replicated;
+            replica->materialTable = m_materialTable;
+            replica->materialTable.ReplaceTextures(
+              [&](const Texture2D* texture) {
+                  auto [iter, isInserted] =
+                    replicated.emplace(texture, nullptr);
+                  if (isInserted)
+                  {
+                      iter->second = &replica->textures.emplace_back(*texture);
+                  }
+                  return iter->second;
+              });
+            replica->environment = m_environment;
+
+            numTextures = replica->textures.size();
+            m_nodeReplicas[nodeIndex] = std::move(replica);
+        });
+    }
+
+    Logger::Info("Replicated materials, {} textures and the environment to {} "
+                 "NUMA nodes.",
+                 numTextures,
+                 m_nodeReplicas.size());
+}
+
+void
+Scene::ReplicateEnvironment()
+{
+    const CpuTopology& topology = CpuTopology::Get();
+    for (size_t nodeIndex = 0; nodeIndex < m_nodeReplicas.size(); nodeIndex++)
+    {
+        topology.RunOnNode(static_cast<int>(nodeIndex), [&] {
+            m_nodeReplicas[nodeIndex]->environment = m_environment;
+        });
+    }
+}
+
 void
 Scene::LoadRenderSetting(const std::filesystem::path& path)
 {
@@ -28,10 +135,8 @@ Scene::LoadRenderSetting(const std::filesystem::path& path)
 void
 Scene::LoadModel(const std::filesystem::path& path)
 {
-    // #TODO: 生newやめる
-    auto const mesh = new Mesh();
+    Mesh* const mesh = CreateResource<Mesh>();
 
-    auto const lambert = new Lambert(Color3f::One());
     const auto* defaultMat = GetMaterial("default");
     ASSERT(defaultMat);
     mesh->Load(path, defaultMat, ShadingTypes::Smooth);
@@ -42,8 +147,7 @@ void
 Scene::LoadModel(const std::filesystem::path& path,
                  std::string_view materialName)
 {
-    // #TODO: 生newやめる
-    auto const mesh = new Mesh();
+    Mesh* const mesh = CreateResource<Mesh>();
 
     const auto* material = GetMaterial(materialName);
     ASSERT(material && "Material not found.");
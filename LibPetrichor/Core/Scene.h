@@ -8,8 +8,14 @@
 #include "Core/Geometry/GeometryBase.h"
 #include "Core/Geometry/Mesh.h"
 #include "Core/Material/MaterialBase.h"
+#include "Core/Material/MaterialTable.h"
+#include "Core/Memory/ArenaAllocator.h"
 #include "Core/RenderSetting.h"
+#include "Core/SceneAnimation.h"
+#include "Core/Thread/ThreadPool.h"
+#include <deque>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string_view>
 #include <unordered_map>
@@ -28,12 +34,6 @@ struct TextureHandle
 
 class Scene
 {
-private:
-    //! メモリ再配置によって他から参照されているリソースへのポインタが無効になることを防ぐ。
-    // #TODO: 設計がひどすぎるので、ハンドルかなにかで管理する形に変更する
-    static constexpr size_t kNumMaxMaterials = 128;
-    static constexpr size_t kNumMaxTextures = 128;
-
 public:
     //! パスの種類
     struct AOVType
@@ -44,16 +44,22 @@ public:
             UV,              //!< UV coordinates
             DenoisingAlbedo, //!< Albedo for denoising
             DenoisingNormal, //!< Normal for denoising
+            TraversalCost,   //!< Heatmap of ray traversal cost
 
             NumAOVTypes
         };
     };
 
 public:
-    Scene()
+    Scene() = default;
+
+    //! シーンと同じ寿命のリソース(メッシュ、マテリアル、テクスチャ等)を生成する
+    //! 生成したリソースはシーンの破棄時にまとめて解放される
+    template<typename T, typename... Args>
+    T*
+    CreateResource(Args&&... args)
     {
-        m_textures.reserve(kNumMaxTextures);
-        m_materials.reserve(kNumMaxMaterials);
+        return m_arena.New<T>(std::forward<Args>(args)...);
     }
 
     // シーンにジオメトリを追加
@@ -61,6 +67,8 @@ public:
     AppendGeometry(const GeometryBase* geometry)
     {
         m_geometries.emplace_back(geometry);
+        m_isFinalized = false;
+        m_geometryGeneration = NextGeometryGeneration();
     }
 
     // シーンに頂点を追加
@@ -98,6 +106,14 @@ public:
         return m_geometries;
     }
 
+    //! ジオメトリの世代番号を取得
+    //! ジオメトリを追加するたびに変わり、他のシーンの値とも重複しない
+    uint64_t
+    GetGeometryGeneration() const
+    {
+        return m_geometryGeneration;
+    }
+
     // ライトのリストを取得
     const std::vector<const GeometryBase*>&
     GetLights() const
@@ -112,19 +128,62 @@ public:
         return m_mainCamera.get();
     }
 
-    //! シーンにマテリアルを登録
+    //! シーンを確定し、レンダリング用のデータを構築する
+    //! ジオメトリから参照されるマテリアルを MaterialTable にまとめる。
+    //! ジオメトリを追加した後、レンダリングの前に呼ぶこと
     void
-    RegisterMaterial(std::string_view materialName,
-                     std::unique_ptr<const MaterialBase> material)
+    Finalize();
+
+    //! Finalize() 後にジオメトリが追加されていなければ true
+    bool
+    IsFinalized() const
+    {
+        return m_isFinalized;
+    }
+
+    //! マテリアルと環境マップを NUMA ノードごとに複製したか
+    bool
+    IsReplicatedToNodes() const
     {
-        m_materials[std::string(materialName)] = std::move(material);
+        return !m_nodeReplicas.empty();
+    }
+
+    //! レンダリング用のマテリアルのテーブルを取得
+    //! NUMA ノードに固定したワーカースレッドからは、そのノードの複製を返す
+    const MaterialTable&
+    GetMaterialTable() const
+    {
+        ASSERT(m_isFinalized);
+        const NodeReplica* replica = FindNodeReplica();
+        return replica ? replica->materialTable : m_materialTable;
+    }
+
+    //! 衝突したジオメトリのマテリアル番号を取得
+    //! (MixMaterial は解決されていない)
+    MaterialId
+    GetMaterialId(const HitInfo& hitInfo) const
+    {
+        ASSERT(hitInfo.geometryIndex < m_geometryMaterialIds.size());
+        return m_geometryMaterialIds[hitInfo.geometryIndex];
+    }
+
+    //! マテリアルを生成し、名前を付けてシーンに登録する
+    //! 同じ名前のマテリアルがあれば置き換える
+    template<typename T, typename... Args>
+    T*
+    CreateMaterial(std::string_view materialName, Args&&... args)
+    {
+        T* const material = CreateResource<T>(std::forward<Args>(args)...);
+        m_materials[std::string(materialName)] = material;
+        return material;
     }
 
     //! シーンに登録されたマテリアルを取得
     const MaterialBase*
-    GetMaterial(std::string_view materialName)
+    GetMaterial(std::string_view materialName) const
     {
-        return m_materials[std::string(materialName)].get();
+        const auto iter = m_materials.find(std::string(materialName));
+        return iter != m_materials.end() ? iter->second : nullptr;
     }
 
     //! シーンにテクスチャを登録
@@ -134,7 +193,8 @@ public:
     {
         if (m_textures.find(filePath.string()) == m_textures.end())
         {
-            m_textures[filePath.string()] = texture2D;
+            m_textures[filePath.string()] =
+              CreateResource<Texture2D>(texture2D);
         }
 
         TextureHandle textureHandle;
@@ -142,19 +202,28 @@ public:
         return textureHandle;
     }
 
-    //! シーンに登録してあるテクスチャを取得
-    const Texture2D*
-    GetTexture(const TextureHandle& textureHandle)
+    //! シーンにテクスチャを登録(ムーブ版)
+    TextureHandle
+    RegisterTexture(const std::filesystem::path& filePath,
+                    Texture2D&& texture2D)
     {
-
-        if (m_textures.find(textureHandle.filePath) != m_textures.end())
-        {
-            return &m_textures[textureHandle.filePath];
-        }
-        else
+        if (m_textures.find(filePath.string()) == m_textures.end())
         {
-            return nullptr;
+            m_textures[filePath.string()] =
+              CreateResource<Texture2D>(std::move(texture2D));
         }
+
+        TextureHandle textureHandle;
+        textureHandle.filePath = filePath.string();
+        return textureHandle;
+    }
+
+    //! シーンに登録してあるテクスチャを取得
+    const Texture2D*
+    GetTexture(const TextureHandle& textureHandle) const
+    {
+        const auto iter = m_textures.find(textureHandle.filePath);
+        return iter != m_textures.end() ? iter->second : nullptr;
     }
 
     // メインカメラを登録
@@ -166,10 +235,12 @@ public:
     }
 
     // Environmentを取得
+    //! NUMA ノードに固定したワーカースレッドからは、そのノードの複製を返す
     const Environment&
     GetEnvironment() const
     {
-        return m_environment;
+        const NodeReplica* replica = FindNodeReplica();
+        return replica ? replica->environment : m_environment;
     }
 
     //! 環境マップを設定
@@ -177,6 +248,47 @@ public:
     SetEnvironment(const Environment& environment)
     {
         m_environment = environment;
+        ReplicateEnvironment();
+    }
+
+    //! 環境マップを設定(ムーブ版)
+    void
+    SetEnvironment(Environment&& environment)
+    {
+        m_environment = std::move(environment);
+        ReplicateEnvironment();
+    }
+
+    //! アニメーションを取得
+    const SceneAnimation&
+    GetAnimation() const
+    {
+        return m_animation;
+    }
+
+    //! アニメーションを設定
+    void
+    SetAnimation(const SceneAnimation& animation)
+    {
+        m_animation = animation;
+    }
+
+    //! カメラと環境マップをフレームの状態にする
+    //! アニメーションがなければ何もしない。ジオメトリは変わらないので
+    //! Finalize() し直す必要はない
+    void
+    SetFrame(int frame)
+    {
+        if (m_mainCamera)
+        {
+            m_animation.Apply(frame, m_mainCamera.get(), &m_environment);
+        }
+
+        for (const std::unique_ptr<NodeReplica>& replica : m_nodeReplicas)
+        {
+            replica->environment.SetZAxisRotation(
+              m_environment.GetZAxisRotation());
+        }
     }
 
     // レンダリング先のテクスチャを設定
@@ -217,25 +329,87 @@ public:
         return m_renderSetting;
     }
 
+    //! レンダリング設定を上書きする
+    void
+    SetRenderSetting(const RenderSetting& renderSetting)
+    {
+        m_renderSetting = renderSetting;
+    }
+
 private:
+    //! NUMA ノードに複製した、レンダリング中に読むデータ
+    struct NodeReplica
+    {
+        //! マテリアルが参照するテクスチャの複製(要素のアドレスは変わらない)
+        std::deque<Texture2D> textures;
+
+        MaterialTable materialTable;
+        Environment environment;
+    };
+
+    //! 呼び出し元のワーカースレッドのノードの複製(なければ nullptr)
+    const NodeReplica*
+    FindNodeReplica() const
+    {
+        const int nodeIndex = ThreadPool::GetCurrentNodeIndex();
+        return 0 <= nodeIndex &&
+                   nodeIndex < static_cast<int>(m_nodeReplicas.size())
+                 ? m_nodeReplicas[nodeIndex].get()
+                 : nullptr;
+    }
+
+    //! 設定に応じて、マテリアルと環境マップを NUMA ノードごとに複製する
+    //! ワーカースレッドがノードに固定されない設定では複製しない
+    void
+    ReplicateToNodes();
+
+    //! 全てのシーンで重複しない、新しいジオメトリの世代番号を発行する
+    static uint64_t
+    NextGeometryGeneration();
+
+    //! 複製済みの環境マップを作り直す
+    void
+    ReplicateEnvironment();
+
+    //! メッシュ、マテリアル、テクスチャなどのリソースの実体
+    //! 他のメンバから参照されるので最初に宣言し、最後に破棄されるようにする
+    ArenaAllocator m_arena;
+
     //! シーンに登録されたオブジェクト
     std::vector<const GeometryBase*> m_geometries;
 
     //! シーンに登録されたライト
     std::vector<const GeometryBase*> m_lights;
 
-    //! シーンで使用するマテリアル
-    // #TODO:
-    // 時間ないのでひとまずこのまま。後でマテリアルの実態には、局所性を持たせたい。
-    std::unordered_map<std::string, std::unique_ptr<const MaterialBase>>
-      m_materials;
+    //! シーンで使用するマテリアル(名前での参照用)
+    //! レンダリング中は Finalize() で構築した m_materialTable を使う
+    std::unordered_map<std::string, const MaterialBase*> m_materials;
+
+    //! レンダリング用のマテリアルのテーブル
+    MaterialTable m_materialTable;
+
+    //! ジオメトリごとのマテリアル番号(m_geometries と同じ順)
+    std::vector<MaterialId> m_geometryMaterialIds;
+
+    //! Finalize() 後にジオメトリが追加されていなければ true
+    bool m_isFinalized = false;
+
+    //! ジオメトリの世代番号(ジオメトリを追加するたびに更新する)
+    uint64_t m_geometryGeneration = NextGeometryGeneration();
 
     //! レンダリングで使用するテクスチャ
-    std::unordered_map<std::string, Texture2D> m_textures{};
+    std::unordered_map<std::string, const Texture2D*> m_textures;
 
     //! 環境マップ
     Environment m_environment;
 
+    //! フレームごとのカメラと環境マップ
+    SceneAnimation m_animation;
+
+    //! NUMA ノードごとの複製(複製しない場合は空)
+    //! ノードに固定したスレッドで書き込み、ページをそのノードに置く
+    std::vector<std::unique_ptr<NodeReplica>> m_nodeReplicas;
+
     //! メインカメラ
     std::unique_ptr<Camera> m_mainCamera = nullptr;
 
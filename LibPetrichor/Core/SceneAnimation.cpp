@@ -0,0 +1,108 @@
+#include "SceneAnimation.h"
+
+#include "Core/Camera.h"
+#include "Core/Environment.h"
+#include <algorithm>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+void
+SceneAnimation::AddKey(const Key& key)
+{
+    const auto iter = std::lower_bound(
+      m_keys.begin(), m_keys.end(), key, [](const Key& lhs, const Key& rhs) {
+          return lhs.frame < rhs.frame;
+      });
+
+    if (iter != m_keys.end() && iter->frame == key.frame)
+    {
+        *iter = key;
+    }
+    else
+    {
+        m_keys.insert(iter, key);
+    }
+}
+
+int
+SceneAnimation::GetFirstFrame() const
+{
+    return m_keys.empty() ? 0 : m_keys.front().frame;
+}
+
+int
+SceneAnimation::GetLastFrame() const
+{
+    return m_keys.empty() ? 0 : m_keys.back().frame;
+}
+
+SceneAnimation::Key
+SceneAnimation::Evaluate(int frame) const
+{
+    if (m_keys.empty())
+    {
+        return Key();
+    }
+
+    if (frame <= m_keys.front().frame)
+    {
+        return m_keys.front();
+    }
+
+    if (frame >= m_keys.back().frame)
+    {
+        return m_keys.back();
+    }
+
+    // frame を挟むキーフレームの間を補間する
+    const auto next = std::upper_bound(
+      m_keys.begin(), m_keys.end(), frame, [](int frame_, const Key& key) {
+          return frame_ < key.frame;
+      });
+    const Key& k0 = *(next - 1);
+    const Key& k1 = *next;
+
+    const float t =
+      static_cast<float>(frame - k0.frame) / (k1.frame - k0.frame);
+    const auto lerp = [t](const auto& v0, const auto& v1) {
+        return v0 + (v1 - v0) * t;
+    };
+
+    Key key;
+    key.frame = frame;
+    key.position = lerp(k0.position, k1.position);
+    key.lookAt = lerp(k0.lookAt, k1.lookAt);
+    key.focusPos = lerp(k0.focusPos, k1.focusPos);
+    key.fNumber = lerp(k0.fNumber, k1.fNumber);
+    key.focalLength = lerp(k0.focalLength, k1.focalLength);
+    key.envRotation = lerp(k0.envRotation, k1.envRotation);
+    return key;
+}
+
+void
+SceneAnimation::Apply(int frame, Camera* camera, Environment* environment) const
+{
+    if (m_keys.empty())
+    {
+        return;
+    }
+
+    const Key key = Evaluate(frame);
+
+    // 前のフレームの状態が残らないよう、SceneLoaderJson と同じく
+    // 既定のカメラから同じ順に設定する(F値はその時点の焦点距離に依存する)
+    *camera = Camera();
+    camera->SetPosition(key.position);
+    camera->LookAt(key.lookAt);
+    camera->FocusTo(key.focusPos);
+    camera->SetFNumber(key.fNumber);
+    camera->SetFocalLength(key.focalLength);
+
+    environment->SetZAxisRotation(key.envRotation);
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Math/Vector3f.h"
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+class Camera;
+class Environment;
+
+//! フレームごとに変わるシーンの状態
+//! キーフレームの間は線形補間し、範囲外では端のキーフレームを使う。
+//! ジオメトリは動かさないので、BVH はフレーム間で使い回せる
+class SceneAnimation
+{
+public:
+    //! キーフレーム
+    struct Key
+    {
+        int frame = 0;
+
+        // カメラ
+        Math::Vector3f position;
+        Math::Vector3f lookAt;
+        Math::Vector3f focusPos;
+        float fNumber = 2.8f;
+        float focalLength = 55e-3f;
+
+        //! 環境マップの Z 軸周りの回転[rad]
+        float envRotation = 0.0f;
+    };
+
+    //! キーフレームを追加する(同じフレームのキーがあれば置き換える)
+    void
+    AddKey(const Key& key);
+
+    //! キーフレームがないか
+    bool
+    IsEmpty() const
+    {
+        return m_keys.empty();
+    }
+
+    //! 最初のキーフレームのフレーム番号
+    int
+    GetFirstFrame() const;
+
+    //! 最後のキーフレームのフレーム番号
+    int
+    GetLastFrame() const;
+
+    //! フレームの状態を補間して求める
+    Key
+    Evaluate(int frame) const;
+
+    //! フレームの状態をカメラと環境マップに設定する
+    void
+    Apply(int frame, Camera* camera, Environment* environment) const;
+
+private:
+    //! フレーム番号の昇順
+    std::vector<Key> m_keys;
+};
+
+} // namespace Core
+} // namespace Petrichor
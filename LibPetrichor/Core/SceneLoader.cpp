@@ -5,10 +5,15 @@
 #include "Core/Material/Glass.h"
 #include "Core/Material/Lambert.h"
 #include "Core/Material/MixMaterial.h"
+#include "Core/Thread/ThreadPool.h"
+#include "Profiler/Profiler.h"
 #include "fmt/format.h"
 #include "nlohmann/json.hpp"
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace Petrichor
 {
@@ -17,6 +22,8 @@ namespace Core
 void
 SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
 {
+    PROFILE_SCOPE("SceneLoaderJson::Load");
+
     const nlohmann::json loadedJson = [&]() {
         std::ifstream file(path, std::ios::in);
         if (file.fail())
@@ -78,12 +85,56 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
         }
     };
 
+    // 読み込みはスレッドプールで並列に行う。
+    // シーンへの登録は全タスクの完了後にJSONの記述順で行い、
+    // ジオメトリの順序を実行ごとに変えない。
+    const uint32_t numThreads = scene.GetRenderSetting().numThreads;
+
+    //! 並列読み込みするテクスチャ
+    struct TextureLoadTask
+    {
+        std::filesystem::path path;
+        Texture2D::TextureColorType colorType;
+        Texture2D texture;
+        bool isLoaded = false;
+    };
+    std::vector<std::unique_ptr<TextureLoadTask>> textureLoadTasks;
+
+    //! 読み込み完了後にマテリアルへテクスチャを設定する処理
+    std::vector<std::pair<size_t, std::function<void(const Texture2D*)>>>
+      textureBindings;
+
+    auto requestTexture =
+      [&](const std::filesystem::path& texturePath,
+          Texture2D::TextureColorType colorType,
+          std::function<void(const Texture2D*)> bindTexture) {
+          const auto iter =
+            std::find_if(textureLoadTasks.cbegin(),
+                         textureLoadTasks.cend(),
+                         [&](const auto& task) {
+                             return task->path == texturePath;
+                         });
+
+          size_t taskIndex = 0;
+          if (iter == textureLoadTasks.cend())
+          {
+              auto task = std::make_unique<TextureLoadTask>();
+              task->path = texturePath;
+              task->colorType = colorType;
+              textureLoadTasks.emplace_back(std::move(task));
+              taskIndex = textureLoadTasks.size() - 1;
+          }
+          else
+          {
+              taskIndex = std::distance(textureLoadTasks.cbegin(), iter);
+          }
+
+          textureBindings.emplace_back(taskIndex, std::move(bindTexture));
+      };
+
     // ---- Material ----
     {
-        {
-            auto defaultMat = std::make_unique<Lambert>(Color3f::One());
-            scene.RegisterMaterial("default", std::move(defaultMat));
-        }
+        scene.CreateMaterial<Lambert>("default", Color3f::One());
 
         auto materials = loadedJson["materials"];
         for (const auto& material : materials)
@@ -106,29 +157,21 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
             if (materialType == "lambert")
             {
                 const auto baseColor = loadVector3f(material, "base_color");
-                auto lambertMat = std::make_unique<Lambert>(baseColor);
+                Lambert* const lambertMat =
+                  scene.CreateMaterial<Lambert>(materialName, baseColor);
 
                 std::string colorTexturePathString;
                 loadValue(&colorTexturePathString, material, "color_tex");
 
                 if (!colorTexturePathString.empty())
                 {
-                    std::filesystem::path colorTexturePath =
-                      path.parent_path() / colorTexturePathString;
-
-                    Texture2D colorTex;
-                    if (colorTex.Load(colorTexturePath,
-                                      Texture2D::TextureColorType::Color))
-                    {
-                        const TextureHandle colorTexHandle =
-                          scene.RegisterTexture(colorTexturePath, colorTex);
-
-                        lambertMat->SetTexAlbedo(
-                          scene.GetTexture(colorTexHandle));
-                    }
+                    requestTexture(
+                      path.parent_path() / colorTexturePathString,
+                      Texture2D::TextureColorType::Color,
+                      [lambertMat](const Texture2D* texture) {
+                          lambertMat->SetTexAlbedo(texture);
+                      });
                 }
-
-                scene.RegisterMaterial(materialName, std::move(lambertMat));
             }
             else if (materialType == "glass")
             {
@@ -137,9 +180,7 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
                 float ior = 1.0f;
                 loadValue(&ior, material, "ior");
 
-                auto glassMat = std::make_unique<Glass>(color, ior);
-
-                scene.RegisterMaterial(materialName, std::move(glassMat));
+                scene.CreateMaterial<Glass>(materialName, color, ior);
             }
             else if (materialType == "glossy")
             {
@@ -148,45 +189,30 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
                 float roughness = 0.0f;
                 loadValue(&roughness, material, "roughness");
 
-                auto ggxMat = std::make_unique<GGX>(color, roughness);
+                GGX* const ggxMat =
+                  scene.CreateMaterial<GGX>(materialName, color, roughness);
 
                 std::string colorTexturePathString;
                 loadValue(&colorTexturePathString, material, "color_tex");
                 if (!colorTexturePathString.empty())
                 {
-                    const std::filesystem::path colorTexturePath =
-                      colorTexturePathString;
-
-                    Texture2D colorTexture;
-                    if (colorTexture.Load(path.parent_path() / colorTexturePath,
-                                          Texture2D::TextureColorType::Color))
-                    {
-                        const TextureHandle textureHandle =
-                          scene.RegisterTexture(colorTexturePath, colorTexture);
-
-                        ggxMat->SetF0Texture(scene.GetTexture(textureHandle));
-                    }
+                    requestTexture(path.parent_path() / colorTexturePathString,
+                                   Texture2D::TextureColorType::Color,
+                                   [ggxMat](const Texture2D* texture) {
+                                       ggxMat->SetF0Texture(texture);
+                                   });
                 }
 
                 std::string roughnessTexturePath;
                 loadValue(&roughnessTexturePath, material, "roughness_tex");
                 if (!roughnessTexturePath.empty())
                 {
-                    Texture2D roughnessTexture;
-                    if (roughnessTexture.Load(
-                          roughnessTexturePath,
-                          Texture2D::TextureColorType::NonColor))
-                    {
-                        const TextureHandle textureHandle =
-                          scene.RegisterTexture(roughnessTexturePath,
-                                                roughnessTexture);
-
-                        ggxMat->SetRoughnessMap(
-                          scene.GetTexture(textureHandle));
-                    }
+                    requestTexture(roughnessTexturePath,
+                                   Texture2D::TextureColorType::NonColor,
+                                   [ggxMat](const Texture2D* texture) {
+                                       ggxMat->SetRoughnessMap(texture);
+                                   });
                 }
-
-                scene.RegisterMaterial(materialName, std::move(ggxMat));
             }
             else if (materialType == "emission")
             {
@@ -204,8 +230,8 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
                 float mix = 0.5;
                 loadValue(&mix, material, "mix");
 
-                auto mixedMat = std::make_unique<MixMaterial>(mat0, mat1, mix);
-                scene.RegisterMaterial(materialName, std::move(mixedMat));
+                scene.CreateMaterial<MixMaterial>(
+                  materialName, mat0, mat1, mix);
             }
             else
             {
@@ -216,6 +242,8 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
     }
 
     // ---- Camera ----
+    //! アニメーションのキーフレームで省略された値の既定値
+    SceneAnimation::Key baseKey;
     {
         auto camera = std::make_unique<Camera>();
 
@@ -224,39 +252,94 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
         {
             const auto position = loadVector3f(cameraData, "position");
             camera->SetPosition(position);
+            baseKey.position = position;
         }
 
         {
             const auto lookAt = loadVector3f(cameraData, "look_at");
             camera->LookAt(lookAt);
+            baseKey.lookAt = lookAt;
         }
 
         {
             const auto focusPos = loadVector3f(cameraData, "focus_pos");
             camera->FocusTo(focusPos);
+            baseKey.focusPos = focusPos;
         }
 
         {
             float fNumber = 2.8f;
             loadValue(&fNumber, cameraData, "f_number");
             camera->SetFNumber(fNumber);
+            baseKey.fNumber = fNumber;
         }
 
         {
             float focalLength = 55e-3f;
             loadValue(&focalLength, cameraData, "focal_length");
             camera->SetFocalLength(focalLength);
+            baseKey.focalLength = focalLength;
         }
 
         scene.SetMainCamera(std::move(camera));
     }
 
+    // ---- Animation ----
+    // "animation": { "keys": [ { "frame": 0, "position": [...], ... } ] }
+    // キーフレームで省略した値は "camera" の値を使う
+    if (loadedJson.find("animation") != loadedJson.cend())
+    {
+        SceneAnimation animation;
+
+        const auto keys = loadedJson["animation"]["keys"];
+        for (const auto& keyData : keys)
+        {
+            const auto hasValue = [&keyData](const char* keyName) {
+                return keyData.find(keyName) != keyData.cend();
+            };
+
+            SceneAnimation::Key key = baseKey;
+            loadValue(&key.frame, keyData, "frame");
+            if (hasValue("position"))
+            {
+                key.position = loadVector3f(keyData, "position");
+            }
+            if (hasValue("look_at"))
+            {
+                key.lookAt = loadVector3f(keyData, "look_at");
+            }
+            if (hasValue("focus_pos"))
+            {
+                key.focusPos = loadVector3f(keyData, "focus_pos");
+            }
+            if (hasValue("f_number"))
+            {
+                loadValue(&key.fNumber, keyData, "f_number");
+            }
+            if (hasValue("focal_length"))
+            {
+                loadValue(&key.focalLength, keyData, "focal_length");
+            }
+            if (hasValue("env_rotation"))
+            {
+                loadValue(&key.envRotation, keyData, "env_rotation");
+            }
+
+            animation.AddKey(key);
+        }
+
+        Logger::Info("Animation: frame {} - {}",
+                     animation.GetFirstFrame(),
+                     animation.GetLastFrame());
+        scene.SetAnimation(animation);
+    }
+
     // ---- env ---
+    Environment env;
+    std::filesystem::path envTexturePath;
     {
         const auto envData = loadedJson["env"];
 
-        Environment env;
-
         {
             const auto baseColor = loadVector3f(envData, "base_color");
             env.SetBaseColor(baseColor);
@@ -267,32 +350,107 @@ SceneLoaderJson::Load(const std::filesystem::path& path, Scene& scene)
             loadValue(&texturePathString, envData, "texture");
             if (!texturePathString.empty())
             {
-                const std::filesystem::path texturePath =
-                  path.parent_path() / texturePathString;
-                env.Load(texturePath);
+                envTexturePath = path.parent_path() / texturePathString;
             }
         }
-
-        scene.SetEnvironment(env);
     }
 
     // ---- assets ----
+    //! 並列読み込みするメッシュ
+    struct MeshLoadTask
+    {
+        std::filesystem::path path;
+        const MaterialBase* material = nullptr;
+        Mesh* mesh = nullptr;
+    };
+    std::vector<MeshLoadTask> meshLoadTasks;
     {
         const auto assets = loadedJson["assets"];
         for (const auto& asset : assets)
         {
-            if (asset.find("mat") != asset.cend())
+            const std::string materialName = (asset.find("mat") != asset.cend())
+                                               ? asset["mat"].get<std::string>()
+                                               : "default";
+
+            // マテリアルの参照はメインスレッドで解決しておく
+            const MaterialBase* const material =
+              scene.GetMaterial(materialName);
+            ASSERT(material && "Material not found.");
+
+            const std::filesystem::path meshPath =
+              path.parent_path() / asset["path"].get<std::string>();
+
+            meshLoadTasks.push_back(
+              { meshPath, material, scene.CreateResource<Mesh>() });
+        }
+    }
+
+    // ---- 並列読み込み ----
+    {
+        SCOPE_LOGGER("[SceneLoaderJson] Load resources");
+        PROFILE_SCOPE("LoadResources");
+
+        ThreadPool threadPool(numThreads);
+
+        if (!envTexturePath.empty())
+        {
+            threadPool.Push(
+              [&env, &envTexturePath](size_t) {
+                  PROFILE_SCOPE("LoadEnvironment");
+                  env.Load(envTexturePath);
+              });
+        }
+
+        for (const auto& task : textureLoadTasks)
+        {
+            threadPool.Push([task = task.get()](size_t) {
+                PROFILE_SCOPE("LoadTexture");
+                task->isLoaded =
+                  task->texture.Load(task->path, task->colorType);
+            });
+        }
+
+        for (const auto& task : meshLoadTasks)
+        {
+            threadPool.Push([&task](size_t) {
+                PROFILE_SCOPE("LoadMesh");
+                task.mesh->Load(task.path, task.material, ShadingTypes::Smooth);
+            });
+        }
+
+        // ThreadPoolのデストラクタで全タスクの完了を待つ
+    }
+
+    // ---- シーンへの登録 ----
+    {
+        std::vector<const Texture2D*> registeredTextures;
+        registeredTextures.reserve(textureLoadTasks.size());
+        for (const auto& task : textureLoadTasks)
+        {
+            const Texture2D* registeredTexture = nullptr;
+            if (task->isLoaded)
             {
-                scene.LoadModel(path.parent_path() /
-                                  asset["path"].get<std::string>(),
-                                asset["mat"].get<std::string>());
+                const TextureHandle textureHandle =
+                  scene.RegisterTexture(task->path, std::move(task->texture));
+                registeredTexture = scene.GetTexture(textureHandle);
             }
-            else
+            registeredTextures.emplace_back(registeredTexture);
+        }
+
+        for (const auto& [taskIndex, bindTexture] : textureBindings)
+        {
+            if (registeredTextures[taskIndex])
             {
-                scene.LoadModel(path.parent_path() /
-                                asset["path"].get<std::string>());
+                bindTexture(registeredTextures[taskIndex]);
             }
         }
+
+        scene.SetEnvironment(std::move(env));
+
+        for (const auto& task : meshLoadTasks)
+        {
+            scene.AppendMesh(*task.mesh);
+        }
     }
 } // namespace Core
 
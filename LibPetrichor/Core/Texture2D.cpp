@@ -1,5 +1,8 @@
 #include "Texture2D.h"
 
+#include "Core/Image/EXRWriter.h"
+#include "Core/Image/PNGWriter.h"
+#include "Core/Image/ToneMapping.h"
 #include "Core/Logger.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,31 +18,6 @@ namespace Core
 namespace
 {
 
-float
-ACESFilm(float x)
-{
-    float a = 2.51f;
-    float b = 0.03f;
-    float c = 2.43f;
-    float d = 0.59f;
-    float e = 0.14f;
-    return (x * (a * x + b)) / (x * (c * x + d) + e);
-}
-
-Color3f
-ACESFilm(const Color3f& color)
-{
-    return { ACESFilm(color.x), ACESFilm(color.y), ACESFilm(color.z) };
-}
-
-Color3f
-Clamp(const Color3f& color, float min, float max)
-{
-    return { std::clamp(color.x, min, max),
-             std::clamp(color.y, min, max),
-             std::clamp(color.z, min, max) };
-}
-
 float
 ApplyGamma(float value, float gamma = 2.2f)
 {
@@ -54,42 +32,6 @@ ApplyGamma(const Color3f& color, float gamma = 2.2f)
              ApplyGamma(color.z, gamma) };
 }
 
-// #TODO: 時間ないのでハードコード、LUT読みにしたい…。
-Color3f
-RTCamp7Tonemap(const Color3f& color)
-{
-    Color3f c = ApplyGamma(color, 1.2f);
-    const auto x0 = ApplyGamma(0.05f * Color3f::One());
-    const auto x1 = ApplyGamma(0.9f * Color3f::One());
-    c = (c - x0) / (x1 - x0);
-    c.y = ApplyGamma(c.y, 1.3f);
-    c.z = ApplyGamma(c.z, 1.6f);
-    return c;
-}
-
-Color3f
-ApplyToneMapping(const Math::Vector3f& color)
-{
-    // #TODO: 分離
-    return RTCamp7Tonemap(ACESFilm(color));
-}
-
-float
-ApplyDegamma(float value)
-{
-    value = std::pow(value, 1.1f);
-    value = std::clamp(value, 0.0f, 1.0f);
-    return std::pow(value, 1 / 2.2f);
-}
-
-Color3f
-ApplyDegamma(const Color3f& color)
-{
-    return { ApplyDegamma(color.x),
-             ApplyDegamma(color.y),
-             ApplyDegamma(color.z) };
-}
-
 } // namespace
 
 Texture2D::Texture2D()
@@ -195,41 +137,45 @@ Texture2D::Load(const std::filesystem::path& path,
 }
 
 void
-Texture2D::Save(const std::filesystem::path& path) const
+Texture2D::Save(const std::filesystem::path& path, uint32_t numThreads) const
 {
     if (path.extension() == ".png")
     {
-        std::vector<uint8_t> outPixels;
-        outPixels.reserve(kNumChannelsInPixelRGB * m_width * m_height);
-
-        for (const auto& pixel : m_pixels)
-        {
-            const Color3f toneMapped = ApplyToneMapping(pixel);
-            const Color3f degammaColor = ApplyDegamma(toneMapped);
-
-            const auto r =
-              static_cast<uint8_t>((kColorDepth8Bit - kEps) * degammaColor.x);
-            const auto g =
-              static_cast<uint8_t>((kColorDepth8Bit - kEps) * degammaColor.y);
-            const auto b =
-              static_cast<uint8_t>((kColorDepth8Bit - kEps) * degammaColor.z);
-
-            outPixels.emplace_back(r);
-            outPixels.emplace_back(g);
-            outPixels.emplace_back(b);
-        }
+        // トーンマッピングは圧縮と同じスレッドで行ごとに行う
+        const ToneMapper& toneMapper = ToneMapper::GetInstance();
+        WritePNG(
+          path,
+          m_width,
+          m_height,
+          [&](int y, uint8_t* rgb) {
+              toneMapper.Apply(&m_pixels[y * m_width], m_width, rgb);
+          },
+          numThreads);
+        return;
+    }
 
-        stbi_write_png(path.string().c_str(),
-                       m_width,
-                       m_height,
-                       kNumChannelsInPixelRGB,
-                       &outPixels[0],
-                       m_width * kNumChannelsInPixelRGB);
+    if (path.extension() == ".exr")
+    {
+        EXRWriter writer;
+        writer.AddLayer("", *this);
+        writer.Write(path, numThreads);
         return;
     }
 
     if (path.extension() == ".hdr")
     {
+        // パディングがなければ画素値をそのまま渡す
+        if constexpr (GetRawDataPixelStride() ==
+                      kNumChannelsInPixelHDR * sizeof(float))
+        {
+            stbi_write_hdr(path.string().c_str(),
+                           m_width,
+                           m_height,
+                           kNumChannelsInPixelHDR,
+                           GetRawDataPtr());
+            return;
+        }
+
         std::vector<float> outPixels;
         outPixels.reserve(kNumChannelsInPixelHDR * m_width * m_height);
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Color3f.h"
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -46,8 +47,9 @@ public:
     Load(const std::filesystem::path& path, TextureColorType textureColorType);
 
     //// 画像を書き出し
+    //! @param numThreads PNG, EXRの変換と圧縮に使うスレッド数(0 の場合は全て)
     void
-    Save(const std::filesystem::path& path) const;
+    Save(const std::filesystem::path& path, uint32_t numThreads = 0) const;
 
     //// 画像をクリア
     void
@@ -110,6 +112,22 @@ public:
           static_cast<const Texture2D*>(this)->GetRawDataPtr());
     }
 
+    //! 画素値の配列(行優先)の先頭
+    //! 再配置が起きる可能性があるのでポインタの保持には注意
+    const Color3f*
+    GetPixelData() const
+    {
+        return m_pixels.data();
+    }
+
+    //! GetRawDataPtr() の隣り合う画素の間隔[byte]
+    //! (SIMD有効時はパディングを含むので 3 * sizeof(float) とは限らない)
+    static constexpr size_t
+    GetRawDataPixelStride()
+    {
+        return sizeof(Color3f);
+    }
+
 private:
     // TODO: RGBAに対応させる（現在はRGB）
     static constexpr int kNumChannelsInPixelRGB = 3;
@@ -0,0 +1,255 @@
+#include "CpuTopology.h"
+
+#include "Core/Logger.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Petrichor
+{
+namespace Core
+{
+
+namespace
+{
+
+#ifdef __linux__
+
+const std::filesystem::path kCpuDirectory = "/sys/devices/system/cpu";
+
+//! sysfs の整数を読む(読めない場合は defaultValue)
+int
+ReadSysfsInt(const std::filesystem::path& path, int defaultValue)
+{
+    std::ifstream ifs(path);
+    int value = defaultValue;
+    if (!(ifs >> value))
+    {
+        return defaultValue;
+    }
+    return value;
+}
+
+//! 論理 CPU が属する NUMA ノードの OS の番号(分からない場合は 0)
+//! cpuN ディレクトリにノードへのリンク nodeM がある
+int
+ReadNodeId(int cpuId)
+{
+    std::error_code errorCode;
+    const std::filesystem::directory_iterator iter(
+      kCpuDirectory / fmt::format("cpu{}", cpuId), errorCode);
+    if (errorCode)
+    {
+        return 0;
+    }
+
+    for (const std::filesystem::directory_entry& entry : iter)
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::isdigit(static_cast<unsigned char>(name[4])))
+        {
+            return std::stoi(name.substr(4));
+        }
+    }
+    return 0;
+}
+
+#endif
+
+} // namespace
+
+const CpuTopology&
+CpuTopology::Get()
+{
+    static const CpuTopology topology = [] {
+        CpuTopology topology_;
+        topology_.Detect();
+        Logger::Info("CPU topology: {} NUMA nodes, {} cores, {} threads.",
+                     topology_.m_numNodes,
+                     topology_.m_numCores,
+                     topology_.m_cpus.size());
+        return topology_;
+    }();
+    return topology;
+}
+
+std::vector<CpuTopology::LogicalCpu>
+CpuTopology::GetCpusOfNode(int nodeIndex) const
+{
+    std::vector<LogicalCpu> cpus;
+    std::copy_if(m_cpus.begin(),
+                 m_cpus.end(),
+                 std::back_inserter(cpus),
+                 [nodeIndex](const LogicalCpu& cpu) {
+                     return cpu.nodeIndex == nodeIndex;
+                 });
+    return cpus;
+}
+
+bool
+CpuTopology::BindCurrentThreadToCpu(int cpuId)
+{
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpuId, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) ==
+           0;
+#else
+    static_cast<void>(cpuId);
+    return false;
+#endif
+}
+
+bool
+CpuTopology::BindCurrentThreadToNode(int nodeIndex) const
+{
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const LogicalCpu& cpu : m_cpus)
+    {
+        if (cpu.nodeIndex == nodeIndex)
+        {
+            CPU_SET(cpu.cpuId, &cpuSet);
+        }
+    }
+
+    if (CPU_COUNT(&cpuSet) == 0)
+    {
+        return false;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) ==
+           0;
+#else
+    static_cast<void>(nodeIndex);
+    return false;
+#endif
+}
+
+void
+CpuTopology::RunOnNode(int nodeIndex, const std::function<void()>& func) const
+{
+    std::thread thread([&] {
+        BindCurrentThreadToNode(nodeIndex);
+        func();
+    });
+    thread.join();
+}
+
+void
+CpuTopology::Detect()
+{
+    m_cpus.clear();
+
+#ifdef __linux__
+    // taskset や cgroup で制限されている場合は、使える CPU だけを数える
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0)
+    {
+        // OS の番号を詰めた番号に振り直す(番号順に並べるため map を使う)
+        std::map<int, int> nodeIndices;
+        std::map<std::pair<int, int>, int> coreIndices;
+
+        struct CpuIds
+        {
+            int cpuId = 0;
+            int nodeId = 0;
+            std::pair<int, int> coreId; //!< (パッケージ, パッケージ内のコア)
+        };
+        std::vector<CpuIds> cpuIdsList;
+
+        for (int cpuId = 0; cpuId < CPU_SETSIZE; cpuId++)
+        {
+            if (!CPU_ISSET(cpuId, &cpuSet))
+            {
+                continue;
+            }
+
+            const std::filesystem::path topologyPath =
+              kCpuDirectory / fmt::format("cpu{}", cpuId) / "topology";
+
+            CpuIds cpuIds;
+            cpuIds.cpuId = cpuId;
+            cpuIds.nodeId = ReadNodeId(cpuId);
+            cpuIds.coreId = {
+                ReadSysfsInt(topologyPath / "physical_package_id", 0),
+                ReadSysfsInt(topologyPath / "core_id", cpuId)
+            };
+            cpuIdsList.emplace_back(cpuIds);
+
+            nodeIndices.emplace(cpuIds.nodeId, 0);
+            coreIndices.emplace(cpuIds.coreId, 0);
+        }
+
+        int nodeIndex = 0;
+        for (auto& [nodeId, index] : nodeIndices)
+        {
+            index = nodeIndex++;
+        }
+        int coreIndex = 0;
+        for (auto& [coreId, index] : coreIndices)
+        {
+            index = coreIndex++;
+        }
+
+        // 同じコアの論理 CPU は CPU 番号の順に smtIndex を振る
+        std::vector<int> numCpusPerCore(coreIndices.size(), 0);
+        for (const CpuIds& cpuIds : cpuIdsList)
+        {
+            LogicalCpu cpu;
+            cpu.cpuId = cpuIds.cpuId;
+            cpu.coreIndex = coreIndices[cpuIds.coreId];
+            cpu.nodeIndex = nodeIndices[cpuIds.nodeId];
+            cpu.smtIndex = numCpusPerCore[cpu.coreIndex]++;
+            m_cpus.emplace_back(cpu);
+        }
+    }
+#endif
+
+    if (m_cpus.empty())
+    {
+        const int numCpus =
+          std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+        for (int cpuId = 0; cpuId < numCpus; cpuId++)
+        {
+            LogicalCpu cpu;
+            cpu.cpuId = cpuId;
+            cpu.coreIndex = cpuId;
+            m_cpus.emplace_back(cpu);
+        }
+    }
+
+    // ノードごとにまとめ、SMT の兄弟より先に別のコアを使うように並べる
+    std::sort(m_cpus.begin(),
+              m_cpus.end(),
+              [](const LogicalCpu& lhs, const LogicalCpu& rhs) {
+                  return std::tie(lhs.nodeIndex, lhs.smtIndex, lhs.coreIndex) <
+                         std::tie(rhs.nodeIndex, rhs.smtIndex, rhs.coreIndex);
+              });
+
+    m_numNodes = 0;
+    m_numCores = 0;
+    for (const LogicalCpu& cpu : m_cpus)
+    {
+        m_numNodes = std::max(m_numNodes, cpu.nodeIndex + 1);
+        m_numCores = std::max(m_numCores, cpu.coreIndex + 1);
+    }
+}
+
+} // namespace Core
+} // namespace Petrichor
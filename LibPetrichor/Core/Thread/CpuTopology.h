@@ -0,0 +1,83 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! プロセスが使える論理 CPU の、コアと NUMA ノードへの対応
+//! Linux では sysfs とプロセスの affinity から調べる。
+//! それ以外の環境ではノード1つ、SMT なしとして扱い、スレッドの固定もしない
+class CpuTopology
+{
+public:
+    //! 論理 CPU
+    struct LogicalCpu
+    {
+        int cpuId = 0;     //!< OS の CPU 番号
+        int coreIndex = 0; //!< 物理コアの番号 [0, GetNumCores())
+        int nodeIndex = 0; //!< NUMA ノードの番号 [0, GetNumNodes())
+        int smtIndex = 0;  //!< 同じコア内での番号(0 が最初のハードウェアスレッド)
+    };
+
+    //! 起動時のプロセスの構成(最初の呼び出しで調べる)
+    static const CpuTopology&
+    Get();
+
+    //! 論理 CPU の一覧
+    //! ノード順に並び、ノード内では各コアの最初のハードウェアスレッドが先に来る
+    const std::vector<LogicalCpu>&
+    GetCpus() const
+    {
+        return m_cpus;
+    }
+
+    //! ノードの論理 CPU の一覧(並びは GetCpus() と同じ)
+    std::vector<LogicalCpu>
+    GetCpusOfNode(int nodeIndex) const;
+
+    int
+    GetNumNodes() const
+    {
+        return m_numNodes;
+    }
+
+    int
+    GetNumCores() const
+    {
+        return m_numCores;
+    }
+
+    //! 呼び出し元スレッドを論理 CPU に固定する
+    //! @return 成功したか(Linux 以外では常に false)
+    static bool
+    BindCurrentThreadToCpu(int cpuId);
+
+    //! 呼び出し元スレッドをノードの論理 CPU のいずれかで動くようにする
+    //! @return 成功したか(Linux 以外では常に false)
+    bool
+    BindCurrentThreadToNode(int nodeIndex) const;
+
+    //! ノードに固定したスレッドで関数を実行し、終わるまで待つ
+    //! Linux ではページは最初に書き込んだスレッドのノードに置かれるので、
+    //! func 内で確保して書き込んだメモリはそのノードに載る
+    void
+    RunOnNode(int nodeIndex, const std::function<void()>& func) const;
+
+private:
+    CpuTopology() = default;
+
+    //! 環境から調べる
+    void
+    Detect();
+
+    std::vector<LogicalCpu> m_cpus;
+    int m_numNodes = 1;
+    int m_numCores = 0;
+};
+
+} // namespace Core
+} // namespace Petrichor
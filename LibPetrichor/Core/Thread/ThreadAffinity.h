@@ -0,0 +1,33 @@
+#pragma once
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! レンダリングスレッドの CPU への固定方法
+enum class ThreadAffinityTypes
+{
+    None, //!< 固定しない(OS に任せる)
+    Core, //!< ワーカーを1つの論理 CPU に固定する
+    Node, //!< ワーカーを NUMA ノードに固定する(ノード内では OS に任せる)
+};
+
+//! 設定ファイルで用いるスレッドの固定方法の名前
+inline const char*
+GetThreadAffinityName(ThreadAffinityTypes threadAffinity)
+{
+    switch (threadAffinity)
+    {
+    case ThreadAffinityTypes::Core:
+        return "core";
+    case ThreadAffinityTypes::Node:
+        return "node";
+    case ThreadAffinityTypes::None:
+    default:
+        return "none";
+    }
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -1,7 +1,11 @@
 #include "ThreadPool.h"
 
 #include "Core/Logger.h"
+#include "Core/Thread/CpuTopology.h"
+#include "Profiler/Profiler.h"
+#include <fmt/format.h>
 #include <iostream>
+#include <optional>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -14,8 +18,71 @@ namespace Petrichor
 namespace Core
 {
 
-ThreadPool::ThreadPool(size_t numThreads)
+namespace
 {
+
+//! 呼び出し元のワーカーを固定した NUMA ノード
+thread_local int t_currentNodeIndex = -1;
+
+//! ワーカーごとに固定する論理 CPU を決める
+//! ノードの論理 CPU の数に比例してワーカーを割り振り、ノード内では
+//! CpuTopology::GetCpus() の順(SMT の兄弟より別のコアが先)に使う
+std::vector<CpuTopology::LogicalCpu>
+AssignCpus(const CpuTopology& topology, size_t numThreads)
+{
+    const size_t numCpus = topology.GetCpus().size();
+
+    std::vector<CpuTopology::LogicalCpu> threadCpus;
+    threadCpus.reserve(numThreads);
+
+    size_t cumulativeNumCpus = 0;
+    for (int nodeIndex = 0; nodeIndex < topology.GetNumNodes(); nodeIndex++)
+    {
+        const std::vector<CpuTopology::LogicalCpu> nodeCpus =
+          topology.GetCpusOfNode(nodeIndex);
+
+        const size_t threadBegin = numThreads * cumulativeNumCpus / numCpus;
+        cumulativeNumCpus += nodeCpus.size();
+        const size_t threadEnd = numThreads * cumulativeNumCpus / numCpus;
+
+        // 論理 CPU より多い場合は、同じ CPU に複数のワーカーを固定する
+        for (size_t index = 0; index < threadEnd - threadBegin; index++)
+        {
+            threadCpus.emplace_back(nodeCpus[index % nodeCpus.size()]);
+        }
+    }
+    return threadCpus;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads, ThreadAffinityTypes affinity)
+  : m_affinity(affinity)
+{
+    // 固定する論理 CPU(ワーカーごと)
+    std::vector<CpuTopology::LogicalCpu> threadCpus;
+#ifndef _WIN32
+    if (affinity != ThreadAffinityTypes::None)
+    {
+        const CpuTopology& topology = CpuTopology::Get();
+        if (numThreads == 0)
+        {
+            numThreads = topology.GetCpus().size();
+        }
+
+        threadCpus = AssignCpus(topology, numThreads);
+        for (const CpuTopology::LogicalCpu& cpu : threadCpus)
+        {
+            m_nodeIndices.emplace_back(cpu.nodeIndex);
+        }
+
+        Logger::Info("{} workers are bound to {}s on {} NUMA nodes.",
+                     numThreads,
+                     GetThreadAffinityName(affinity),
+                     topology.GetNumNodes());
+    }
+#endif
+
     if (numThreads == 0)
     {
 #ifdef _WIN32
@@ -83,7 +150,13 @@ ThreadPool::ThreadPool(size_t numThreads)
         groupIndex = threadIndexToGroupIndex[threadIndex];
 #endif
 
-        m_threads.emplace_back(std::thread([this, threadIndex, groupIndex] {
+        std::optional<CpuTopology::LogicalCpu> cpu;
+        if (!threadCpus.empty())
+        {
+            cpu = threadCpus[threadIndex];
+        }
+
+        m_threads.emplace_back(std::thread([this, threadIndex, groupIndex, cpu] {
 
 #ifdef _WIN32
             {
@@ -102,6 +175,21 @@ ThreadPool::ThreadPool(size_t numThreads)
                 bindThreadToGroup(threadIndex, groupIndex);
             }
 #endif
+            if (cpu)
+            {
+                const bool isBound =
+                  m_affinity == ThreadAffinityTypes::Core
+                    ? CpuTopology::BindCurrentThreadToCpu(cpu->cpuId)
+                    : CpuTopology::Get().BindCurrentThreadToNode(
+                        cpu->nodeIndex);
+                if (isBound)
+                {
+                    t_currentNodeIndex = cpu->nodeIndex;
+                }
+            }
+
+            PROFILE_THREAD_NAME(fmt::format("Worker {}", threadIndex));
+
             for (;;)
             {
                 std::function<void(size_t)> task;
@@ -140,6 +228,12 @@ ThreadPool::~ThreadPool()
     }
 }
 
+int
+ThreadPool::GetCurrentNodeIndex()
+{
+    return t_currentNodeIndex;
+}
+
 void
 ThreadPool::Push(std::function<void(size_t)>&& task)
 {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Core/Thread/ThreadAffinity.h"
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -15,16 +16,44 @@ namespace Core
 class ThreadPool
 {
 public:
-    explicit ThreadPool(size_t numThreads);
+    //! @param numThreads スレッド数(0 の場合は使える論理 CPU の数)
+    //! @param affinity ワーカーの CPU への固定方法(Linux のみ)
+    //! 固定する場合、ワーカーはノードごとに連続した番号になる
+    explicit ThreadPool(
+      size_t numThreads,
+      ThreadAffinityTypes affinity = ThreadAffinityTypes::None);
     ~ThreadPool();
 
     void
     Push(std::function<void(size_t)>&& task);
 
+    //! スレッド数を取得する
+    size_t
+    GetNumThreads() const
+    {
+        return m_numThreads;
+    }
+
+    //! ワーカーを固定した NUMA ノード(固定していない場合は -1)
+    int
+    GetNodeIndex(size_t threadIndex) const
+    {
+        return m_nodeIndices.empty() ? -1 : m_nodeIndices[threadIndex];
+    }
+
+    //! 呼び出し元のワーカーを固定した NUMA ノード
+    //! 固定していないワーカーや、ワーカー以外のスレッドでは -1
+    static int
+    GetCurrentNodeIndex();
+
 private:
     std::vector<std::thread> m_threads;
     std::queue<std::function<void(size_t)>> m_tasks;
     size_t m_numThreads = 0;
+    ThreadAffinityTypes m_affinity = ThreadAffinityTypes::None;
+
+    //! ワーカーごとの NUMA ノード(固定しない場合は空)
+    std::vector<int> m_nodeIndices;
     std::mutex m_mutex;
     std::condition_variable m_cond;
     bool m_isTerminated = false;
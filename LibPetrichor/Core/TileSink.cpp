@@ -0,0 +1,104 @@
+#include "TileSink.h"
+
+#include "Core/Logger.h"
+
+namespace Petrichor
+{
+namespace Core
+{
+
+void
+TileSinkList::Add(TileSink* tileSink)
+{
+    if (tileSink)
+    {
+        m_tileSinks.emplace_back(tileSink);
+    }
+}
+
+bool
+TileSinkList::OnBegin(Scene::AOVType::Value aovType,
+                      int width,
+                      int height,
+                      int tileWidth,
+                      int tileHeight)
+{
+    std::vector<TileSink*>& activeTileSinks = m_activeTileSinks[aovType];
+    activeTileSinks.clear();
+    for (TileSink* tileSink : m_tileSinks)
+    {
+        if (tileSink->OnBegin(aovType, width, height, tileWidth, tileHeight))
+        {
+            activeTileSinks.emplace_back(tileSink);
+        }
+    }
+    return !activeTileSinks.empty();
+}
+
+void
+TileSinkList::OnTileFinished(Scene::AOVType::Value aovType,
+                             const TileManager::Tile& tile,
+                             const TilePixels& pixels)
+{
+    for (TileSink* tileSink : m_activeTileSinks[aovType])
+    {
+        tileSink->OnTileFinished(aovType, tile, pixels);
+    }
+}
+
+void
+TileSinkList::OnEnd(Scene::AOVType::Value aovType)
+{
+    for (TileSink* tileSink : m_activeTileSinks[aovType])
+    {
+        tileSink->OnEnd(aovType);
+    }
+}
+
+TiledEXRTileSink::TiledEXRTileSink(const std::filesystem::path& path,
+                                   Scene::AOVType::Value aovType,
+                                   EXRWriter::Compression compression)
+  : m_path(path)
+  , m_aovType(aovType)
+  , m_compression(compression)
+{
+}
+
+bool
+TiledEXRTileSink::OnBegin(Scene::AOVType::Value aovType,
+                          int width,
+                          int height,
+                          int tileWidth,
+                          int tileHeight)
+{
+    if (aovType != m_aovType)
+    {
+        return false;
+    }
+
+    return m_writer.Open(
+      m_path, width, height, tileWidth, tileHeight, m_compression);
+}
+
+void
+TiledEXRTileSink::OnTileFinished(Scene::AOVType::Value aovType,
+                                 const TileManager::Tile& tile,
+                                 const TilePixels& pixels)
+{
+    m_writer.WriteTile(tile.x,
+                       tile.y,
+                       tile.width,
+                       tile.height,
+                       pixels.pixels,
+                       pixels.rowStride);
+}
+
+void
+TiledEXRTileSink::OnEnd(Scene::AOVType::Value aovType)
+{
+    m_writer.Close();
+    Logger::Info("File saved: {}", m_path.string());
+}
+
+} // namespace Core
+} // namespace Petrichor
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Core/Color3f.h"
+#include "Core/Image/EXRWriter.h"
+#include "Core/Scene.h"
+#include "Core/TileManager.h"
+#include <array>
+#include <filesystem>
+#include <vector>
+
+namespace Petrichor
+{
+namespace Core
+{
+
+//! タイル内の画素の参照(レンダリング先のテクスチャを直接指す)
+struct TilePixels
+{
+    const Color3f* pixels = nullptr; //!< タイルの左上の画素
+    size_t rowStride = 0;            //!< 隣り合う行の間隔[画素]
+
+    //! タイル内の座標で画素を取得する
+    const Color3f&
+    At(int x, int y) const
+    {
+        return pixels[y * rowStride + x];
+    }
+};
+
+//! レンダリングが終わったタイルの受け取り先
+//! Petrichor::SetTileSink() で設定すると、レンダリング中にタイルが
+//! 完成するたびに呼ばれる
+class TileSink
+{
+public:
+    virtual ~TileSink() = default;
+
+    //! AOV のレンダリング開始時に呼ばれる
+    //! @return この AOV のタイルを受け取るか
+    virtual bool
+    OnBegin(Scene::AOVType::Value aovType,
+            int width,
+            int height,
+            int tileWidth,
+            int tileHeight) = 0;
+
+    //! タイルのレンダリングが終わるたびにワーカースレッドから呼ばれる
+    //! 複数のスレッドから同時に呼ばれることがある。
+    //! pixels はこの呼び出しの間だけ有効
+    virtual void
+    OnTileFinished(Scene::AOVType::Value aovType,
+                   const TileManager::Tile& tile,
+                   const TilePixels& pixels) = 0;
+
+    //! AOV のレンダリング終了時に呼ばれる
+    virtual void
+    OnEnd(Scene::AOVType::Value aovType)
+    {
+    }
+};
+
+//! 複数の TileSink にタイルを渡す
+//! Petrichor::SetTileSink() には1つしか設定できないので、まとめて設定する
+class TileSinkList : public TileSink
+{
+public:
+    //! 受け取り先を追加する(nullptr の場合は何もしない)
+    void
+    Add(TileSink* tileSink);
+
+    bool
+    OnBegin(Scene::AOVType::Value aovType,
+            int width,
+            int height,
+            int tileWidth,
+            int tileHeight) override;
+
+    void
+    OnTileFinished(Scene::AOVType::Value aovType,
+                   const TileManager::Tile& tile,
+                   const TilePixels& pixels) override;
+
+    void
+    OnEnd(Scene::AOVType::Value aovType) override;
+
+private:
+    std::vector<TileSink*> m_tileSinks;
+
+    //! AOV ごとの、タイルを受け取る TileSink
+    std::array<std::vector<TileSink*>, Scene::AOVType::NumAOVTypes>
+      m_activeTileSinks;
+};
+
+//! 1つの AOV のタイルをタイル形式の EXR ファイルに逐次書き出す
+//! 異常終了しても書き出し済みのタイルはファイルに残る
+class TiledEXRTileSink : public TileSink
+{
+public:
+    explicit TiledEXRTileSink(
+      const std::filesystem::path& path,
+      Scene::AOVType::Value aovType = Scene::AOVType::Rendered,
+      EXRWriter::Compression compression = EXRWriter::Compression::Zip);
+
+    bool
+    OnBegin(Scene::AOVType::Value aovType,
+            int width,
+            int height,
+            int tileWidth,
+            int tileHeight) override;
+
+    void
+    OnTileFinished(Scene::AOVType::Value aovType,
+                   const TileManager::Tile& tile,
+                   const TilePixels& pixels) override;
+
+    void
+    OnEnd(Scene::AOVType::Value aovType) override;
+
+private:
+    std::filesystem::path m_path;
+    Scene::AOVType::Value m_aovType;
+    EXRWriter::Compression m_compression;
+
+    TiledEXRWriter m_writer;
+};
+
+} // namespace Core
+} // namespace Petrichor
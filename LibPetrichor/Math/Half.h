@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Petrichor
+{
+namespace Math
+{
+
+//! 単精度浮動小数点数を半精度(IEEE 754 binary16)のビット列に変換する
+//! 最近接偶数に丸め、表現できない大きさの値は無限大に、NaN は NaN にする
+inline uint16_t
+FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+
+    // 無限大と NaN
+    if (bits >= 0x7F800000)
+    {
+        return sign | 0x7C00 | (bits > 0x7F800000 ? 0x0200 : 0);
+    }
+
+    // 65520 以上は丸めると無限大になる
+    if (bits >= 0x477FF000)
+    {
+        return sign | 0x7C00;
+    }
+
+    // 2^-14 未満は非正規化数
+    if (bits < 0x38800000)
+    {
+        // 2^-25 未満は0に丸める
+        if (bits < 0x33000000)
+        {
+            return sign;
+        }
+
+        const uint32_t exponent = bits >> 23;
+        const uint32_t mantissa = (bits & 0x007FFFFF) | 0x00800000;
+        const uint32_t shift = 126 - exponent;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+
+        uint32_t half = mantissa >> shift;
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+        {
+            half++;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    // 正規化数: 指数のバイアスを 127 から 15 に付け替える
+    // (仮数部の丸めの繰り上がりはそのまま指数部に伝播させてよい)
+    uint32_t half = (bits - 0x38000000) >> 13;
+    const uint32_t remainder = bits & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        half++;
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+//! 半精度(IEEE 754 binary16)のビット列を単精度浮動小数点数に変換する
+inline float
+HalfToFloat(uint16_t half)
+{
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x03FF;
+
+    uint32_t bits;
+    if (exponent == 0)
+    {
+        // 非正規化数は mantissa * 2^-24 で、単精度では正確に表せる
+        const float value = static_cast<float>(mantissa) / 16777216.0f;
+        return sign ? -value : value;
+    }
+    else if (exponent == 0x1F)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace Math
+} // namespace Petrichor
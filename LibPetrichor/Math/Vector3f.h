@@ -7,12 +7,24 @@
 #include <iostream>
 #include <optional>
 
+// PETRICHOR_USE_SIMD が定義されていて SSE2 が使える場合は、
+// Vector3f を4レーンのSIMDレジスタで演算する
+#if defined(PETRICHOR_USE_SIMD) &&                                             \
+  (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define PETRICHOR_VECTOR3F_SIMD
+#include <emmintrin.h>
+#endif
+
 namespace Petrichor
 {
 namespace Math
 {
 
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+class alignas(16) Vector3f
+#else
 class Vector3f
+#endif
 {
 public:
     constexpr Vector3f() = default;
@@ -41,8 +53,13 @@ public:
     // Length
     float
     Length() const;
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    float
+    SquaredLength() const;
+#else
     constexpr float
     SquaredLength() const;
+#endif
 
     // Normalization
     void
@@ -69,6 +86,32 @@ public:
     float y = 0.0f;
     float z = 0.0f;
 
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    //! 4レーンのレジスタに読み込む(4レーン目は常に0)
+    __m128
+    Load() const
+    {
+        return _mm_load_ps(&x);
+    }
+
+    //! 4レーンのレジスタから作る(4レーン目は0にする)
+    static Vector3f
+    FromSIMD(__m128 v)
+    {
+        const __m128 kMaskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+        Vector3f result;
+        _mm_store_ps(&result.x, _mm_and_ps(v, kMaskXYZ));
+        return result;
+    }
+
+private:
+    //! 16byte境界に揃えるためのパディング
+    float m_padding = 0.0f;
+
+public:
+#endif
+
 #pragma region Operator overloading
 
     // Addition
@@ -125,6 +168,45 @@ public:
 
 #pragma region Inline functions
 
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+
+inline float
+Dot(const Vector3f& v0, const Vector3f& v1)
+{
+    // (x, y, z, 0) の水平加算
+    const __m128 mul = _mm_mul_ps(v0.Load(), v1.Load());
+    const __m128 shuf = _mm_shuffle_ps(mul, mul, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m128 sums = _mm_add_ps(mul, shuf);
+    return _mm_cvtss_f32(_mm_add_ss(sums, _mm_movehl_ps(shuf, sums)));
+}
+
+inline Vector3f
+Cross(const Vector3f& v0, const Vector3f& v1)
+{
+    const __m128 a = v0.Load();
+    const __m128 b = v1.Load();
+    const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return Vector3f::FromSIMD(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+
+//! 要素ごとの最小値
+inline Vector3f
+Min(const Vector3f& v0, const Vector3f& v1)
+{
+    return Vector3f::FromSIMD(_mm_min_ps(v0.Load(), v1.Load()));
+}
+
+//! 要素ごとの最大値
+inline Vector3f
+Max(const Vector3f& v0, const Vector3f& v1)
+{
+    return Vector3f::FromSIMD(_mm_max_ps(v0.Load(), v1.Load()));
+}
+
+#else
+
 constexpr float
 Dot(const Vector3f& v0, const Vector3f& v1)
 {
@@ -139,6 +221,26 @@ Cross(const Vector3f& v0, const Vector3f& v1)
                     v0.x * v1.y - v0.y * v1.x);
 }
 
+//! 要素ごとの最小値
+inline Vector3f
+Min(const Vector3f& v0, const Vector3f& v1)
+{
+    return Vector3f(std::min(v0.x, v1.x),
+                    std::min(v0.y, v1.y),
+                    std::min(v0.z, v1.z));
+}
+
+//! 要素ごとの最大値
+inline Vector3f
+Max(const Vector3f& v0, const Vector3f& v1)
+{
+    return Vector3f(std::max(v0.x, v1.x),
+                    std::max(v0.y, v1.y),
+                    std::max(v0.z, v1.z));
+}
+
+#endif
+
 constexpr Vector3f
 Vector3f::Zero()
 {
@@ -171,7 +273,11 @@ Vector3f::Length() const
 {
     return sqrt(Dot(*this, *this));
 }
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+inline float
+#else
 constexpr float
+#endif
 Vector3f::SquaredLength() const
 {
     return Dot(*this, *this);
@@ -236,15 +342,23 @@ Vector3f::Refracted(const Vector3f& normal, float relativeIOR) const
 inline Vector3f
 Vector3f::operator+(const Vector3f& v) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_add_ps(Load(), v.Load()));
+#else
     return Vector3f(x + v.x, y + v.y, z + v.z);
+#endif
 }
 
 inline const Vector3f&
 Vector3f::operator+=(const Vector3f& v)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this + v;
+#else
     x += v.x;
     y += v.y;
     z += v.z;
+#endif
     return *this;
 }
 
@@ -257,79 +371,123 @@ Vector3f::operator+() const
 inline Vector3f
 Vector3f::operator-(const Vector3f& v) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_sub_ps(Load(), v.Load()));
+#else
     return Vector3f(x - v.x, y - v.y, z - v.z);
+#endif
 }
 
 inline Vector3f&
 Vector3f::operator-=(const Vector3f& v)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this - v;
+#else
     x -= v.x;
     y -= v.y;
     z -= v.z;
+#endif
     return *this;
 }
 
 inline Vector3f
 Vector3f::operator-() const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_sub_ps(_mm_setzero_ps(), Load()));
+#else
     return Vector3f(-x, -y, -z);
+#endif
 }
 
 inline Vector3f Vector3f::operator*(const Vector3f& v) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_mul_ps(Load(), v.Load()));
+#else
     return Vector3f(x * v.x, y * v.y, z * v.z);
+#endif
 }
 
 inline Vector3f Vector3f::operator*(float c) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_mul_ps(Load(), _mm_set1_ps(c)));
+#else
     return Vector3f(x * c, y * c, z * c);
+#endif
 }
 
 inline const Vector3f&
 Vector3f::operator*=(const Vector3f& v)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this * v;
+#else
     x *= v.x;
     y *= v.y;
     z *= v.z;
+#endif
     return *this;
 }
 
 inline const Vector3f&
 Vector3f::operator*=(float c)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this * c;
+#else
     x *= c;
     y *= c;
     z *= c;
+#endif
     return *this;
 }
 
 inline Vector3f
 Vector3f::operator/(const Vector3f& v) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_div_ps(Load(), v.Load()));
+#else
     return Vector3f(x / v.x, y / v.y, z / v.z);
+#endif
 }
 
 inline Vector3f
 Vector3f::operator/(float c) const
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_div_ps(Load(), _mm_set1_ps(c)));
+#else
     return Vector3f(x / c, y / c, z / c);
+#endif
 }
 
 inline const Vector3f&
 Vector3f::operator/=(const Vector3f& v)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this / v;
+#else
     x /= v.x;
     y /= v.y;
     z /= v.z;
+#endif
     return *this;
 }
 
 inline const Vector3f&
 Vector3f::operator/=(float c)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    *this = *this / c;
+#else
     x /= c;
     y /= c;
     z /= c;
+#endif
     return *this;
 }
 
@@ -353,7 +511,11 @@ inline Vector3f operator*(float c, const Vector3f& v)
 inline Vector3f
 operator/(float c, const Vector3f& v)
 {
+#if defined(PETRICHOR_VECTOR3F_SIMD)
+    return Vector3f::FromSIMD(_mm_div_ps(_mm_set1_ps(c), v.Load()));
+#else
     return Vector3f(c / v.x, c / v.y, c / v.z);
+#endif
 }
 
 inline std::ostream&
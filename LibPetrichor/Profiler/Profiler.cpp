@@ -1,6 +1,189 @@
 #include "Profiler/Profiler.h"
 
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace Petrichor
 {
 
+namespace
+{
+
+//! スレッドごとのイベントのリングバッファ
+struct ThreadEventBuffer
+{
+    std::vector<ProfileEvent> events;
+    uint64_t numRecordedEvents = 0; //!< これまでに記録したイベント数
+    uint32_t threadID = 0;
+    std::string threadName;
+};
+
+//! 全スレッドのバッファを保持する
+//! 終了したスレッドのバッファはイベントを保持したまま次のスレッドに再利用される
+struct BufferRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadEventBuffer>> buffers;
+    std::vector<ThreadEventBuffer*> freeBuffers;
+
+    static BufferRegistry&
+    GetInstance()
+    {
+        static BufferRegistry registry;
+        return registry;
+    }
+};
+
+//! スレッド終了時にバッファを登録簿に返却する
+struct ThreadLocalBuffer
+{
+    ~ThreadLocalBuffer()
+    {
+        if (buffer)
+        {
+            BufferRegistry& registry = BufferRegistry::GetInstance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.freeBuffers.emplace_back(buffer);
+        }
+    }
+
+    ThreadEventBuffer* buffer = nullptr;
+};
+
+ThreadEventBuffer&
+GetThreadEventBuffer()
+{
+    thread_local ThreadLocalBuffer threadLocalBuffer;
+    if (threadLocalBuffer.buffer == nullptr)
+    {
+        BufferRegistry& registry = BufferRegistry::GetInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.freeBuffers.empty())
+        {
+            auto buffer = std::make_unique<ThreadEventBuffer>();
+            buffer->events.resize(Profiler::kNumEventsPerThread);
+            buffer->threadID = static_cast<uint32_t>(registry.buffers.size());
+            registry.buffers.emplace_back(std::move(buffer));
+            threadLocalBuffer.buffer = registry.buffers.back().get();
+        }
+        else
+        {
+            threadLocalBuffer.buffer = registry.freeBuffers.back();
+            registry.freeBuffers.pop_back();
+        }
+    }
+
+    return *threadLocalBuffer.buffer;
+}
+
+//! JSON文字列用にエスケープする
+std::string
+EscapeJsonString(const char* str)
+{
+    std::string escaped;
+    for (const char* c = str; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += *c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+void
+Profiler::Record(const char* name, int64_t beginNs, int64_t endNs)
+{
+    ThreadEventBuffer& buffer = GetThreadEventBuffer();
+    ProfileEvent& event =
+      buffer.events[buffer.numRecordedEvents % kNumEventsPerThread];
+    event.name = name;
+    event.beginNs = beginNs;
+    event.endNs = endNs;
+    buffer.numRecordedEvents++;
+}
+
+void
+Profiler::SetThreadName(const std::string& threadName)
+{
+    GetThreadEventBuffer().threadName = threadName;
+}
+
+void
+Profiler::Clear()
+{
+    BufferRegistry& registry = BufferRegistry::GetInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& buffer : registry.buffers)
+    {
+        buffer->numRecordedEvents = 0;
+    }
+}
+
+bool
+Profiler::ExportChromeTrace(const std::filesystem::path& path)
+{
+    std::ofstream file(path, std::ios::out);
+    if (file.fail())
+    {
+        return false;
+    }
+
+    BufferRegistry& registry = BufferRegistry::GetInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool isFirstEvent = true;
+    const auto beginEvent = [&] {
+        if (!isFirstEvent)
+        {
+            file << ",\n";
+        }
+        isFirstEvent = false;
+    };
+
+    for (const auto& buffer : registry.buffers)
+    {
+        if (!buffer->threadName.empty())
+        {
+            beginEvent();
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                 << "\"tid\":" << buffer->threadID << ",\"args\":{\"name\":\""
+                 << EscapeJsonString(buffer->threadName.c_str()) << "\"}}";
+        }
+
+        // リングバッファが一周している場合は古いイベントから書き出す
+        const uint64_t numEvents =
+          std::min<uint64_t>(buffer->numRecordedEvents, kNumEventsPerThread);
+        const uint64_t firstEventIndex = buffer->numRecordedEvents - numEvents;
+        for (uint64_t index = firstEventIndex;
+             index < buffer->numRecordedEvents;
+             index++)
+        {
+            const ProfileEvent& event =
+              buffer->events[index % kNumEventsPerThread];
+
+            // trace_eventの時刻の単位はマイクロ秒
+            beginEvent();
+            file << "{\"name\":\"" << EscapeJsonString(event.name)
+                 << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadID
+                 << ",\"ts\":" << event.beginNs / 1000 << "."
+                 << (event.beginNs % 1000) / 100
+                 << ",\"dur\":" << (event.endNs - event.beginNs) / 1000 << "."
+                 << ((event.endNs - event.beginNs) % 1000) / 100 << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return !file.fail();
+}
+
 } // namespace Petrichor
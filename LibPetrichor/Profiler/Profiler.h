@@ -1,10 +1,123 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
 namespace Petrichor
 {
+
+//! スコープ単位の計測イベント
+struct ProfileEvent
+{
+    //! イベント名 (文字列リテラルなど、寿命が静的な文字列であること)
+    const char* name = nullptr;
+
+    int64_t beginNs = 0; //!< 開始時刻[ns]
+    int64_t endNs = 0;   //!< 終了時刻[ns]
+};
+
+//! 階層的なスコーププロファイラ
+//! スレッドごとのリングバッファにイベントを記録し、
+//! Chromeのtrace_event形式(chrome://tracing, Perfetto)で書き出す。
+//! バッファへの書き込みは各スレッドからロック無しで行うため、
+//! 書き出しとクリアは計測対象のスレッドが停止している間に行うこと。
 class Profiler
 {
 public:
+    //! スレッドごとに保持するイベント数
+    static constexpr size_t kNumEventsPerThread = 1 << 16;
+
+    //! 計測を有効/無効にする
+    static void
+    SetEnabled(bool isEnabled)
+    {
+        s_isEnabled.store(isEnabled, std::memory_order_relaxed);
+    }
+
+    //! 計測が有効か
+    static bool
+    IsEnabled()
+    {
+        return s_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    //! 計測開始からの経過時間[ns]を取得
+    static int64_t
+    GetTimestampNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 std::chrono::steady_clock::now() - s_epoch)
+          .count();
+    }
+
+    //! 呼び出し元スレッドのバッファにイベントを記録する
+    static void
+    Record(const char* name, int64_t beginNs, int64_t endNs);
+
+    //! 呼び出し元スレッドの名前を設定する
+    static void
+    SetThreadName(const std::string& threadName);
+
+    //! 全スレッドのイベントを破棄する
+    static void
+    Clear();
+
+    //! 全スレッドのイベントをChromeのtrace_event形式で書き出す
+    //! @return 書き出しに成功したか
+    static bool
+    ExportChromeTrace(const std::filesystem::path& path);
+
+private:
+    static inline std::atomic<bool> s_isEnabled = false;
+    static inline const std::chrono::steady_clock::time_point s_epoch =
+      std::chrono::steady_clock::now();
+};
+
+//! スコープの開始から終了までを記録する
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+      : m_name(name)
+      , m_beginNs(Profiler::IsEnabled() ? Profiler::GetTimestampNs() : -1)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_beginNs >= 0)
+        {
+            Profiler::Record(m_name, m_beginNs, Profiler::GetTimestampNs());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope&
+    operator=(const ProfileScope&) = delete;
+
 private:
+    const char* m_name;
+    int64_t m_beginNs;
 };
+
 } // namespace Petrichor
+
+// PETRICHOR_ENABLE_PROFILER が未定義の場合、計測用のマクロは何もしない
+#define PETRICHOR_PROFILER_CONCAT_IMPL(x, y) x##y
+#define PETRICHOR_PROFILER_CONCAT(x, y) PETRICHOR_PROFILER_CONCAT_IMPL(x, y)
+
+#if defined(PETRICHOR_ENABLE_PROFILER)
+#define PROFILE_SCOPE(name)                                                    \
+    ::Petrichor::ProfileScope PETRICHOR_PROFILER_CONCAT(profileScope,          \
+                                                        __COUNTER__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(threadName)                                        \
+    ::Petrichor::Profiler::SetThreadName(threadName)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_THREAD_NAME(threadName) ((void)0)
+#endif
@@ -0,0 +1,111 @@
+#include "Profiler/RayStatistics.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Petrichor
+{
+
+namespace
+{
+
+//! 全スレッドのカウンタを保持する
+//! 終了したスレッドのカウンタは値を保持したまま次のスレッドに再利用される
+struct CounterRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<RayStatistics>> counters;
+    std::vector<RayStatistics*> freeCounters;
+
+    static CounterRegistry&
+    GetInstance()
+    {
+        static CounterRegistry registry;
+        return registry;
+    }
+};
+
+//! スレッド終了時にカウンタを登録簿に返却する
+struct ThreadLocalCounter
+{
+    ~ThreadLocalCounter()
+    {
+        if (counter)
+        {
+            CounterRegistry& registry = CounterRegistry::GetInstance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.freeCounters.emplace_back(counter);
+        }
+    }
+
+    RayStatistics* counter = nullptr;
+};
+
+} // namespace
+
+RayStatistics&
+RayStatistics::operator+=(const RayStatistics& rhs)
+{
+    numRays += rhs.numRays;
+    for (size_t index = 0; index < numRaysPerType.size(); index++)
+    {
+        numRaysPerType[index] += rhs.numRaysPerType[index];
+    }
+    numNodeVisits += rhs.numNodeVisits;
+    numAABBTests += rhs.numAABBTests;
+    numPrimitiveTests += rhs.numPrimitiveTests;
+    numBounces += rhs.numBounces;
+    return *this;
+}
+
+RayStatistics&
+RayStatisticsCounter::GetThreadLocal()
+{
+    thread_local ThreadLocalCounter threadLocalCounter;
+    if (threadLocalCounter.counter == nullptr)
+    {
+        CounterRegistry& registry = CounterRegistry::GetInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.freeCounters.empty())
+        {
+            registry.counters.emplace_back(std::make_unique<RayStatistics>());
+            threadLocalCounter.counter = registry.counters.back().get();
+        }
+        else
+        {
+            threadLocalCounter.counter = registry.freeCounters.back();
+            registry.freeCounters.pop_back();
+        }
+    }
+
+    return *threadLocalCounter.counter;
+}
+
+RayStatistics
+RayStatisticsCounter::Aggregate()
+{
+    CounterRegistry& registry = CounterRegistry::GetInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    RayStatistics result;
+    for (const auto& counter : registry.counters)
+    {
+        result += *counter;
+    }
+    return result;
+}
+
+void
+RayStatisticsCounter::Reset()
+{
+    CounterRegistry& registry = CounterRegistry::GetInstance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (auto& counter : registry.counters)
+    {
+        *counter = RayStatistics{};
+    }
+}
+
+} // namespace Petrichor
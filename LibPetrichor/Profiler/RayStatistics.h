@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Core/Ray.h"
+#include <array>
+#include <cstdint>
+
+namespace Petrichor
+{
+
+//! レイのトラバーサル統計
+struct RayStatistics
+{
+    //! 交差判定したレイの数
+    uint64_t numRays = 0;
+
+    //! レイの種類ごとの交差判定数
+    std::array<uint64_t, Core::kNumRayTypes> numRaysPerType{};
+
+    uint64_t numNodeVisits = 0;     //!< 訪問したBVHノード数
+    uint64_t numAABBTests = 0;      //!< AABBとの交差判定回数
+    uint64_t numPrimitiveTests = 0; //!< プリミティブとの交差判定回数
+    uint64_t numBounces = 0;        //!< 反射回数
+
+    //! レイを1本記録する
+    void
+    AddRay(Core::RayTypes rayType)
+    {
+        numRays++;
+        numRaysPerType[static_cast<size_t>(rayType)]++;
+    }
+
+    //! トラバーサルコスト(ノード訪問数 + プリミティブとの交差判定回数)
+    uint64_t
+    GetTraversalCost() const
+    {
+        return numNodeVisits + numPrimitiveTests;
+    }
+
+    RayStatistics&
+    operator+=(const RayStatistics& rhs);
+};
+
+//! スレッドごとのレイ統計カウンタ
+//! 各スレッドは自スレッドのカウンタにのみ書き込む。
+//! 集計とリセットはレンダリングスレッドが停止している間に行うこと。
+class RayStatisticsCounter
+{
+public:
+    //! 呼び出し元スレッドのカウンタを取得
+    static RayStatistics&
+    GetThreadLocal();
+
+    //! 全スレッドのカウンタを集計する
+    static RayStatistics
+    Aggregate();
+
+    //! 全スレッドのカウンタをリセットする
+    static void
+    Reset();
+};
+
+} // namespace Petrichor
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Petrichor
+{
+namespace Math
+{
+
+//! カウンタベースの乱数
+//! (キー, カウンタ) をハッシュして乱数を作るので、内部状態は持たない。
+//! 同じキーとカウンタからは、どのスレッドでいつ引いても同じ値が得られる
+class CounterBasedRandom
+{
+public:
+    CounterBasedRandom() = default;
+
+    explicit CounterBasedRandom(uint64_t key, uint32_t counter = 0)
+      : m_key(key)
+      , m_counter(counter){};
+
+    //! 64bit のハッシュ(SplitMix64 の出力関数)
+    static constexpr uint64_t
+    Hash(uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    //! 値の組から乱数列のキーを作る
+    static constexpr uint64_t
+    MakeKey(uint32_t seed, uint32_t a, uint32_t b, uint32_t c)
+    {
+        uint64_t key = Hash(seed);
+        key = Hash(key ^ a);
+        key = Hash(key ^ b);
+        return Hash(key ^ c);
+    }
+
+    uint32_t
+    random()
+    {
+        // カウンタを黄金比の定数で飛ばしてからハッシュする(SplitMix64)
+        const uint64_t x = m_key + (m_counter + 1ull) * 0x9E3779B97F4A7C15ull;
+        m_counter++;
+        return static_cast<uint32_t>(Hash(x) >> 32);
+    }
+
+    //! [0, 1) の一様乱数
+    float
+    next()
+    {
+        // float の仮数部に収まる上位 24bit だけを使う
+        return static_cast<float>(random() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    uint64_t
+    GetKey() const
+    {
+        return m_key;
+    }
+
+    //! これまでに引いた乱数の個数(次元)
+    uint32_t
+    GetCounter() const
+    {
+        return m_counter;
+    }
+
+private:
+    uint64_t m_key = 0;
+    uint32_t m_counter = 0;
+};
+
+} // namespace Math
+} // namespace Petrichor
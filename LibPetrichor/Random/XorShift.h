@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <array>
 #include <climits>
 #include <random>
 
@@ -51,6 +52,24 @@ public:
         return random() / static_cast<float>(max());
     }
 
+    //! 内部状態(チェックポイントへの保存用)
+    using State = std::array<unsigned, 4>;
+
+    State
+    GetState() const
+    {
+        return { x, y, z, w };
+    }
+
+    void
+    SetState(const State& state)
+    {
+        x = state[0];
+        y = state[1];
+        z = state[2];
+        w = state[3];
+    }
+
 private:
     unsigned x = 123456789u;
     unsigned y = 362436069u;
@@ -1,5 +1,10 @@
 #include "TestScene.h"
 
+#include "Random/XorShift.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
 namespace Petrichor
 {
 namespace Core
@@ -15,32 +20,35 @@ LoadCornellBoxScene(Scene* scene)
 
     scene->LoadRenderSetting("Resource/SampleScene/CornellBox/settings.json");
 
-    const auto* matLambertRed = new Lambert(Color3f(1.0f, 0, 0));
-    const auto* matLambertGreen = new Lambert(Color3f(0, 1.0f, 0));
-    const auto* matLamberWhite = new Lambert(Color3f::One());
-    const auto* matEmissionWhite = new Emission(Color3f::One());
+    const auto* matLambertRed =
+      scene->CreateResource<Lambert>(Color3f(1.0f, 0, 0));
+    const auto* matLambertGreen =
+      scene->CreateResource<Lambert>(Color3f(0, 1.0f, 0));
+    const auto* matLamberWhite = scene->CreateResource<Lambert>(Color3f::One());
+    const auto* matEmissionWhite =
+      scene->CreateResource<Emission>(Color3f::One());
 
-    auto const leftWall = new Mesh();
+    auto const leftWall = scene->CreateResource<Mesh>();
     leftWall->Load("Resource/SampleScene/CornellBox/LeftWall.obj",
                    matLambertRed,
                    ShadingTypes::Flat);
 
-    auto const rightWall = new Mesh();
+    auto const rightWall = scene->CreateResource<Mesh>();
     rightWall->Load("Resource/SampleScene/CornellBox/RightWall.obj",
                     matLambertGreen,
                     ShadingTypes::Flat);
 
-    auto const whiteWall = new Mesh();
+    auto const whiteWall = scene->CreateResource<Mesh>();
     whiteWall->Load("Resource/SampleScene/CornellBox/WhiteWall.obj",
                     matLamberWhite,
                     ShadingTypes::Flat);
 
-    auto const whiteBox = new Mesh();
+    auto const whiteBox = scene->CreateResource<Mesh>();
     whiteBox->Load("Resource/SampleScene/CornellBox/WhiteBox.obj",
                    matLamberWhite,
                    ShadingTypes::Flat);
 
-    auto const ceilLight = new Mesh();
+    auto const ceilLight = scene->CreateResource<Mesh>();
     ceilLight->Load("Resource/SampleScene/CornellBox/CeilLight.obj",
                     matEmissionWhite,
                     ShadingTypes::Flat);
@@ -58,10 +66,242 @@ LoadCornellBoxScene(Scene* scene)
     scene->SetMainCamera(std::move(camera));
 
     // レンダリング先を指定
-    auto targetTex =
-      std::make_unique<Texture2D>(scene->GetRenderSetting().outputWidth,
-                                  scene->GetRenderSetting().outputHeight);
-    scene->SetTargetTexture(Scene::AOVType::Rendered, targetTex.get());
+    auto* const targetTex =
+      scene->CreateResource<Texture2D>(scene->GetRenderSetting().outputWidth,
+                                       scene->GetRenderSetting().outputHeight);
+    scene->SetTargetTexture(Scene::AOVType::Rendered, targetTex);
+}
+
+namespace
+{
+
+using Indices = std::vector<std::array<uint32_t, 3>>;
+
+//! 4頂点からなる四角形を追加する
+void
+AppendQuad(const std::array<Math::Vector3f, 4>& corners,
+           std::vector<Vertex>* vertices,
+           Indices* indices)
+{
+    const auto offset = static_cast<uint32_t>(vertices->size());
+    for (const auto& corner : corners)
+    {
+        vertices->emplace_back(corner.x, corner.y, corner.z);
+    }
+    indices->push_back({ offset, offset + 1, offset + 2 });
+    indices->push_back({ offset, offset + 2, offset + 3 });
+}
+
+//! 軸に沿った直方体を追加する
+void
+AppendBox(const Math::Vector3f& lower,
+          const Math::Vector3f& upper,
+          std::vector<Vertex>* vertices,
+          Indices* indices)
+{
+    // i番目の頂点は、iの各ビットが立っている軸でupper側の座標をとる
+    const auto corner = [&](int i) {
+        return Math::Vector3f((i & 1) ? upper.x : lower.x,
+                              (i & 2) ? upper.y : lower.y,
+                              (i & 4) ? upper.z : lower.z);
+    };
+
+    constexpr std::array<std::array<int, 4>, 6> kFaces = { {
+      { 0, 1, 3, 2 },
+      { 4, 5, 7, 6 },
+      { 0, 1, 5, 4 },
+      { 2, 3, 7, 6 },
+      { 0, 2, 6, 4 },
+      { 1, 3, 7, 5 },
+    } };
+
+    for (const auto& face : kFaces)
+    {
+        AppendQuad({ corner(face[0]),
+                     corner(face[1]),
+                     corner(face[2]),
+                     corner(face[3]) },
+                   vertices,
+                   indices);
+    }
+}
+
+//! 1つのマテリアルからなるメッシュをシーン上に生成する
+const Mesh&
+CreateMesh(Scene* scene,
+           std::vector<Vertex> vertices,
+           const Indices& indices,
+           const MaterialBase* material)
+{
+    Mesh* const mesh = scene->CreateResource<Mesh>();
+    mesh->Build(std::move(vertices), indices, material);
+    return *mesh;
+}
+
+//! 原点を注視するカメラを設定する
+void
+SetCamera(Scene* scene)
+{
+    auto camera = std::make_unique<Camera>(Math::Vector3f(0, -6.0f, 0),
+                                           Math::Vector3f::UnitY());
+    camera->FocusTo(Math::Vector3f::Zero());
+    scene->SetMainCamera(std::move(camera));
+}
+
+} // namespace
+
+void
+LoadProceduralCornellBoxScene(Scene* scene)
+{
+    if (scene == nullptr)
+    {
+        return;
+    }
+
+    using Math::Vector3f;
+
+    scene->CreateMaterial<Lambert>("red", Color3f(1.0f, 0, 0));
+    scene->CreateMaterial<Lambert>("green", Color3f(0, 1.0f, 0));
+    scene->CreateMaterial<Lambert>("white", Color3f::One());
+    scene->CreateMaterial<Emission>("light", Color3f::One());
+
+    // 左の壁
+    {
+        std::vector<Vertex> vertices;
+        Indices indices;
+        AppendQuad({ Vector3f(-1, -1, -1),
+                     Vector3f(-1, 1, -1),
+                     Vector3f(-1, 1, 1),
+                     Vector3f(-1, -1, 1) },
+                   &vertices,
+                   &indices);
+        scene->AppendMesh(CreateMesh(scene,
+                                     std::move(vertices),
+                                     indices,
+                                     scene->GetMaterial("red")));
+    }
+
+    // 右の壁
+    {
+        std::vector<Vertex> vertices;
+        Indices indices;
+        AppendQuad({ Vector3f(1, -1, -1),
+                     Vector3f(1, 1, -1),
+                     Vector3f(1, 1, 1),
+                     Vector3f(1, -1, 1) },
+                   &vertices,
+                   &indices);
+        scene->AppendMesh(CreateMesh(scene,
+                                     std::move(vertices),
+                                     indices,
+                                     scene->GetMaterial("green")));
+    }
+
+    // 床, 天井, 奥の壁, 箱
+    {
+        std::vector<Vertex> vertices;
+        Indices indices;
+        AppendQuad({ Vector3f(-1, -1, -1),
+                     Vector3f(1, -1, -1),
+                     Vector3f(1, 1, -1),
+                     Vector3f(-1, 1, -1) },
+                   &vertices,
+                   &indices);
+        AppendQuad({ Vector3f(-1, -1, 1),
+                     Vector3f(1, -1, 1),
+                     Vector3f(1, 1, 1),
+                     Vector3f(-1, 1, 1) },
+                   &vertices,
+                   &indices);
+        AppendQuad({ Vector3f(-1, 1, -1),
+                     Vector3f(1, 1, -1),
+                     Vector3f(1, 1, 1),
+                     Vector3f(-1, 1, 1) },
+                   &vertices,
+                   &indices);
+        AppendBox(Vector3f(-0.6f, -0.2f, -1.0f),
+                  Vector3f(0.0f, 0.4f, 0.2f),
+                  &vertices,
+                  &indices);
+        AppendBox(Vector3f(0.1f, -0.6f, -1.0f),
+                  Vector3f(0.6f, -0.1f, -0.4f),
+                  &vertices,
+                  &indices);
+        scene->AppendMesh(CreateMesh(scene,
+                                     std::move(vertices),
+                                     indices,
+                                     scene->GetMaterial("white")));
+    }
+
+    // 天井の光源
+    {
+        std::vector<Vertex> vertices;
+        Indices indices;
+        AppendQuad({ Vector3f(-0.3f, -0.3f, 0.99f),
+                     Vector3f(0.3f, -0.3f, 0.99f),
+                     Vector3f(0.3f, 0.3f, 0.99f),
+                     Vector3f(-0.3f, 0.3f, 0.99f) },
+                   &vertices,
+                   &indices);
+        scene->AppendLightMesh(CreateMesh(scene,
+                                          std::move(vertices),
+                                          indices,
+                                          scene->GetMaterial("light")));
+    }
+
+    SetCamera(scene);
+}
+
+void
+LoadRandomTrianglesScene(Scene* scene, int numTriangles, unsigned seed)
+{
+    if (scene == nullptr || numTriangles <= 0)
+    {
+        return;
+    }
+
+    scene->CreateMaterial<Lambert>("default", Color3f::One());
+
+    Math::XorShift128 random(seed);
+    const auto nextFloat = [&random](float lower, float upper) {
+        return lower + (upper - lower) * random.next();
+    };
+
+    // 三角形の大きさはおおよそ平均間隔程度にする
+    const float size = 2.0f / std::cbrt(static_cast<float>(numTriangles));
+
+    std::vector<Vertex> vertices;
+    vertices.reserve(3ll * numTriangles);
+    Indices indices;
+    indices.reserve(numTriangles);
+    for (int triangleIndex = 0; triangleIndex < numTriangles; triangleIndex++)
+    {
+        const Math::Vector3f center(nextFloat(-1.0f, 1.0f),
+                                    nextFloat(-1.0f, 1.0f),
+                                    nextFloat(-1.0f, 1.0f));
+
+        const auto offset = static_cast<uint32_t>(vertices.size());
+        for (int vertexIndex = 0; vertexIndex < 3; vertexIndex++)
+        {
+            const Math::Vector3f pos =
+              center + Math::Vector3f(nextFloat(-size, size),
+                                      nextFloat(-size, size),
+                                      nextFloat(-size, size));
+            vertices.emplace_back(pos.x, pos.y, pos.z);
+        }
+        indices.push_back({ offset, offset + 1, offset + 2 });
+    }
+
+    scene->AppendMesh(CreateMesh(scene,
+                                 std::move(vertices),
+                                 indices,
+                                 scene->GetMaterial("default")));
+
+    Environment environment;
+    environment.SetBaseColor(Color3f::One());
+    scene->SetEnvironment(environment);
+
+    SetCamera(scene);
 }
 
 } // namespace Core
@@ -12,5 +12,15 @@ namespace Core
 void
 LoadCornellBoxScene(Scene* scene);
 
+//! 外部リソースを使わずにCornell boxを生成する
+void
+LoadProceduralCornellBoxScene(Scene* scene);
+
+//! [-1, 1]^3の範囲にランダムに配置した三角形群のシーンを生成する
+//! @param numTriangles 三角形の個数
+//! @param seed 乱数のシード
+void
+LoadRandomTrianglesScene(Scene* scene, int numTriangles, unsigned seed = 0);
+
 } // namespace Core
 } // namespace Petrichor
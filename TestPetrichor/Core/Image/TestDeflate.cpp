@@ -0,0 +1,436 @@
+#include "Core/Image/Deflate.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using namespace Petrichor::Core;
+
+//! テスト用の Inflate(RFC 1951)
+//! CompressDeflate が出力する非圧縮ブロックと固定ハフマン符号のブロックだけを
+//! 展開する(動的ハフマン符号のブロックは失敗とする)
+class Inflater
+{
+public:
+    Inflater(const uint8_t* data, size_t size)
+      : m_data(data)
+      , m_size(size)
+    {
+    }
+
+    //! 最終ブロックまで展開する
+    //! @param out 展開結果を末尾に追加する
+    //! @return 正しく展開できたか
+    bool
+    Inflate(std::vector<uint8_t>* out)
+    {
+        for (;;)
+        {
+            const bool isFinal = ReadBits(1) != 0;
+            const uint32_t blockType = ReadBits(2);
+            if (blockType == 0)
+            {
+                InflateStored(out);
+            }
+            else if (blockType == 1)
+            {
+                InflateFixed(out);
+            }
+            else
+            {
+                return false;
+            }
+
+            if (m_isInvalid)
+            {
+                return false;
+            }
+            if (isFinal)
+            {
+                return true;
+            }
+        }
+    }
+
+    //! 読み終えたバイト数(最終ブロックの末尾はバイト境界まで読む)
+    size_t
+    GetNumReadBytes() const
+    {
+        return (m_bitPos + 7) / 8;
+    }
+
+private:
+    uint32_t
+    ReadBits(int numBits)
+    {
+        uint32_t bits = 0;
+        for (int i = 0; i < numBits; i++)
+        {
+            bits |= ReadBit() << i;
+        }
+        return bits;
+    }
+
+    //! ハフマン符号は MSB から詰められている
+    uint32_t
+    ReadCode(uint32_t code, int numBits)
+    {
+        for (int i = 0; i < numBits; i++)
+        {
+            code = (code << 1) | ReadBit();
+        }
+        return code;
+    }
+
+    uint32_t
+    ReadBit()
+    {
+        if (m_size * 8 <= m_bitPos)
+        {
+            m_isInvalid = true;
+            return 0;
+        }
+        const uint32_t bit = (m_data[m_bitPos / 8] >> (m_bitPos % 8)) & 1;
+        m_bitPos++;
+        return bit;
+    }
+
+    void
+    InflateStored(std::vector<uint8_t>* out)
+    {
+        m_bitPos = (m_bitPos + 7) / 8 * 8;
+        const uint32_t length = ReadBits(16);
+        const uint32_t complement = ReadBits(16);
+        if ((length ^ 0xFFFF) != complement)
+        {
+            m_isInvalid = true;
+            return;
+        }
+        for (uint32_t i = 0; i < length && !m_isInvalid; i++)
+        {
+            out->push_back(static_cast<uint8_t>(ReadBits(8)));
+        }
+    }
+
+    //! RFC 1951 3.2.6 の固定ハフマン符号のリテラル・長さの符号を読む
+    int
+    ReadFixedLiteral()
+    {
+        const uint32_t code7 = ReadCode(0, 7);
+        if (code7 <= 0x17)
+        {
+            return 256 + code7;
+        }
+
+        const uint32_t code8 = ReadCode(code7, 1);
+        if (0x30 <= code8 && code8 <= 0xBF)
+        {
+            return code8 - 0x30;
+        }
+        if (0xC0 <= code8 && code8 <= 0xC7)
+        {
+            return 280 + (code8 - 0xC0);
+        }
+
+        const uint32_t code9 = ReadCode(code8, 1);
+        return 144 + (code9 - 0x190);
+    }
+
+    void
+    InflateFixed(std::vector<uint8_t>* out)
+    {
+        static constexpr std::array<uint16_t, 29> kLengthBases = {
+            3,  4,  5,  6,  7,  8,  9,  10,  11,  13,  15,  17,  19,  23, 27,
+            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        static constexpr std::array<uint8_t, 29> kLengthExtraBits = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        static constexpr std::array<uint16_t, 30> kDistanceBases = {
+            1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+            33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        static constexpr std::array<uint8_t, 30> kDistanceExtraBits = {
+            0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+
+        while (!m_isInvalid)
+        {
+            const int symbol = ReadFixedLiteral();
+            if (symbol < 256)
+            {
+                out->push_back(static_cast<uint8_t>(symbol));
+                continue;
+            }
+            if (symbol == 256)
+            {
+                return;
+            }
+
+            // 長さの拡張ビットは距離の符号より前にある
+            const auto lengthSymbol = static_cast<size_t>(symbol - 257);
+            if (kLengthBases.size() <= lengthSymbol)
+            {
+                m_isInvalid = true;
+                return;
+            }
+            const uint32_t length = kLengthBases[lengthSymbol] +
+                                    ReadBits(kLengthExtraBits[lengthSymbol]);
+
+            const uint32_t distanceSymbol = ReadCode(0, 5);
+            if (kDistanceBases.size() <= distanceSymbol)
+            {
+                m_isInvalid = true;
+                return;
+            }
+            const uint32_t distance =
+              kDistanceBases[distanceSymbol] +
+              ReadBits(kDistanceExtraBits[distanceSymbol]);
+            if (distance > 32768 || out->size() < distance)
+            {
+                m_isInvalid = true;
+                return;
+            }
+
+            // 重なりのあるコピーがあるので1バイトずつ
+            for (uint32_t i = 0; i < length; i++)
+            {
+                out->push_back((*out)[out->size() - distance]);
+            }
+        }
+    }
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_bitPos = 0;
+    bool m_isInvalid = false;
+};
+
+class DeflateTest : public ::testing::Test
+{
+protected:
+    static std::vector<uint8_t>
+    ToBytes(const std::string& text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    static std::vector<uint8_t>
+    MakeRandomBytes(size_t size, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        std::vector<uint8_t> bytes(size);
+        for (uint8_t& value : bytes)
+        {
+            value = static_cast<uint8_t>(byte(rng));
+        }
+        return bytes;
+    }
+
+    //! 展開して元のデータと一致するか確かめる
+    static void
+    ExpectRoundTrip(const std::vector<uint8_t>& input)
+    {
+        std::vector<uint8_t> compressed;
+        CompressDeflate(input.data(), input.size(), true, &compressed);
+
+        std::vector<uint8_t> inflated;
+        Inflater inflater(compressed.data(), compressed.size());
+        ASSERT_TRUE(inflater.Inflate(&inflated));
+        EXPECT_EQ(inflater.GetNumReadBytes(), compressed.size());
+        EXPECT_EQ(inflated, input);
+    }
+
+    //! Adler-32 を定義どおりに1バイトずつ計算する
+    static uint32_t
+    CalcAdler32Naive(const std::vector<uint8_t>& data)
+    {
+        uint32_t sum1 = 1;
+        uint32_t sum2 = 0;
+        for (uint8_t value : data)
+        {
+            sum1 = (sum1 + value) % 65521;
+            sum2 = (sum2 + sum1) % 65521;
+        }
+        return (sum2 << 16) | sum1;
+    }
+};
+
+TEST_F(DeflateTest, RoundTripEmpty)
+{
+    ExpectRoundTrip({});
+}
+
+TEST_F(DeflateTest, RoundTripOneByte)
+{
+    ExpectRoundTrip({ 0x00 });
+    ExpectRoundTrip({ 0xFF });
+}
+
+TEST_F(DeflateTest, RoundTripIncompressible)
+{
+    ExpectRoundTrip(MakeRandomBytes(100000, 1234));
+}
+
+TEST_F(DeflateTest, RoundTripLongRun)
+{
+    // 最長の一致(258)と距離 1 の重なったコピーが続く
+    ExpectRoundTrip(std::vector<uint8_t>(100000, 0x80));
+
+    std::vector<uint8_t> runs;
+    for (int value = 0; value < 256; value++)
+    {
+        runs.insert(runs.end(), 300 + value, static_cast<uint8_t>(value));
+    }
+    ExpectRoundTrip(runs);
+}
+
+TEST_F(DeflateTest, RoundTripDistantRepeats)
+{
+    // ウィンドウ(32KiB)の内側と外側にある繰り返し
+    const std::vector<uint8_t> block = MakeRandomBytes(20000, 5678);
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 4; i++)
+    {
+        input.insert(input.end(), block.begin(), block.end());
+        const std::vector<uint8_t> gap = MakeRandomBytes(5000 * i, i);
+        input.insert(input.end(), gap.begin(), gap.end());
+    }
+    ExpectRoundTrip(input);
+
+    ExpectRoundTrip(ToBytes("abcabcabcabcabcabcabcxyzabcxyzabcxyz"));
+}
+
+TEST_F(DeflateTest, ConcatenatedSyncFlushedStreams)
+{
+    const std::vector<std::vector<uint8_t>> parts = {
+        MakeRandomBytes(3000, 1),
+        std::vector<uint8_t>(5000, 0x11),
+        {},
+        { 0x42 },
+        ToBytes("The quick brown fox jumps over the lazy dog. "
+                "The quick brown fox jumps over the lazy dog."),
+        MakeRandomBytes(40000, 2),
+    };
+
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> compressed;
+    for (size_t partIndex = 0; partIndex < parts.size(); partIndex++)
+    {
+        const std::vector<uint8_t>& part = parts[partIndex];
+        const bool isFinal = partIndex + 1 == parts.size();
+
+        std::vector<uint8_t> partCompressed;
+        CompressDeflate(part.data(), part.size(), isFinal, &partCompressed);
+        if (!isFinal)
+        {
+            // 空の非圧縮ブロックでバイト境界に揃えて終わる
+            ASSERT_GE(partCompressed.size(), 4u);
+            EXPECT_EQ(std::vector<uint8_t>(partCompressed.end() - 4,
+                                           partCompressed.end()),
+                      std::vector<uint8_t>({ 0x00, 0x00, 0xFF, 0xFF }));
+        }
+
+        compressed.insert(
+          compressed.end(), partCompressed.begin(), partCompressed.end());
+        expected.insert(expected.end(), part.begin(), part.end());
+    }
+
+    std::vector<uint8_t> inflated;
+    Inflater inflater(compressed.data(), compressed.size());
+    ASSERT_TRUE(inflater.Inflate(&inflated));
+    EXPECT_EQ(inflater.GetNumReadBytes(), compressed.size());
+    EXPECT_EQ(inflated, expected);
+}
+
+TEST_F(DeflateTest, Zlib)
+{
+    const std::vector<uint8_t> input = ToBytes("Petrichor Petrichor Petrichor");
+
+    std::vector<uint8_t> compressed;
+    CompressZlib(input.data(), input.size(), &compressed);
+    ASSERT_GE(compressed.size(), 6u);
+
+    // CMF/FLG: Deflate、32KiB のウィンドウ、31 の倍数
+    EXPECT_EQ(compressed[0], 0x78);
+    EXPECT_EQ((compressed[0] << 8 | compressed[1]) % 31, 0);
+
+    std::vector<uint8_t> inflated;
+    Inflater inflater(compressed.data() + 2, compressed.size() - 6);
+    ASSERT_TRUE(inflater.Inflate(&inflated));
+    EXPECT_EQ(inflated, input);
+
+    const uint32_t adler = CalcAdler32(input.data(), input.size());
+    const size_t trailer = compressed.size() - 4;
+    EXPECT_EQ(compressed[trailer + 0], static_cast<uint8_t>(adler >> 24));
+    EXPECT_EQ(compressed[trailer + 1], static_cast<uint8_t>(adler >> 16));
+    EXPECT_EQ(compressed[trailer + 2], static_cast<uint8_t>(adler >> 8));
+    EXPECT_EQ(compressed[trailer + 3], static_cast<uint8_t>(adler));
+}
+
+TEST_F(DeflateTest, Adler32KnownValues)
+{
+    const auto adler32 = [](const std::string& text) {
+        return CalcAdler32(reinterpret_cast<const uint8_t*>(text.data()),
+                           text.size());
+    };
+
+    EXPECT_EQ(adler32(""), 0x00000001u);
+    EXPECT_EQ(adler32("a"), 0x00620062u);
+    EXPECT_EQ(adler32("abc"), 0x024D0127u);
+    EXPECT_EQ(adler32("Wikipedia"), 0x11E60398u);
+
+    // 剰余を取る間隔(5552 バイト)をまたぐ長さ
+    const std::vector<uint8_t> ones(100000, 0xFF);
+    EXPECT_EQ(CalcAdler32(ones.data(), ones.size()), CalcAdler32Naive(ones));
+}
+
+TEST_F(DeflateTest, Adler32Continuation)
+{
+    const std::vector<uint8_t> data = MakeRandomBytes(20000, 99);
+    const uint32_t whole = CalcAdler32(data.data(), data.size());
+
+    for (size_t split : { size_t(0), size_t(1), size_t(5552), size_t(12345) })
+    {
+        const uint32_t first = CalcAdler32(data.data(), split);
+        const uint32_t second =
+          CalcAdler32(data.data() + split, data.size() - split);
+
+        EXPECT_EQ(CalcAdler32(data.data() + split, data.size() - split, first),
+                  whole);
+        EXPECT_EQ(CombineAdler32(first, second, data.size() - split), whole);
+    }
+}
+
+TEST_F(DeflateTest, CRC32KnownValues)
+{
+    const auto crc32 = [](const std::string& text) {
+        return CalcCRC32(reinterpret_cast<const uint8_t*>(text.data()),
+                         text.size());
+    };
+
+    EXPECT_EQ(crc32(""), 0x00000000u);
+    EXPECT_EQ(crc32("123456789"), 0xCBF43926u);
+    EXPECT_EQ(crc32("The quick brown fox jumps over the lazy dog"),
+              0x414FA339u);
+
+    // PNG の IEND チャンクの CRC
+    EXPECT_EQ(crc32("IEND"), 0xAE426082u);
+
+    // 続きから計算しても同じ
+    const std::string text = "123456789";
+    const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+    EXPECT_EQ(CalcCRC32(bytes + 4, 5, CalcCRC32(bytes, 4)), 0xCBF43926u);
+}
+
+} // namespace
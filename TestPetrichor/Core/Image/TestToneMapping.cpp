@@ -0,0 +1,105 @@
+#include "Core/Image/ToneMapping.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+using namespace Petrichor::Core;
+using Petrichor::Color3f;
+
+class ToneMappingTest : public ::testing::Test
+{
+protected:
+    //! テーブルを引いた結果と ApplyReference() の差が 1 以下か確かめる
+    //! @return 値が異なったチャンネル数
+    static size_t
+    ExpectWithinOneLSB(const std::vector<Color3f>& pixels)
+    {
+        std::vector<uint8_t> rgb(pixels.size() * 3);
+        ToneMapper::GetInstance().Apply(
+          pixels.data(), pixels.size(), rgb.data());
+
+        size_t numDifferentChannels = 0;
+        for (size_t pixelIndex = 0; pixelIndex < pixels.size(); pixelIndex++)
+        {
+            const std::array<uint8_t, 3> reference =
+              ToneMapper::ApplyReference(pixels[pixelIndex]);
+            for (int channel = 0; channel < 3; channel++)
+            {
+                const int actual = rgb[3 * pixelIndex + channel];
+                EXPECT_LE(std::abs(actual - reference[channel]), 1)
+                  << "value=" << pixels[pixelIndex][channel]
+                  << " channel=" << channel;
+                if (actual != reference[channel])
+                {
+                    numDifferentChannels++;
+                }
+            }
+        }
+        return numDifferentChannels;
+    }
+};
+
+TEST_F(ToneMappingTest, MatchesReferenceWithinOneLSB)
+{
+    std::vector<Color3f> pixels;
+
+    // テーブルの区間より細かい刻み(ACESFilm の飽和する先まで)
+    constexpr int kNumSteps = 1 << 16;
+    for (int i = 0; i <= kNumSteps; i++)
+    {
+        const float value = i * (16.0f / kNumSteps);
+        pixels.emplace_back(value, 0.5f * value, 2.0f * value);
+    }
+
+    // 対数で広い範囲(ACESFilm の出力の上限 2.51 / 2.43 を超える値を含む)
+    for (float value = 1.0e-6f; value < 1.0e6f; value *= 1.01f)
+    {
+        pixels.emplace_back(value, 2.51f / 2.43f, value);
+    }
+
+    const size_t numDifferentChannels = ExpectWithinOneLSB(pixels);
+
+    // 丸めが変わるのは区間の境界付近だけ
+    EXPECT_LT(numDifferentChannels, pixels.size() * 3 / 100);
+}
+
+TEST_F(ToneMappingTest, SpecialValues)
+{
+    const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+    // NaN と 0 は黒になる
+    const std::vector<Color3f> blacks = {
+        Color3f(kNaN, kNaN, kNaN),
+        Color3f(0.0f, 0.0f, 0.0f),
+        Color3f(-0.0f, -0.0f, -0.0f),
+    };
+    std::vector<uint8_t> rgb(blacks.size() * 3);
+    ToneMapper::GetInstance().Apply(blacks.data(), blacks.size(), rgb.data());
+    for (size_t pixelIndex = 0; pixelIndex < blacks.size(); pixelIndex++)
+    {
+        const std::array<uint8_t, 3> reference =
+          ToneMapper::ApplyReference(blacks[pixelIndex]);
+        for (int channel = 0; channel < 3; channel++)
+        {
+            EXPECT_EQ(rgb[3 * pixelIndex + channel], 0);
+            EXPECT_EQ(reference[channel], 0);
+        }
+    }
+
+    // 負の値、上限付近と上限を超える値、チャンネルごとに異なる値
+    ExpectWithinOneLSB({
+      Color3f(-1.0f, -0.01f, -100.0f),
+      Color3f(kNaN, 0.5f, -0.5f),
+      Color3f(2.51f / 2.43f, 1.0f, 1.1f),
+      Color3f(10.0f, 1.0e3f, 1.0e10f),
+      Color3f(std::numeric_limits<float>::denorm_min(), 1.0e-30f, 1.0e-3f),
+    });
+}
+
+} // namespace
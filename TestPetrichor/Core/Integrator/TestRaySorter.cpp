@@ -0,0 +1,109 @@
+#include "Core/Integrator/RaySorter.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+namespace
+{
+
+using namespace Petrichor::Core;
+using Petrichor::Math::Vector3f;
+
+class RaySorterTest : public ::testing::Test
+{
+protected:
+    //! 3軸の10bitの値を x, y, z の順に1bitずつ並べた30bitのモートンコード
+    static uint64_t
+    Interleave(uint32_t x, uint32_t y, uint32_t z)
+    {
+        uint64_t code = 0;
+        for (int bit = 0; bit < 10; bit++)
+        {
+            code |= static_cast<uint64_t>((x >> bit) & 1) << (3 * bit + 2);
+            code |= static_cast<uint64_t>((y >> bit) & 1) << (3 * bit + 1);
+            code |= static_cast<uint64_t>((z >> bit) & 1) << (3 * bit);
+        }
+        return code;
+    }
+
+    static constexpr uint64_t kCodeMask = (1ull << 30) - 1;
+
+    const AABB m_unitBound{ Vector3f::Zero(), Vector3f::One() };
+};
+
+TEST_F(RaySorterTest, OctantInTopBits)
+{
+    const Vector3f o = Vector3f::Zero();
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { 1, 0, 0 }), m_unitBound) >> 60,
+              0u);
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { -1, 0, 0 }), m_unitBound) >> 60,
+              4u);
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { 0, -1, 0 }), m_unitBound) >> 60,
+              2u);
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { 0, 0, -1 }), m_unitBound) >> 60,
+              1u);
+
+    const Vector3f allNegative = Vector3f(-1, -1, -1).Normalized();
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, allNegative), m_unitBound) >> 60,
+              7u);
+}
+
+TEST_F(RaySorterTest, OriginMortonCode)
+{
+    // 原点は範囲で正規化して各軸 10bit に量子化する
+    const Ray ray({ 1.0f, 0.0f, 0.5f }, { 1, 0, 0 });
+    const uint64_t key = RaySorter::CalcSortKey(ray, m_unitBound);
+    EXPECT_EQ((key >> 30) & kCodeMask, Interleave(1023, 0, 511));
+
+    // 範囲の外は端に丸める
+    const Ray outside({ 2.0f, -1.0f, 1.0f }, { 1, 0, 0 });
+    EXPECT_EQ(
+      (RaySorter::CalcSortKey(outside, m_unitBound) >> 30) & kCodeMask,
+      Interleave(1023, 0, 1023));
+
+    // 大きさのない範囲では原点を区別しない
+    const AABB pointBound(Vector3f::One(), Vector3f::One());
+    EXPECT_EQ((RaySorter::CalcSortKey(ray, pointBound) >> 30) & kCodeMask,
+              0u);
+}
+
+TEST_F(RaySorterTest, DirectionMortonCode)
+{
+    // 方向は [-1, 1] を [0, 1] に写してから量子化する
+    const Vector3f o = Vector3f::Zero();
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { 0, -1, 0 }), m_unitBound) &
+                kCodeMask,
+              Interleave(511, 0, 511));
+    EXPECT_EQ(RaySorter::CalcSortKey(Ray(o, { 0, 0, 1 }), m_unitBound) &
+                kCodeMask,
+              Interleave(511, 511, 1023));
+}
+
+TEST_F(RaySorterTest, SortGroupsOctants)
+{
+    std::vector<Ray> rays;
+    for (int i = 0; i < 64; i++)
+    {
+        const Vector3f dir((i & 1) ? -1.0f : 1.0f,
+                           (i & 2) ? -1.0f : 1.0f,
+                           (i & 4) ? -1.0f : 1.0f);
+        rays.emplace_back(Vector3f(0.01f * i, 0.0f, 0.0f), dir.Normalized());
+    }
+
+    RaySorter sorter;
+    std::vector<Ray> scratch;
+    sorter.Sort(&rays, &scratch, [](const Ray& ray) { return ray; });
+
+    ASSERT_EQ(rays.size(), 64u);
+    AABB bound;
+    for (const Ray& ray : rays)
+    {
+        bound.Merge(ray.o);
+    }
+    for (size_t i = 1; i < rays.size(); i++)
+    {
+        EXPECT_LE(RaySorter::CalcSortKey(rays[i - 1], bound),
+                  RaySorter::CalcSortKey(rays[i], bound));
+    }
+}
+
+} // namespace
@@ -0,0 +1,114 @@
+#include "Core/Constants.h"
+#include "Core/HitInfo.h"
+#include "Core/Material/Glass.h"
+#include "Core/Material/MaterialTable.h"
+#include "Core/Ray.h"
+#include "Core/Sampler/ISampler2D.h"
+#include "gtest/gtest.h"
+
+namespace
+{
+
+using namespace Petrichor::Core;
+using Petrichor::Color3f;
+using Petrichor::kEps;
+using Petrichor::Math::Vector3f;
+
+//! 常に同じ値を返すサンプラー
+class ConstantSampler2D : public ISampler2D
+{
+public:
+    explicit ConstantSampler2D(float value)
+      : m_value(value)
+    {
+    }
+
+    std::tuple<float, float>
+    Next() override
+    {
+        return { m_value, m_value };
+    }
+
+private:
+    float m_value;
+};
+
+class GlassTest : public ::testing::Test
+{
+protected:
+    GlassTest()
+    {
+        m_shadingInfo.pos = Vector3f(3.0f, -2.0f, 5.0f);
+        m_shadingInfo.normal = Vector3f(0.0f, 0.0f, 1.0f);
+        m_shadingInfo.material = &m_glass;
+    }
+
+    //! 次のレイの原点が衝突点から法線方向に offset だけずれているか
+    void
+    ExpectOrigin(const Ray& rayOut, float offset) const
+    {
+        const Vector3f expected =
+          m_shadingInfo.pos + offset * m_shadingInfo.normal;
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_NEAR(rayOut.o[i], expected[i], 1.0e-5f);
+        }
+    }
+
+    Glass m_glass{ Color3f::One(), 1.5f };
+    ShadingInfo m_shadingInfo;
+
+    //! 上から垂直に入射するレイ
+    const Ray m_rayIn{ Vector3f(3.0f, -2.0f, 6.0f),
+                       Vector3f(0.0f, 0.0f, -1.0f) };
+};
+
+TEST_F(GlassTest, ContextPositionIsHitPoint)
+{
+    const BSDFContext context =
+      m_glass.CreateBSDFContext(m_rayIn, m_shadingInfo);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_FLOAT_EQ(context.pos[i], m_shadingInfo.pos[i]);
+    }
+}
+
+TEST_F(GlassTest, ReflectedRayStartsAtHitPoint)
+{
+    const BSDFContext context =
+      m_glass.CreateBSDFContext(m_rayIn, m_shadingInfo);
+
+    // 0 はフレネル反射率以下なので反射する
+    ConstantSampler2D sampler(0.0f);
+    const BSDFSample sample = m_glass.Sample(context, m_rayIn, sampler);
+    EXPECT_EQ(sample.ray.rayType, RayTypes::Glossy);
+    ExpectOrigin(sample.ray, kEps);
+}
+
+TEST_F(GlassTest, RefractedRayStartsAtHitPoint)
+{
+    const BSDFContext context =
+      m_glass.CreateBSDFContext(m_rayIn, m_shadingInfo);
+
+    ConstantSampler2D sampler(0.999f);
+    const BSDFSample sample = m_glass.Sample(context, m_rayIn, sampler);
+    EXPECT_EQ(sample.ray.rayType, RayTypes::Refract);
+    ExpectOrigin(sample.ray, -kEps);
+}
+
+TEST_F(GlassTest, MaterialTableRayStartsAtHitPoint)
+{
+    MaterialTable materialTable;
+    materialTable.Build({ &m_glass });
+    const MaterialId materialId = materialTable.FindMaterialId(&m_glass);
+
+    const BSDFContext context =
+      materialTable.CreateBSDFContext(materialId, m_rayIn, m_shadingInfo);
+
+    ConstantSampler2D sampler(0.999f);
+    const BSDFSample sample =
+      materialTable.Sample(materialId, context, m_rayIn, sampler);
+    ExpectOrigin(sample.ray, -kEps);
+}
+
+} // namespace
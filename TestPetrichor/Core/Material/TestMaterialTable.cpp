@@ -0,0 +1,57 @@
+#include "Core/Material/Glass.h"
+#include "Core/Material/Lambert.h"
+#include "Core/Material/MaterialTable.h"
+#include "Core/Material/MixMaterial.h"
+#include "gtest/gtest.h"
+
+namespace
+{
+
+using namespace Petrichor::Core;
+using Petrichor::Color3f;
+
+class MaterialTableTest : public ::testing::Test
+{
+protected:
+    Lambert m_lambert{ Color3f::One() };
+    Glass m_glass{ Color3f::One(), 1.5f };
+    Lambert m_lambert2{ Color3f::Zero() };
+};
+
+TEST_F(MaterialTableTest, ResolveNestedMix)
+{
+    // inner: 1/2 で m_lambert, m_glass
+    // outer: 1/4 で inner, 3/4 で m_lambert2
+    const MixMaterial inner(&m_lambert, &m_glass, 0.5f);
+    const MixMaterial outer(&inner, &m_lambert2, 0.75f);
+
+    MaterialTable materialTable;
+    materialTable.Build({ &outer });
+
+    const MaterialId outerId = materialTable.FindMaterialId(&outer);
+    const MaterialId lambertId = materialTable.FindMaterialId(&m_lambert);
+    const MaterialId glassId = materialTable.FindMaterialId(&m_glass);
+    const MaterialId lambert2Id = materialTable.FindMaterialId(&m_lambert2);
+
+    int numLamberts = 0;
+    int numGlasses = 0;
+    int numLamberts2 = 0;
+    constexpr int kNumSamples = 1000;
+    for (int i = 0; i < kNumSamples; i++)
+    {
+        const float rand = (i + 0.5f) / kNumSamples;
+        const MaterialId materialId = materialTable.Resolve(outerId, rand);
+        ASSERT_NE(materialTable.GetMaterialType(materialId),
+                  MaterialTypes::Mix);
+
+        numLamberts += materialId == lambertId;
+        numGlasses += materialId == glassId;
+        numLamberts2 += materialId == lambert2Id;
+    }
+
+    EXPECT_EQ(numLamberts, 125);
+    EXPECT_EQ(numGlasses, 125);
+    EXPECT_EQ(numLamberts2, 750);
+}
+
+} // namespace
@@ -0,0 +1,147 @@
+#include "Core/Memory/ArenaAllocator.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using namespace Petrichor::Core;
+
+//! 破棄された順に番号を記録する
+struct DestructionRecorder
+{
+    DestructionRecorder(int id, std::vector<int>* destroyed)
+      : id(id)
+      , destroyed(destroyed)
+    {
+    }
+
+    ~DestructionRecorder()
+    {
+        destroyed->emplace_back(id);
+    }
+
+    int id;
+    std::vector<int>* destroyed;
+};
+
+class ArenaAllocatorTest : public ::testing::Test
+{
+protected:
+    static bool
+    IsAligned(const void* p, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    }
+};
+
+TEST_F(ArenaAllocatorTest, Alignment)
+{
+    ArenaAllocator arena;
+    for (size_t alignment = 1; alignment <= ArenaAllocator::kPageSize;
+         alignment *= 2)
+    {
+        // 直前の確保で切り出し位置をずらしておく
+        arena.Allocate(1, 1);
+        EXPECT_TRUE(IsAligned(arena.Allocate(3, alignment), alignment))
+          << "alignment: " << alignment;
+    }
+
+    struct alignas(64) CacheLine
+    {
+        float values[16];
+    };
+    arena.Allocate(1, 1);
+    EXPECT_TRUE(IsAligned(arena.New<CacheLine>(), 64));
+}
+
+TEST_F(ArenaAllocatorTest, LargerThanBlock)
+{
+    ArenaAllocator arena;
+    const size_t largeSize = 3 * ArenaAllocator::kDefaultBlockSize + 5;
+
+    auto* const small = static_cast<std::byte*>(arena.Allocate(16));
+    auto* const large = static_cast<std::byte*>(arena.Allocate(largeSize));
+    auto* const small2 = static_cast<std::byte*>(arena.Allocate(16));
+
+    // 大きな要求は専用のブロックに置き、全体に書き込める
+    EXPECT_TRUE(IsAligned(large, ArenaAllocator::kPageSize));
+    std::memset(large, 0xAB, largeSize);
+    std::memset(small, 0xCD, 16);
+    std::memset(small2, 0xEF, 16);
+    EXPECT_EQ(large[0], std::byte{ 0xAB });
+    EXPECT_EQ(large[largeSize - 1], std::byte{ 0xAB });
+
+    EXPECT_EQ(arena.GetNumBytesUsed(), largeSize + 32);
+    EXPECT_GE(arena.GetNumBytesReserved(), largeSize);
+}
+
+TEST_F(ArenaAllocatorTest, DestructorOrder)
+{
+    std::vector<int> destroyed;
+    {
+        ArenaAllocator arena;
+        for (int id = 0; id < 4; id++)
+        {
+            arena.New<DestructionRecorder>(id, &destroyed);
+        }
+        // トリビアルに破棄できる型は記録されない
+        arena.New<int>(5);
+
+        EXPECT_TRUE(destroyed.empty());
+    }
+
+    // 生成と逆順に破棄する
+    EXPECT_EQ(destroyed, (std::vector<int>{ 3, 2, 1, 0 }));
+}
+
+TEST_F(ArenaAllocatorTest, Reset)
+{
+    std::vector<int> destroyed;
+    ArenaAllocator arena;
+    arena.New<DestructionRecorder>(0, &destroyed);
+    arena.Reset();
+
+    EXPECT_EQ(destroyed, (std::vector<int>{ 0 }));
+    EXPECT_EQ(arena.GetNumBytesUsed(), 0u);
+    EXPECT_EQ(arena.GetNumBytesReserved(), 0u);
+
+    // Reset() 後も使える
+    EXPECT_EQ(*arena.New<std::string>("reused"), "reused");
+}
+
+TEST_F(ArenaAllocatorTest, Move)
+{
+    std::vector<int> destroyed;
+    {
+        ArenaAllocator arena;
+        arena.New<DestructionRecorder>(0, &destroyed);
+        const std::string* const text = arena.New<std::string>("moved");
+        const size_t numBytesUsed = arena.GetNumBytesUsed();
+
+        ArenaAllocator moved(std::move(arena));
+        EXPECT_EQ(moved.GetNumBytesUsed(), numBytesUsed);
+        EXPECT_EQ(arena.GetNumBytesUsed(), 0u);
+        EXPECT_EQ(*text, "moved");
+
+        // 移動元を破棄しても、移動先のオブジェクトは破棄されない
+        arena = ArenaAllocator();
+        EXPECT_TRUE(destroyed.empty());
+
+        ArenaAllocator assigned;
+        assigned.New<DestructionRecorder>(1, &destroyed);
+        assigned = std::move(moved);
+
+        // 代入先が持っていたオブジェクトは代入時に破棄される
+        EXPECT_EQ(destroyed, (std::vector<int>{ 1 }));
+        EXPECT_EQ(*text, "moved");
+    }
+
+    EXPECT_EQ(destroyed, (std::vector<int>{ 1, 0 }));
+}
+
+} // namespace
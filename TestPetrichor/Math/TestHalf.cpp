@@ -0,0 +1,71 @@
+#include "Math/Half.h"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+using namespace Petrichor::Math;
+
+class HalfTest : public ::testing::Test
+{
+};
+
+TEST_F(HalfTest, ExactValues)
+{
+    EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+    EXPECT_EQ(FloatToHalf(-0.0f), 0x8000);
+    EXPECT_EQ(FloatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(FloatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(FloatToHalf(0.5f), 0x3800);
+    EXPECT_EQ(FloatToHalf(65504.0f), 0x7BFF);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -14)), 0x0400);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+}
+
+TEST_F(HalfTest, RoundToNearestEven)
+{
+    // 1 + 2^-11 は 1 と 1 + 2^-10 の中間なので偶数側の 1 に丸める
+    EXPECT_EQ(FloatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+    EXPECT_EQ(FloatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3C02);
+    EXPECT_EQ(FloatToHalf(1.0f + std::ldexp(1.5f, -11)), 0x3C01);
+
+    // 非正規化数の丸め
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -25)), 0x0000);
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.5f, -25)), 0x0001);
+    EXPECT_EQ(FloatToHalf(std::ldexp(3.0f, -25)), 0x0002);
+
+    // 非正規化数の最大値から正規化数の最小値への繰り上がり
+    EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -14) - std::ldexp(1.0f, -26)),
+              0x0400);
+}
+
+TEST_F(HalfTest, Overflow)
+{
+    EXPECT_EQ(FloatToHalf(65519.0f), 0x7BFF);
+    EXPECT_EQ(FloatToHalf(65520.0f), 0x7C00);
+    EXPECT_EQ(FloatToHalf(-1.0e10f), 0xFC00);
+    EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7C00);
+
+    const uint16_t nan = FloatToHalf(std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQ(nan & 0x7C00, 0x7C00);
+    EXPECT_NE(nan & 0x03FF, 0);
+}
+
+TEST_F(HalfTest, RoundTrip)
+{
+    for (uint32_t bits = 0; bits <= 0xFFFF; bits++)
+    {
+        const auto half = static_cast<uint16_t>(bits);
+        const float value = HalfToFloat(half);
+        if (std::isnan(value))
+        {
+            EXPECT_TRUE(std::isnan(HalfToFloat(FloatToHalf(value))));
+            continue;
+        }
+        EXPECT_EQ(FloatToHalf(value), half);
+    }
+}
+
+} // namespace
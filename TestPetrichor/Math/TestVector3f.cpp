@@ -23,4 +23,45 @@ TEST_F(Vector3fTest, OperatorAdd)
     }
 }
 
+TEST_F(Vector3fTest, DotAndCross)
+{
+    Vector3f v0{ 1.0f, 2.0f, 3.0f };
+    Vector3f v1{ 4.0f, 5.0f, 6.0f };
+    Vector3f v2{ -3.0f, 6.0f, -3.0f };
+
+    EXPECT_FLOAT_EQ(Dot(v0, v1), 32.0f);
+
+    const auto crossed = Cross(v0, v1);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_FLOAT_EQ(crossed[i], v2[i]);
+    }
+}
+
+TEST_F(Vector3fTest, DivisionKeepsLength)
+{
+    // SIMD実装でパディング要素の 0 / 0 が長さに漏れないこと
+    Vector3f v0{ 2.0f, 6.0f, 12.0f };
+    Vector3f v1{ 1.0f, 3.0f, 4.0f };
+
+    const auto divided = v0 / v1;
+    EXPECT_FLOAT_EQ(divided.SquaredLength(), 17.0f);
+}
+
+TEST_F(Vector3fTest, MinMax)
+{
+    Vector3f v0{ 1.0f, 5.0f, -3.0f };
+    Vector3f v1{ 4.0f, 2.0f, -6.0f };
+    Vector3f vMin{ 1.0f, 2.0f, -6.0f };
+    Vector3f vMax{ 4.0f, 5.0f, -3.0f };
+
+    const auto minimum = Min(v0, v1);
+    const auto maximum = Max(v0, v1);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_FLOAT_EQ(minimum[i], vMin[i]);
+        EXPECT_FLOAT_EQ(maximum[i], vMax[i]);
+    }
+}
+
 } // namespace
@@ -0,0 +1,121 @@
+#include "Random/CounterBasedRandom.h"
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+using namespace Petrichor::Math;
+
+class CounterBasedRandomTest : public ::testing::Test
+{
+protected:
+    static std::vector<uint32_t>
+    Generate(CounterBasedRandom random, int numValues)
+    {
+        std::vector<uint32_t> values;
+        values.reserve(numValues);
+        for (int i = 0; i < numValues; i++)
+        {
+            values.emplace_back(random.random());
+        }
+        return values;
+    }
+};
+
+TEST_F(CounterBasedRandomTest, MatchesSplitMix64)
+{
+    // SplitMix64 の状態 0 から最初に得られる値 0xE220A8397B1DCDAF の上位 32bit
+    CounterBasedRandom random(0);
+    EXPECT_EQ(random.random(), 0xE220A839u);
+    EXPECT_EQ(random.GetCounter(), 1u);
+}
+
+TEST_F(CounterBasedRandomTest, MakeKeyIsDeterministic)
+{
+    static_assert(CounterBasedRandom::MakeKey(1, 2, 3, 4) ==
+                    CounterBasedRandom::MakeKey(1, 2, 3, 4),
+                  "MakeKey must be deterministic");
+
+    const uint64_t key = CounterBasedRandom::MakeKey(12345, 10, 20, 30);
+    EXPECT_EQ(key, CounterBasedRandom::MakeKey(12345, 10, 20, 30));
+    EXPECT_NE(key, CounterBasedRandom::MakeKey(12346, 10, 20, 30));
+}
+
+TEST_F(CounterBasedRandomTest, SameKeyAndCounterRepeat)
+{
+    constexpr int kNumValues = 64;
+    const uint64_t key = CounterBasedRandom::MakeKey(7, 1, 2, 3);
+
+    const std::vector<uint32_t> values =
+      Generate(CounterBasedRandom(key), kNumValues);
+    EXPECT_EQ(values, Generate(CounterBasedRandom(key), kNumValues));
+
+    // カウンタを指定して作ると、その個数だけ引いた後と同じ値が続く
+    for (int counter = 0; counter < kNumValues; counter++)
+    {
+        CounterBasedRandom random(key, counter);
+        EXPECT_EQ(random.random(), values[counter]);
+    }
+}
+
+TEST_F(CounterBasedRandomTest, NeighbouringKeysDiffer)
+{
+    constexpr uint32_t kSeed = 42;
+    constexpr uint32_t kSize = 8;
+
+    std::unordered_set<uint64_t> keys;
+    for (uint32_t sampleIndex = 0; sampleIndex < kSize; sampleIndex++)
+    {
+        for (uint32_t y = 0; y < kSize; y++)
+        {
+            for (uint32_t x = 0; x < kSize; x++)
+            {
+                const uint64_t key =
+                  CounterBasedRandom::MakeKey(kSeed, x, y, sampleIndex);
+                EXPECT_TRUE(keys.insert(key).second)
+                  << "x=" << x << " y=" << y << " sample=" << sampleIndex;
+
+                // 隣の画素、サンプルとは最初の値から異なる
+                const uint32_t value = CounterBasedRandom(key).random();
+                EXPECT_NE(value,
+                          CounterBasedRandom(CounterBasedRandom::MakeKey(
+                                               kSeed, x + 1, y, sampleIndex))
+                            .random());
+                EXPECT_NE(value,
+                          CounterBasedRandom(CounterBasedRandom::MakeKey(
+                                               kSeed, x, y + 1, sampleIndex))
+                            .random());
+                EXPECT_NE(value,
+                          CounterBasedRandom(CounterBasedRandom::MakeKey(
+                                               kSeed, x, y, sampleIndex + 1))
+                            .random());
+            }
+        }
+    }
+
+    // 値の順番を入れ替えても同じキーにならない
+    EXPECT_NE(CounterBasedRandom::MakeKey(kSeed, 1, 2, 3),
+              CounterBasedRandom::MakeKey(kSeed, 2, 1, 3));
+    EXPECT_NE(CounterBasedRandom::MakeKey(kSeed, 1, 2, 3),
+              CounterBasedRandom::MakeKey(kSeed, 1, 3, 2));
+}
+
+TEST_F(CounterBasedRandomTest, NextIsInUnitInterval)
+{
+    CounterBasedRandom random(CounterBasedRandom::MakeKey(0, 0, 0, 0));
+    for (int i = 0; i < 100000; i++)
+    {
+        const float value = random.next();
+        EXPECT_LE(0.0f, value);
+        EXPECT_LT(value, 1.0f);
+    }
+
+    // 上位 24bit が全て 1 でも 1 にはならない
+    EXPECT_LT(static_cast<float>(0xFFFFFFFFu >> 8) * (1.0f / 16777216.0f),
+              1.0f);
+}
+
+} // namespace